@@ -0,0 +1,206 @@
+// Measures polled reads of lift variables against a simulated lift PLC with
+// several reader threads sharing one AdsInterface, for a growing number of
+// requests in flight. With one request in flight the readers take turns on
+// the connection, with more the requests are pipelined. The simulated link
+// delays every response, as the network to a real PLC does. Last, a single
+// thread keeps the same number of requests in flight with the asynchronous
+// AdsDevice requests, every completion sending the next read. Finally it
+// checks that synchronous reads and writes, once warmed up, do not allocate
+// on the heap, and fails if they do.
+//
+// usage: ads_pipeline_benchmark [seconds_per_step] [max_requests_in_flight]
+//                               [link_latency_us]
+
+#include "AdsDevice.h"
+#include "AdsInterface.hpp"
+#include "simulators.hpp"
+
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// heap allocations of the calling thread, counted by operator new below
+thread_local uint64_t t_allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    t_allocations++;
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char **argv)
+{
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    const uint32_t max_in_flight =
+        argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+    const auto link_latency = std::chrono::microseconds(
+        argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 500);
+
+    boost::log::core::get()->set_filter(
+        boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    DeviceProbe probe;
+    LiftSimulator plc(probe);
+    plc.SetLinkLatency(link_latency);
+    std::ostringstream config;
+    config << "variables:\n";
+    std::vector<std::string> aliases;
+    for (const auto &symbol : LiftSimulator::Symbols()) {
+        config << "  " << symbol[0] << ": " << symbol[1] << "\n";
+        aliases.push_back(symbol[1]);
+    }
+
+    AdsInterface ads;
+    ads.SetRemoteIPV4("127.0.0.1:" + std::to_string(plc.Port()));
+    ads.SetLocalNetID("127.0.0.1.1.1");
+    ads.SetRemoteNetID("10.1.0.1.1.1");
+    ads.SetName("pipeline");
+    ads.SetFile(YAML::Load(config.str()));
+    ads.InitRoute();
+    ads.ConnectionCheck();
+    ads.AcquireVariables();
+    ads.BindPLCVar();
+    if (!ads.GetState()) {
+        std::printf("lift initialization failed\n");
+        return 1;
+    }
+
+    for (uint32_t in_flight = 1; in_flight <= max_in_flight; in_flight *= 2) {
+        ads.SetMaxRequestsInFlight(in_flight);
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> reads{0};
+        std::vector<std::thread> readers;
+        const auto start = Clock::now();
+        // one reader per request in flight, each on its own variable
+        for (uint32_t i = 0; i < in_flight; ++i) {
+            readers.emplace_back([&, i]() {
+                const std::string &alias = aliases[i % aliases.size()];
+                while (!stop) {
+                    ads.AdsReadValue(alias);
+                    reads++;
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        const double elapsed = Millis(Clock::now() - start) / 1000;
+        std::printf(
+            "%3u in flight %10.0f reads/s\n",
+            in_flight,
+            reads.load() / elapsed);
+    }
+
+    // the route to the PLC is the one added by InitRoute()
+    AdsDevice device(
+        "127.0.0.1:" + std::to_string(plc.Port()),
+        AmsNetId("10.1.0.1.1.1"),
+        AMSPORT_R0_PLC_TC3);
+    for (uint32_t in_flight = 1; in_flight <= max_in_flight; in_flight *= 2) {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> reads{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        uint32_t outstanding = in_flight;
+        std::vector<uint8_t> versions(in_flight);
+        auto finish = [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--outstanding == 0) {
+                done.notify_one();
+            }
+        };
+        std::function<void(uint32_t)> send = [&](uint32_t i) {
+            const long error = device.ReadReqAsync(
+                ADSIGRP_SYM_VERSION, 0, 1, &versions[i],
+                [&, i](long error, uint32_t) {
+                    if (!error) {
+                        reads++;
+                    }
+                    if (stop) {
+                        finish();
+                    } else {
+                        send(i);
+                    }
+                });
+            if (error) {
+                finish();
+            }
+        };
+        const auto start = Clock::now();
+        for (uint32_t i = 0; i < in_flight; ++i) {
+            send(i);
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        const double elapsed = Millis(Clock::now() - start) / 1000;
+        const uint64_t completed = reads.load();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return outstanding == 0; });
+        std::printf(
+            "%3u in flight %10.0f async reads/s\n",
+            in_flight,
+            completed / elapsed);
+    }
+
+    // the request frames come from the frame pool once it is warmed up
+    const int requests = 1000;
+    plc.SetLinkLatency(Clock::duration::zero());
+    const auto handle = device.GetHandle("TransportOp_GVL.randomCount");
+    int16_t value = 0;
+    uint32_t bytes_read = 0;
+    auto read_write = [&]() {
+        return device.ReadReqEx2(
+                   ADSIGRP_SYM_VALBYHND,
+                   *handle,
+                   sizeof(value),
+                   &value,
+                   &bytes_read) ||
+               device.WriteReqEx(
+                   ADSIGRP_SYM_VALBYHND,
+                   *handle,
+                   sizeof(value),
+                   &value);
+    };
+    for (int i = 0; i < 10; ++i) {
+        read_write();
+    }
+    int failed = 0;
+    const uint64_t allocations = t_allocations;
+    for (int i = 0; i < requests; ++i) {
+        failed += read_write();
+    }
+    const uint64_t allocated = t_allocations - allocations;
+    std::printf(
+        "%d synchronous reads and writes, %d failed, %llu heap "
+        "allocations\n",
+        requests,
+        failed,
+        static_cast<unsigned long long>(allocated));
+    return failed || allocated ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+// Compares reading a lift variable by alias through AdsInterface::AdsReadValue
+// with the typed TRLLiftInterface::Read<LiftVar>() accessor.
+// Both are measured against a simulated lift PLC, once polled over ADS and
+// once served from the notification cache, which leaves only the per call
+// overhead. Reports time and heap allocations per read.
+//
+// usage: lift_access_benchmark [cached_iterations] [polled_iterations]
+
+#include "TRLLiftInterface.hpp"
+#include "simulators.hpp"
+
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <thread>
+
+static std::atomic<size_t> g_allocations{0};
+
+void *operator new(size_t size)
+{
+    g_allocations++;
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+template <typename F>
+static void Run(const char *name, size_t iterations, F &&f)
+{
+    const size_t allocations = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        f();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+    std::printf(
+        "%-36s %10.1f ns/op %8.2f allocs/op\n",
+        name,
+        ns / iterations,
+        double(g_allocations.load() - allocations) / iterations);
+}
+
+// configuration of one lift pointing at a simulator
+static YAML::Node LiftConfig(
+    const LiftSimulator &simulator,
+    size_t index,
+    bool notifications)
+{
+    std::ostringstream config;
+    config << "remoteIP: \"127.0.0.1:" << simulator.Port() << "\"\n"
+           << "remoteNetID: \"10.1.0." << index << ".1.1\"\n"
+           << "localNetID: \"127.0.0.1.1.1\"\n"
+           << "notifications: " << (notifications ? "true" : "false") << "\n"
+           << "variables:\n";
+    for (const auto &symbol : LiftSimulator::Symbols()) {
+        config << "  " << symbol[0] << ": " << symbol[1] << "\n";
+    }
+    config << "available_floors: [\"1\", \"2\", \"3\", \"4\", \"5\", \"6\"]\n"
+           << "available_modes: [0, 1, 2, 3]\n";
+    return YAML::Load(config.str());
+}
+
+// the alias path as TRLLiftInterface::Initialize() sets it up
+static void InitializeAds(
+    AdsInterface &ads,
+    const YAML::Node &config,
+    bool notifications)
+{
+    ads.SetRemoteIPV4(config["remoteIP"].as<std::string>());
+    ads.SetLocalNetID(config["localNetID"].as<std::string>());
+    ads.SetRemoteNetID(config["remoteNetID"].as<std::string>());
+    ads.SetName("alias");
+    ads.SetFile(config);
+    ads.InitRoute();
+    ads.ConnectionCheck();
+    ads.AcquireVariables();
+    ads.BindPLCVar();
+    if (notifications) {
+        ads.EnableNotifications(0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t cached_iterations =
+        argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t polled_iterations =
+        argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+
+    boost::log::core::get()->set_filter(
+        boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    // one simulated PLC per client, polled and cached
+    DeviceProbe probe;
+    LiftSimulator alias_polled_plc(probe);
+    LiftSimulator alias_cached_plc(probe);
+    LiftSimulator typed_polled_plc(probe);
+    LiftSimulator typed_cached_plc(probe);
+
+    AdsInterface alias_polled;
+    AdsInterface alias_cached;
+    InitializeAds(alias_polled, LiftConfig(alias_polled_plc, 1, false), false);
+    InitializeAds(alias_cached, LiftConfig(alias_cached_plc, 2, true), true);
+    TRLLiftInterface typed_polled;
+    TRLLiftInterface typed_cached;
+    if (!typed_polled.Initialize(
+            "typed_polled",
+            LiftConfig(typed_polled_plc, 3, false)) ||
+        !typed_cached.Initialize(
+            "typed_cached",
+            LiftConfig(typed_cached_plc, 4, true))) {
+        std::printf("lift initialization failed\n");
+        return 1;
+    }
+
+    // both caches are filled once the first notifications arrive
+    const auto deadline = Clock::now() + std::chrono::seconds(2);
+    while (!alias_cached.AdsReadCached("liftCurrentFloor") &&
+           Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (std::get<int8_t>(alias_polled.AdsReadValue("liftCurrentFloor")) !=
+            typed_polled.Read<LiftVar::CurrentFloor>().value_or(0) ||
+        std::get<int8_t>(alias_cached.AdsReadValue("liftCurrentFloor")) !=
+            typed_cached.Read<LiftVar::CurrentFloor>().value_or(0)) {
+        std::printf("value mismatch\n");
+        return 1;
+    }
+
+    size_t sink = 0;
+    Run("cached AdsReadValue(alias)", cached_iterations, [&]() {
+        sink += std::get<int8_t>(alias_cached.AdsReadValue("liftCurrentFloor"));
+    });
+    Run("cached Read<LiftVar::CurrentFloor>", cached_iterations, [&]() {
+        sink += typed_cached.Read<LiftVar::CurrentFloor>().value_or(0);
+    });
+    Run("polled AdsReadValue(alias)", polled_iterations, [&]() {
+        sink += std::get<int8_t>(alias_polled.AdsReadValue("liftCurrentFloor"));
+    });
+    Run("polled Read<LiftVar::CurrentFloor>", polled_iterations, [&]() {
+        sink += typed_polled.Read<LiftVar::CurrentFloor>().value_or(0);
+    });
+    return sink == 0;
+}
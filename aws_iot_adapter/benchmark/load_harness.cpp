@@ -0,0 +1,390 @@
+// End-to-end load harness for TRLIotCoreAdapter.
+//
+// Runs the adapter fully offline against:
+//  - an in-process MQTT stand-in implementing TRLMqttTransport, which
+//    injects commands and timestamps every published state,
+//  - one simulated Modbus/TCP door controller per door,
+//  - one simulated ADS/AMS lift PLC per lift,
+// all listening on 127.0.0.1. The real TRLDoorInterface, TRLLiftInterface and
+// AdsLib code paths are exercised.
+//
+// Reported:
+//  - command throughput,
+//  - latency from command receipt to the first PLC write,
+//  - latency from a PLC state change to the publication of the new state,
+//  - publish throughput.
+//
+// The adapter's own latency histograms are written every second to
+// metrics_file when given.
+//
+// usage: adapter_load_harness [lifts] [doors] [seconds] [command_interval_ms]
+//                             [metrics_file] [lift_notifications]
+//                             [lift_resolve_by_name] [lift_outage_ms]
+//
+// lift_notifications=1 serves the lift reads from ADS notifications.
+// lift_resolve_by_name=1 resolves the lift symbols by name instead of
+// uploading the symbol table.
+// lift_outage_ms takes the PLC of lift_0 offline for that long after a third
+// of the run, the other devices should not notice.
+
+#include "TRLIotCoreAdapter.hpp"
+#include "TRLMqttTransport.hpp"
+#include "simulators.hpp"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// commands without a PLC write after this time are counted as lost
+const auto kCommandTimeout = std::chrono::seconds(5);
+
+/**
+ * @brief In-process MQTT stand-in. Subscriptions and commands stay in the
+ * process, published states are decoded to feed the device probes.
+ */
+class LoopbackTransport : public TRLMqttTransport {
+public:
+    using Observer = std::function<void(const std::string &topic, const std::string &payload)>;
+
+    explicit LoopbackTransport(Observer observer)
+        : m_observer(std::move(observer))
+    {
+    }
+
+    bool Connect(const Callbacks &callbacks) override
+    {
+        if (callbacks.on_connected) {
+            callbacks.on_connected();
+        }
+        return true;
+    }
+
+    void Disconnect() override {}
+
+    bool Subscribe(const std::vector<std::pair<std::string, MessageHandler>>
+                       &subscriptions) override
+    {
+        std::scoped_lock lock(m_mutex);
+        for (const auto &[topic, handler] : subscriptions) {
+            m_handlers[topic] = handler;
+        }
+        return true;
+    }
+
+    bool Publish(
+        const std::string &topic,
+        const std::string &payload,
+        PublishHandler on_complete) override
+    {
+        m_messages++;
+        m_bytes += payload.size();
+        m_observer(topic, payload);
+        if (on_complete) {
+            on_complete(0);
+        }
+        return true;
+    }
+
+    // delivers a command as the broker would
+    void Deliver(const std::string &topic, const std::string &payload)
+    {
+        MessageHandler handler;
+        {
+            std::scoped_lock lock(m_mutex);
+            const auto it = m_handlers.find(topic);
+            if (it == m_handlers.end()) {
+                return;
+            }
+            handler = it->second;
+        }
+        handler(topic, payload);
+    }
+
+    std::atomic<uint64_t> m_messages{0};
+    std::atomic<uint64_t> m_bytes{0};
+
+private:
+    Observer m_observer;
+    std::mutex m_mutex;
+    std::map<std::string, MessageHandler> m_handlers;
+};
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t num_lifts = argc > 1 ? std::stoul(argv[1]) : 4;
+    const size_t num_doors = argc > 2 ? std::stoul(argv[2]) : 16;
+    const int seconds = argc > 3 ? std::stoi(argv[3]) : 10;
+    const auto command_interval =
+        std::chrono::milliseconds(argc > 4 ? std::stoi(argv[4]) : 1000);
+    const std::string metrics_file = argc > 5 ? argv[5] : "";
+    const bool lift_notifications = argc > 6 && std::stoi(argv[6]);
+    const bool lift_resolve_by_name = argc > 7 && std::stoi(argv[7]);
+    const auto lift_outage =
+        std::chrono::milliseconds(argc > 8 ? std::stoi(argv[8]) : 0);
+
+    boost::log::core::get()->set_filter(
+        boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    // simulated PLCs
+    std::vector<std::unique_ptr<DeviceProbe>> lift_probes;
+    std::vector<std::unique_ptr<DeviceProbe>> door_probes;
+    std::vector<std::unique_ptr<LiftSimulator>> lifts;
+    std::vector<std::unique_ptr<DoorSimulator>> doors;
+    std::map<std::string, DeviceProbe *> probes;
+    for (size_t i = 0; i < num_lifts; ++i) {
+        lift_probes.push_back(std::make_unique<DeviceProbe>());
+        lifts.push_back(std::make_unique<LiftSimulator>(*lift_probes.back()));
+        probes["lift_" + std::to_string(i)] = lift_probes.back().get();
+    }
+    for (size_t i = 0; i < num_doors; ++i) {
+        door_probes.push_back(std::make_unique<DeviceProbe>());
+        doors.push_back(std::make_unique<DoorSimulator>(*door_probes.back()));
+        probes["door_" + std::to_string(i)] = door_probes.back().get();
+    }
+
+    // adapter configuration pointing at the simulators
+    char dir_template[] = "/tmp/trl_load_harness_XXXXXX";
+    const std::string dir = mkdtemp(dir_template);
+    const std::string aws_path = dir + "/aws_iot_config.yaml";
+    const std::string lift_path = dir + "/lift_config.yaml";
+    const std::string doors_path = dir + "/doors_config.yaml";
+    {
+        std::ofstream aws(aws_path);
+        aws << "lift_state_topic: \"bench/lift/state\"\n"
+            << "lift_command_topic: \"bench/lift/command\"\n"
+            << "door_state_topic: \"bench/door/state\"\n"
+            << "door_command_topic: \"bench/door/command\"\n"
+            << "schedule_stats_interval: 0\n";
+        if (!metrics_file.empty()) {
+            aws << "metrics_file: \"" << metrics_file << "\"\n"
+                << "metrics_interval: 1\n";
+        }
+        std::ofstream lift(lift_path);
+        for (size_t i = 0; i < num_lifts; ++i) {
+            lift << "lift_" << i << ":\n"
+                 << "  remoteIP: \"127.0.0.1:" << lifts[i]->Port() << "\"\n"
+                 << "  remoteNetID: \"10.0." << i / 250 << "." << i % 250
+                 << ".1.1\"\n"
+                 << "  localNetID: \"127.0.0.1.1.1\"\n"
+                 << "  poll_period_ms: 100\n"
+                 << "  publish_period_ms: 100\n"
+                 << "  notifications: "
+                 << (lift_notifications ? "true" : "false") << "\n"
+                 << "  resolve_symbols_by_name: "
+                 << (lift_resolve_by_name ? "true" : "false") << "\n"
+                 << "  variables:\n";
+            for (const auto &symbol : LiftSimulator::Symbols()) {
+                lift << "    " << symbol[0] << ": " << symbol[1] << "\n";
+            }
+            lift << "  available_floors: [\"1\", \"2\", \"3\", \"4\", \"5\", "
+                    "\"6\"]\n"
+                 << "  available_modes: [0, 1, 2, 3]\n";
+        }
+        std::ofstream door(doors_path);
+        for (size_t i = 0; i < num_doors; ++i) {
+            door << "door_" << i << ":\n"
+                 << "  modbusIP: \"127.0.0.1\"\n"
+                 << "  modbusPort: " << doors[i]->Port() << "\n"
+                 << "  slaveID: 1\n"
+                 << "  retries: 1\n"
+                 << "  poll_period_ms: 100\n"
+                 << "  publish_period_ms: 100\n";
+        }
+    }
+
+    // decode published states for the probes
+    auto observer = [&](const std::string & /*topic*/, const std::string &payload) {
+        const auto now = Clock::now();
+        auto observe = [&](const nlohmann::json &state) {
+            if (state.contains("lift_name")) {
+                const auto probe = probes.find(state["lift_name"]);
+                if (probe != probes.end()) {
+                    probe->second->Published(
+                        state["currrent_floor"].dump() + "/" +
+                            state["motion_state"].dump(),
+                        now);
+                }
+            } else if (state.contains("door_name")) {
+                const auto probe = probes.find(state["door_name"]);
+                if (probe != probes.end()) {
+                    probe->second->Published(
+                        state["current_mode"].dump(),
+                        now);
+                }
+            }
+        };
+        const auto message = nlohmann::json::parse(payload);
+        if (message.is_array()) {
+            for (const auto &state : message) {
+                observe(state);
+            }
+        } else {
+            observe(message);
+        }
+    };
+    auto transport = std::make_shared<LoopbackTransport>(observer);
+
+    TRLIotCoreAdapter adapter;
+    if (!adapter.Initialize(aws_path, lift_path, doors_path, transport)) {
+        std::cerr << "adapter initialization failed\n";
+        return 1;
+    }
+
+    std::atomic<bool> running{true};
+    std::thread adapter_thread([&]() {
+        adapter.Run([&]() { return running.load(); });
+    });
+    // advances the simulated PLC programs
+    std::thread plc_thread([&]() {
+        while (running) {
+            const auto now = Clock::now();
+            for (auto &lift : lifts) {
+                lift->Tick(now);
+            }
+            for (auto &door : doors) {
+                door->Tick(now);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    // optionally takes the first lift PLC off the network for a while
+    std::thread outage_thread([&]() {
+        if (!lift_outage.count() || lifts.empty()) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(seconds) / 3);
+        lifts[0]->SetOffline(true);
+        std::this_thread::sleep_for(lift_outage);
+        lifts[0]->SetOffline(false);
+    });
+
+    // every device gets one command per interval, alternating its target
+    uint64_t commands = 0;
+    uint64_t lost = 0;
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::seconds(seconds);
+    for (size_t round = 0; Clock::now() < end; ++round) {
+        const auto round_start = Clock::now();
+        const int request_time =
+            std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        for (size_t i = 0; i < num_lifts; ++i) {
+            DeviceProbe &probe = *lift_probes[i];
+            {
+                std::scoped_lock lock(probe.mutex);
+                if (probe.command_pending) {
+                    if (round_start - probe.command_time < kCommandTimeout) {
+                        continue;
+                    }
+                    lost++;
+                }
+            }
+            nlohmann::json command;
+            command["lift_name"] = "lift_" + std::to_string(i);
+            command["request_time"] = request_time;
+            command["session_id"] = "load_harness";
+            command["request_type"] = 1;
+            command["destination_floor"] = round % 2 ? 1 : 6;
+            command["door_state"] = 0;
+            probe.CommandSent(Clock::now());
+            transport->Deliver("bench/lift/command", command.dump());
+            commands++;
+        }
+        for (size_t i = 0; i < num_doors; ++i) {
+            DeviceProbe &probe = *door_probes[i];
+            {
+                std::scoped_lock lock(probe.mutex);
+                if (probe.command_pending) {
+                    if (round_start - probe.command_time < kCommandTimeout) {
+                        continue;
+                    }
+                    lost++;
+                }
+            }
+            nlohmann::json command;
+            command["door_name"] = "door_" + std::to_string(i);
+            command["request_time"] = request_time;
+            command["requester_id"] = "load_harness";
+            command["requested_mode"] = round % 2 ? 0 : 2;
+            probe.CommandSent(Clock::now());
+            transport->Deliver("bench/door/command", command.dump());
+            commands++;
+        }
+        std::this_thread::sleep_until(round_start + command_interval);
+    }
+    const double elapsed =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    running = false;
+    outage_thread.join();
+    adapter_thread.join();
+    plc_thread.join();
+
+    uint64_t overruns = 0;
+    for (const auto &stats : adapter.ScheduleStats()) {
+        overruns += stats.overruns;
+    }
+
+    std::printf(
+        "lifts=%zu doors=%zu duration=%.1fs command_interval=%lldms\n",
+        num_lifts,
+        num_doors,
+        elapsed,
+        static_cast<long long>(command_interval.count()));
+    std::printf(
+        "commands sent=%llu lost=%llu throughput=%.1f/s\n",
+        static_cast<unsigned long long>(commands),
+        static_cast<unsigned long long>(lost),
+        commands / elapsed);
+    std::printf(
+        "published messages=%llu (%.1f/s) bytes=%llu (%.1f KB/s)\n",
+        static_cast<unsigned long long>(transport->m_messages.load()),
+        transport->m_messages / elapsed,
+        static_cast<unsigned long long>(transport->m_bytes.load()),
+        transport->m_bytes / elapsed / 1024.0);
+    uint64_t ads_requests = 0;
+    uint64_t symbol_uploads = 0;
+    uint64_t symbol_lookups = 0;
+    for (const auto &lift : lifts) {
+        ads_requests += lift->Requests();
+        symbol_uploads += lift->SymbolUploads();
+        symbol_lookups += lift->SymbolLookups();
+    }
+    std::printf(
+        "lift ADS requests=%llu (%.1f/s) symbol uploads=%llu "
+        "lookups=%llu\n",
+        static_cast<unsigned long long>(ads_requests),
+        ads_requests / elapsed,
+        static_cast<unsigned long long>(symbol_uploads),
+        static_cast<unsigned long long>(symbol_lookups));
+    std::printf(
+        "schedule overruns=%llu\n",
+        static_cast<unsigned long long>(overruns));
+    g_command_latency.Print("command -> first PLC write");
+    g_publish_latency.Print("PLC state change -> publish");
+
+    std::remove(aws_path.c_str());
+    std::remove(lift_path.c_str());
+    std::remove(doors_path.c_str());
+    rmdir(dir.c_str());
+    return 0;
+}
@@ -0,0 +1,1049 @@
+// Simulated door controllers and lift PLCs shared by the benchmarks.
+//
+// Every simulator listens on 127.0.0.1 and speaks enough Modbus/TCP or
+// ADS/AMS for TRLDoorInterface and TRLLiftInterface. A DeviceProbe records
+// the latency from a command to its PLC write and from a state change to its
+// publication.
+
+#ifndef TRL_BENCHMARK_SIMULATORS_HPP
+#define TRL_BENCHMARK_SIMULATORS_HPP
+
+#include "AdsInterface.hpp"
+#include "TRLDoorInterface.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// time a simulated lift needs to travel one floor
+inline const auto kFloorTime = std::chrono::milliseconds(200);
+// time a simulated door needs to open or close
+inline const auto kDoorTravelTime = std::chrono::milliseconds(300);
+
+inline double Millis(Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+/**
+ * @brief Thread safe collection of latency samples
+ */
+class LatencyRecorder {
+public:
+    void Record(Clock::duration latency)
+    {
+        std::scoped_lock lock(m_mutex);
+        m_samples.push_back(Millis(latency));
+    }
+
+    void Print(const char *name)
+    {
+        std::scoped_lock lock(m_mutex);
+        std::sort(m_samples.begin(), m_samples.end());
+        auto at = [&](double q) {
+            if (m_samples.empty()) {
+                return 0.0;
+            }
+            const size_t i = std::min(
+                m_samples.size() - 1,
+                static_cast<size_t>(q * m_samples.size()));
+            return m_samples[i];
+        };
+        std::printf(
+            "%-32s n=%-7zu p50=%8.2fms p99=%8.2fms p999=%8.2fms "
+            "max=%8.2fms\n",
+            name,
+            m_samples.size(),
+            at(0.5),
+            at(0.99),
+            at(0.999),
+            m_samples.empty() ? 0.0 : m_samples.back());
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<double> m_samples;
+};
+
+inline LatencyRecorder g_command_latency;  // command receipt to first PLC write
+inline LatencyRecorder g_publish_latency;  // PLC state change to publication
+
+/**
+ * @brief Tracks the outstanding command and the last state change of one
+ * simulated device
+ */
+struct DeviceProbe {
+    std::mutex mutex;
+    bool command_pending = false;    // a command awaits its PLC write
+    Clock::time_point command_time;  // time the command was delivered
+    bool change_pending = false;     // a state change awaits publication
+    Clock::time_point change_time;   // time of the last state change
+    std::string published;           // last published state fields
+
+    void CommandSent(Clock::time_point now)
+    {
+        std::scoped_lock lock(mutex);
+        command_pending = true;
+        command_time = now;
+    }
+
+    void PlcWritten(Clock::time_point now)
+    {
+        std::scoped_lock lock(mutex);
+        if (command_pending) {
+            command_pending = false;
+            g_command_latency.Record(now - command_time);
+        }
+    }
+
+    void StateChanged(Clock::time_point now)
+    {
+        std::scoped_lock lock(mutex);
+        change_pending = true;
+        change_time = now;
+    }
+
+    // fields is the part of the published state the simulator changes
+    void Published(const std::string &fields, Clock::time_point now)
+    {
+        std::scoped_lock lock(mutex);
+        if (fields != published) {
+            published = fields;
+            if (change_pending) {
+                change_pending = false;
+                g_publish_latency.Record(now - change_time);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Minimal blocking TCP server on 127.0.0.1, one thread per client
+ */
+class TcpServer {
+public:
+    using Session = std::function<void(int fd)>;
+
+    explicit TcpServer(Session session) : m_session(std::move(session))
+    {
+        m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (bind(m_listen_fd, (sockaddr *)&addr, sizeof(addr)) ||
+            listen(m_listen_fd, 16)) {
+            throw std::runtime_error("TcpServer bind/listen failed");
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(m_listen_fd, (sockaddr *)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+        m_accept_thread = std::thread([this]() { Accept(); });
+    }
+
+    ~TcpServer()
+    {
+        m_stop = true;
+        shutdown(m_listen_fd, SHUT_RDWR);
+        close(m_listen_fd);
+        m_accept_thread.join();
+        {
+            std::scoped_lock lock(m_mutex);
+            for (const int fd : m_clients) {
+                shutdown(fd, SHUT_RDWR);
+            }
+        }
+        for (auto &thread : m_client_threads) {
+            thread.join();
+        }
+        for (const int fd : m_clients) {
+            close(fd);
+        }
+    }
+
+    uint16_t Port() const
+    {
+        return m_port;
+    }
+
+    static bool ReadFull(int fd, uint8_t *data, size_t size)
+    {
+        while (size) {
+            const ssize_t n = recv(fd, data, size, 0);
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    // resets the connections of the current clients
+    void DropClients()
+    {
+        std::scoped_lock lock(m_mutex);
+        for (const int fd : m_clients) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    static bool WriteFull(int fd, const uint8_t *data, size_t size)
+    {
+        while (size) {
+            const ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            size -= n;
+        }
+        return true;
+    }
+
+private:
+    void Accept()
+    {
+        while (!m_stop) {
+            const int fd = accept(m_listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::scoped_lock lock(m_mutex);
+            if (m_stop) {
+                close(fd);
+                return;
+            }
+            m_clients.push_back(fd);
+            m_client_threads.emplace_back([this, fd]() { m_session(fd); });
+        }
+    }
+
+    Session m_session;
+    int m_listen_fd = -1;
+    uint16_t m_port = 0;
+    std::atomic<bool> m_stop{false};
+    std::thread m_accept_thread;
+    std::mutex m_mutex;
+    std::vector<int> m_clients;
+    std::vector<std::thread> m_client_threads;
+};
+
+/**
+ * @brief Simulated door controller answering Modbus/TCP read coils (0x01)
+ * and write single coil (0x05)
+ */
+class DoorSimulator {
+public:
+    explicit DoorSimulator(DeviceProbe &probe)
+        : m_probe(probe), m_server([this](int fd) { Serve(fd); })
+    {
+        m_coils[DOOR_CLOSE_STATE] = true;
+    }
+
+    uint16_t Port() const
+    {
+        return m_server.Port();
+    }
+
+    // moves the door to its target position once the travel time elapsed
+    void Tick(Clock::time_point now)
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_moving && now >= m_arrival) {
+            m_moving = false;
+            m_coils[DOOR_OPEN_STATE] = m_target_open;
+            m_coils[DOOR_CLOSE_STATE] = !m_target_open;
+            m_probe.StateChanged(now);
+        }
+    }
+
+private:
+    void Serve(int fd)
+    {
+        uint8_t request[260];
+        while (TcpServer::ReadFull(fd, request, 7)) {
+            const size_t length = (request[4] << 8) | request[5];
+            if (length < 2 || length > 253 ||
+                !TcpServer::ReadFull(fd, request + 7, length - 1)) {
+                return;
+            }
+            const uint8_t function = request[7];
+            const uint16_t address = (request[8] << 8) | request[9];
+            const uint16_t value = (request[10] << 8) | request[11];
+            uint8_t response[260];
+            std::memcpy(response, request, 8);
+            size_t size = 0;
+            if (function == READ_COILS) {
+                const size_t bytes = (value + 7) / 8;
+                response[8] = static_cast<uint8_t>(bytes);
+                std::memset(response + 9, 0, bytes);
+                std::scoped_lock lock(m_mutex);
+                for (uint16_t i = 0; i < value; ++i) {
+                    if (address + i < kCoils && m_coils[address + i]) {
+                        response[9 + i / 8] |= 1 << (i % 8);
+                    }
+                }
+                size = 9 + bytes;
+            } else if (function == WRITE_COIL) {
+                std::memcpy(response + 8, request + 8, 4);
+                size = 12;
+                Write(address, value == 0xFF00);
+            } else {
+                response[7] = function | 0x80;
+                response[8] = EX_ILLEGAL_FUNCTION;
+                size = 9;
+            }
+            response[4] = static_cast<uint8_t>((size - 6) >> 8);
+            response[5] = static_cast<uint8_t>(size - 6);
+            if (!TcpServer::WriteFull(fd, response, size)) {
+                return;
+            }
+        }
+    }
+
+    void Write(uint16_t address, bool value)
+    {
+        const auto now = Clock::now();
+        if (address != DOOR_ACTUATE) {
+            return;
+        }
+        m_probe.PlcWritten(now);
+        std::scoped_lock lock(m_mutex);
+        m_coils[DOOR_ACTUATE] = value;
+        if (m_coils[DOOR_OPEN_STATE] == value && !m_moving) {
+            return;
+        }
+        // both end switches are released while the door travels
+        m_coils[DOOR_OPEN_STATE] = false;
+        m_coils[DOOR_CLOSE_STATE] = false;
+        m_moving = true;
+        m_target_open = value;
+        m_arrival = now + kDoorTravelTime;
+        m_probe.StateChanged(now);
+    }
+
+    static const size_t kCoils = 32;
+
+    DeviceProbe &m_probe;
+    std::mutex m_mutex;
+    bool m_coils[kCoils] = {};
+    bool m_moving = false;
+    bool m_target_open = false;
+    Clock::time_point m_arrival;
+    TcpServer m_server;  // started last, it calls Serve()
+};
+
+/**
+ * @brief Simulated lift PLC answering the ADS commands used by
+ * TRLLiftInterface: read state, symbol upload, handles by name and reads and
+ * writes by handle, also bundled in sum-up requests
+ */
+class LiftSimulator {
+public:
+    explicit LiftSimulator(DeviceProbe &probe)
+        : m_probe(probe), m_server([this](int fd) { Serve(fd); })
+    {
+    }
+
+    uint16_t Port() const
+    {
+        return m_server.Port();
+    }
+
+    // symbol names, aliases and types of the simulated PLC program
+    static const std::vector<std::vector<std::string>> &Symbols()
+    {
+        static const std::vector<std::vector<std::string>> symbols = {
+            {"TransportOp_GVL.liftTask", "liftTask", "BOOL"},
+            {"TransportOp_GVL.endLiftTask", "endLiftTask", "BOOL"},
+            {"TransportOp_GVL.robotDestinationFloor",
+             "robotDestinationFloor",
+             "SINT"},
+            {"TransportOp_GVL.liftDestinationFloor",
+             "liftDestinationFloor",
+             "SINT"},
+            {"TransportOp_GVL.liftCurrentFloor", "liftCurrentFloor", "SINT"},
+            {"TransportOp_GVL.liftDoorState", "liftDoorState", "INT"},
+            {"TransportOp_GVL.liftMotionState", "liftMotionState", "INT"},
+            {"TransportOp_GVL.fireAlarm", "fireAlarm", "BOOL"},
+            {"TransportOp_GVL.turnKeyToManual", "turnKeyToManual", "BOOL"},
+            {"TransportOp_GVL.agvMode", "agvMode", "BOOL"},
+            {"TransportOp_GVL.randomCount", "randomCount", "INT"},
+            {"TwinCAT_SystemInfoVarList._TaskInfo[1].CycleCount",
+             "plcCycleCount",
+             "UDINT"},
+        };
+        return symbols;
+    }
+
+    // advances the cabin and notifies the changes
+    void Tick(Clock::time_point now)
+    {
+        Advance(now);
+        SendNotifications();
+    }
+
+    // ADS requests served so far
+    uint64_t Requests() const
+    {
+        return m_requests;
+    }
+
+    // symbol table uploads served so far
+    uint64_t SymbolUploads() const
+    {
+        return m_symbol_uploads;
+    }
+
+    // symbols resolved by name so far
+    uint64_t SymbolLookups() const
+    {
+        return m_symbol_lookups;
+    }
+
+    // one way delay of the link, added to every response. Requests keep
+    // being served while earlier responses are delayed.
+    void SetLinkLatency(Clock::duration latency)
+    {
+        m_link_latency = latency;
+    }
+
+    // an offline PLC resets its connections and every new one
+    void SetOffline(bool offline)
+    {
+        m_offline = offline;
+        if (offline) {
+            m_server.DropClients();
+        }
+    }
+
+private:
+    // AMS target and source address of the frames sent to a client
+    using Route = std::array<uint8_t, 16>;
+
+    // on-change notification registered by a client
+    struct Subscription {
+        int fd;
+        Route route;
+        uint32_t handle;
+        size_t index;     // symbol index
+        uint32_t length;  // sample size
+        bool sent;        // value holds the last sample sent
+        uint64_t value;
+    };
+
+    // runs one PLC cycle, moves the cabin one floor per kFloorTime towards
+    // the destination
+    void Advance(Clock::time_point now)
+    {
+        std::scoped_lock lock(m_mutex);
+        Value<uint32_t>("plcCycleCount")++;
+        int8_t &current = Value<int8_t>("liftCurrentFloor");
+        const int8_t destination = Value<int8_t>("liftDestinationFloor");
+        int16_t &motion = Value<int16_t>("liftMotionState");
+        if (current == destination) {
+            if (motion != 0) {
+                motion = 0;
+                m_probe.StateChanged(now);
+            }
+            return;
+        }
+        if (motion == 0) {
+            motion = 1;
+            m_next_floor = now + kFloorTime;
+            m_probe.StateChanged(now);
+        } else if (now >= m_next_floor) {
+            current += current < destination ? 1 : -1;
+            m_next_floor = now + kFloorTime;
+            m_probe.StateChanged(now);
+        }
+    }
+
+    template <typename T>
+    T &Value(const std::string &alias)
+    {
+        return *reinterpret_cast<T *>(&m_values[m_alias_index.at(alias)]);
+    }
+
+    void Init()
+    {
+        const auto &symbols = Symbols();
+        m_values.assign(symbols.size(), 0);
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            m_name_index[symbols[i][0]] = i;
+            m_alias_index[symbols[i][1]] = i;
+        }
+        Value<int8_t>("liftCurrentFloor") = 1;
+        Value<int8_t>("liftDestinationFloor") = 1;
+        Value<bool>("agvMode") = true;
+        Value<int16_t>("randomCount") = 1;
+    }
+
+    static size_t TypeSize(const std::string &type)
+    {
+        if (type == "UDINT") {
+            return 4;
+        }
+        return type == "INT" ? 2 : 1;
+    }
+
+    // one symbol in the layout of ADSIGRP_SYM_UPLOAD, its value is read by
+    // handle like a handle acquired by name
+    static void AppendSymbol(
+        std::vector<uint8_t> &out,
+        const std::string &name,
+        const std::string &type,
+        uint32_t handle)
+    {
+        AdsSymbolEntry entry{};
+        entry.entryLength =
+            static_cast<uint32_t>(sizeof(entry) + name.size() + type.size() + 3);
+        entry.iGroup = ADSIGRP_SYM_VALBYHND;
+        entry.iOffs = handle;
+        entry.size = static_cast<uint32_t>(TypeSize(type));
+        entry.nameLength = static_cast<uint16_t>(name.size());
+        entry.typeLength = static_cast<uint16_t>(type.size());
+        const auto *raw = reinterpret_cast<const uint8_t *>(&entry);
+        out.insert(out.end(), raw, raw + sizeof(entry));
+        out.insert(out.end(), name.begin(), name.end());
+        out.push_back(0);
+        out.insert(out.end(), type.begin(), type.end());
+        out.push_back(0);
+        out.push_back(0);  // empty comment
+    }
+
+    // symbol table in the layout of ADSIGRP_SYM_UPLOAD
+    static std::vector<uint8_t> SymbolTable()
+    {
+        std::vector<uint8_t> table;
+        const auto &symbols = Symbols();
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            AppendSymbol(table, symbols[i][0], symbols[i][2], i + 1);
+        }
+        // AdsDevice::GetDeviceAdsVariables() ignores the last entry
+        AppendSymbol(table, "TransportOp_GVL.padding", "BOOL", 0);
+        return table;
+    }
+
+    void Serve(int fd)
+    {
+        if (m_offline) {
+            shutdown(fd, SHUT_RDWR);
+            return;
+        }
+        {
+            std::scoped_lock lock(m_mutex);
+            if (m_values.empty()) {
+                Init();
+            }
+        }
+        // responses held back by the link latency are sent by their own
+        // thread
+        std::mutex delayed_mutex;
+        std::condition_variable delayed_cv;
+        std::deque<std::pair<Clock::time_point, std::vector<uint8_t>>> delayed;
+        bool closing = false;
+        std::thread sender([&]() {
+            std::unique_lock<std::mutex> lock(delayed_mutex);
+            for (;;) {
+                delayed_cv.wait(
+                    lock,
+                    [&]() { return closing || !delayed.empty(); });
+                if (delayed.empty()) {
+                    return;
+                }
+                if (Clock::now() < delayed.front().first) {
+                    delayed_cv.wait_until(lock, delayed.front().first);
+                    continue;
+                }
+                const std::vector<uint8_t> response =
+                    std::move(delayed.front().second);
+                delayed.pop_front();
+                lock.unlock();
+                {
+                    std::scoped_lock write_lock(m_write_mutex);
+                    TcpServer::WriteFull(fd, response.data(), response.size());
+                }
+                lock.lock();
+            }
+        });
+
+        const size_t header_size = 6 + 32;
+        std::vector<uint8_t> request;
+        std::vector<uint8_t> data;
+        uint8_t header[header_size];
+        while (TcpServer::ReadFull(fd, header, header_size)) {
+            m_requests++;
+            // notifications go back to the source of the requests
+            Route route;
+            std::memcpy(route.data(), header + 6 + 8, 8);
+            std::memcpy(route.data() + 8, header + 6, 8);
+            uint32_t length;
+            std::memcpy(&length, header + 6 + 20, 4);
+            request.resize(length);
+            if (length && !TcpServer::ReadFull(fd, request.data(), length)) {
+                return;
+            }
+            uint16_t command;
+            std::memcpy(&command, header + 6 + 16, 2);
+            data.clear();
+            Handle(fd, route, command, request, data);
+
+            std::vector<uint8_t> response(header_size + data.size());
+            const uint32_t tcp_length = 32 + data.size();
+            std::memset(response.data(), 0, 2);
+            std::memcpy(response.data() + 2, &tcp_length, 4);
+            // swap target and source address
+            std::memcpy(response.data() + 6, header + 6 + 8, 8);
+            std::memcpy(response.data() + 6 + 8, header + 6, 8);
+            std::memcpy(response.data() + 6 + 16, &command, 2);
+            const uint16_t flags = 0x0005;
+            std::memcpy(response.data() + 6 + 18, &flags, 2);
+            const uint32_t data_length = data.size();
+            std::memcpy(response.data() + 6 + 20, &data_length, 4);
+            std::memset(response.data() + 6 + 24, 0, 4);
+            std::memcpy(response.data() + 6 + 28, header + 6 + 28, 4);
+            std::memcpy(response.data() + header_size, data.data(), data.size());
+            const Clock::duration latency = m_link_latency;
+            if (latency > Clock::duration::zero()) {
+                {
+                    std::scoped_lock lock(delayed_mutex);
+                    delayed.emplace_back(
+                        Clock::now() + latency,
+                        std::move(response));
+                }
+                delayed_cv.notify_one();
+            } else {
+                std::scoped_lock lock(m_write_mutex);
+                if (!TcpServer::WriteFull(
+                        fd,
+                        response.data(),
+                        response.size())) {
+                    break;
+                }
+            }
+            SendNotifications();
+        }
+        {
+            std::scoped_lock lock(delayed_mutex);
+            closing = true;
+        }
+        delayed_cv.notify_one();
+        sender.join();
+        std::scoped_lock lock(m_mutex);
+        m_subscriptions.erase(
+            std::remove_if(
+                m_subscriptions.begin(),
+                m_subscriptions.end(),
+                [fd](const Subscription &s) { return s.fd == fd; }),
+            m_subscriptions.end());
+    }
+
+    uint32_t AddNotification(
+        int fd,
+        const Route &route,
+        uint32_t group,
+        uint32_t offset,
+        uint32_t length,
+        uint32_t &handle)
+    {
+        std::scoped_lock lock(m_mutex);
+        if (group != ADSIGRP_SYM_VALBYHND || offset == 0 ||
+            offset > m_values.size() || length > sizeof(uint64_t)) {
+            return ADSERR_DEVICE_INVALIDOFFSET;
+        }
+        handle = m_next_notification++;
+        m_subscriptions.push_back(
+            Subscription{fd, route, handle, offset - 1, length, false, 0});
+        return 0;
+    }
+
+    uint32_t DeleteNotification(uint32_t handle)
+    {
+        std::scoped_lock lock(m_mutex);
+        const auto it = std::find_if(
+            m_subscriptions.begin(),
+            m_subscriptions.end(),
+            [handle](const Subscription &s) { return s.handle == handle; });
+        if (it == m_subscriptions.end()) {
+            return ADSERR_DEVICE_NOTIFYHNDINVALID;
+        }
+        m_subscriptions.erase(it);
+        return 0;
+    }
+
+    // sends the values changed since the last samples, one frame per client
+    void SendNotifications()
+    {
+        struct Frame {
+            Route route;
+            uint32_t samples = 0;
+            std::vector<uint8_t> data;
+        };
+        std::map<int, Frame> frames;
+        {
+            std::scoped_lock lock(m_mutex);
+            for (auto &subscription : m_subscriptions) {
+                uint64_t value = 0;
+                std::memcpy(
+                    &value,
+                    &m_values[subscription.index],
+                    subscription.length);
+                if (subscription.sent && value == subscription.value) {
+                    continue;
+                }
+                subscription.sent = true;
+                subscription.value = value;
+                Frame &frame = frames[subscription.fd];
+                frame.route = subscription.route;
+                frame.samples++;
+                Put<uint32_t>(frame.data, subscription.handle);
+                Put<uint32_t>(frame.data, subscription.length);
+                const auto *raw = reinterpret_cast<const uint8_t *>(&value);
+                frame.data.insert(
+                    frame.data.end(),
+                    raw,
+                    raw + subscription.length);
+            }
+        }
+
+        const size_t header_size = 6 + 32;
+        for (const auto &[fd, frame] : frames) {
+            // {length, stamps, {timestamp, samples, sample...}}
+            std::vector<uint8_t> data;
+            Put<uint32_t>(data, 0);
+            Put<uint32_t>(data, 1);
+            Put<uint64_t>(data, 0);
+            Put<uint32_t>(data, frame.samples);
+            data.insert(data.end(), frame.data.begin(), frame.data.end());
+            const uint32_t stream_length = data.size() - 4;
+            std::memcpy(data.data(), &stream_length, 4);
+
+            std::vector<uint8_t> message(header_size + data.size(), 0);
+            const uint32_t tcp_length = 32 + data.size();
+            std::memcpy(message.data() + 2, &tcp_length, 4);
+            std::memcpy(message.data() + 6, frame.route.data(), 16);
+            const uint16_t command = 0x0008;
+            std::memcpy(message.data() + 6 + 16, &command, 2);
+            const uint16_t flags = 0x0004;
+            std::memcpy(message.data() + 6 + 18, &flags, 2);
+            const uint32_t data_length = data.size();
+            std::memcpy(message.data() + 6 + 20, &data_length, 4);
+            std::memcpy(message.data() + header_size, data.data(), data.size());
+            std::scoped_lock lock(m_write_mutex);
+            TcpServer::WriteFull(fd, message.data(), message.size());
+        }
+    }
+
+    template <typename T>
+    static void Put(std::vector<uint8_t> &out, T value)
+    {
+        const auto *raw = reinterpret_cast<const uint8_t *>(&value);
+        out.insert(out.end(), raw, raw + sizeof(T));
+    }
+
+    static uint32_t Get(const std::vector<uint8_t> &in, size_t offset)
+    {
+        uint32_t value = 0;
+        if (offset + 4 <= in.size()) {
+            std::memcpy(&value, in.data() + offset, 4);
+        }
+        return value;
+    }
+
+    void Handle(
+        int fd,
+        const Route &route,
+        uint16_t command,
+        const std::vector<uint8_t> &request,
+        std::vector<uint8_t> &out)
+    {
+        const uint32_t group = Get(request, 0);
+        const uint32_t offset = Get(request, 4);
+        const uint32_t length = Get(request, 8);
+        switch (command) {
+            case 0x0004:  // read state
+                Put<uint32_t>(out, 0);
+                Put<uint16_t>(out, ADSSTATE_RUN);
+                Put<uint16_t>(out, 0);
+                return;
+            case 0x0002: {  // read
+                std::vector<uint8_t> value;
+                uint32_t error = Read(group, offset, value);
+                value.resize(std::min<size_t>(value.size(), length));
+                Put<uint32_t>(out, error);
+                Put<uint32_t>(out, value.size());
+                out.insert(out.end(), value.begin(), value.end());
+                return;
+            }
+            case 0x0003: {  // write
+                const uint8_t *payload = request.data() + 12;
+                Put<uint32_t>(out, Write(group, offset, payload, length));
+                return;
+            }
+            case 0x0009: {  // read write
+                const uint32_t write_length = Get(request, 12);
+                std::vector<uint8_t> value;
+                const uint32_t error = ReadWrite(
+                    fd,
+                    route,
+                    group,
+                    offset,
+                    request.data() + 16,
+                    std::min<size_t>(write_length, request.size() - 16),
+                    value);
+                value.resize(std::min<size_t>(value.size(), length));
+                Put<uint32_t>(out, error);
+                Put<uint32_t>(out, value.size());
+                out.insert(out.end(), value.begin(), value.end());
+                return;
+            }
+            case 0x0006: {  // add device notification
+                uint32_t handle = 0;
+                Put<uint32_t>(
+                    out,
+                    AddNotification(fd, route, group, offset, length, handle));
+                Put<uint32_t>(out, handle);
+                return;
+            }
+            case 0x0007:  // delete device notification, group is the handle
+                Put<uint32_t>(out, DeleteNotification(group));
+                return;
+            default:
+                Put<uint32_t>(out, ADSERR_DEVICE_SRVNOTSUPP);
+        }
+    }
+
+    // handles by name, values by handle and the ADSIGRP_SUMUP_* requests
+    uint32_t ReadWrite(
+        int fd,
+        const Route &route,
+        uint32_t group,
+        uint32_t offset,
+        const uint8_t *data,
+        size_t write_length,
+        std::vector<uint8_t> &out)
+    {
+        const std::vector<uint8_t> in(data, data + write_length);
+        if (group == ADSIGRP_SYM_HNDBYNAME) {
+            const std::string name(
+                reinterpret_cast<const char *>(data),
+                strnlen(reinterpret_cast<const char *>(data), write_length));
+            std::scoped_lock lock(m_mutex);
+            const auto symbol = m_name_index.find(name);
+            if (symbol == m_name_index.end()) {
+                return ADSERR_DEVICE_SYMBOLNOTFOUND;
+            }
+            Put<uint32_t>(out, symbol->second + 1);
+            return 0;
+        }
+        if (group == ADSIGRP_SYM_INFOBYNAMEEX) {
+            const std::string name(
+                reinterpret_cast<const char *>(data),
+                strnlen(reinterpret_cast<const char *>(data), write_length));
+            std::scoped_lock lock(m_mutex);
+            const auto symbol = m_name_index.find(name);
+            if (symbol == m_name_index.end()) {
+                return ADSERR_DEVICE_SYMBOLNOTFOUND;
+            }
+            m_symbol_lookups++;
+            AppendSymbol(
+                out,
+                name,
+                Symbols()[symbol->second][2],
+                symbol->second + 1);
+            return 0;
+        }
+        if (group == ADSIGRP_SYM_VALBYHND) {
+            // writes the value, then reads it back
+            if (write_length) {
+                const uint32_t error = Write(group, offset, data, write_length);
+                if (error) {
+                    return error;
+                }
+            }
+            return Read(group, offset, out);
+        }
+        if (group == ADSIGRP_SUMUP_READ) {
+            std::vector<uint8_t> values;
+            for (uint32_t i = 0; i < offset; ++i) {
+                std::vector<uint8_t> value;
+                const uint32_t length = Get(in, i * 12 + 8);
+                const uint32_t error =
+                    Read(Get(in, i * 12), Get(in, i * 12 + 4), value);
+                value.resize(length);
+                Put<uint32_t>(out, error);
+                values.insert(values.end(), value.begin(), value.end());
+            }
+            out.insert(out.end(), values.begin(), values.end());
+            return 0;
+        }
+        if (group == ADSIGRP_SUMUP_WRITE) {
+            size_t position = offset * 12;
+            for (uint32_t i = 0; i < offset; ++i) {
+                const uint32_t length = Get(in, i * 12 + 8);
+                if (position + length > in.size()) {
+                    return ADSERR_DEVICE_INVALIDSIZE;
+                }
+                Put<uint32_t>(
+                    out,
+                    Write(
+                        Get(in, i * 12),
+                        Get(in, i * 12 + 4),
+                        in.data() + position,
+                        length));
+                position += length;
+            }
+            return 0;
+        }
+        if (group == ADSIGRP_SUMUP_ADDDEVNOTE) {
+            // AdsAddDeviceNotificationRequest per notification
+            for (uint32_t i = 0; i < offset; ++i) {
+                uint32_t handle = 0;
+                Put<uint32_t>(
+                    out,
+                    AddNotification(
+                        fd,
+                        route,
+                        Get(in, i * 40),
+                        Get(in, i * 40 + 4),
+                        Get(in, i * 40 + 8),
+                        handle));
+                Put<uint32_t>(out, handle);
+            }
+            return 0;
+        }
+        if (group == ADSIGRP_SUMUP_DELDEVNOTE) {
+            // a handle per notification
+            for (uint32_t i = 0; i < offset; ++i) {
+                Put<uint32_t>(out, DeleteNotification(Get(in, i * 4)));
+            }
+            return 0;
+        }
+        if (group == ADSIGRP_SUMUP_READWRITE) {
+            std::vector<uint8_t> values;
+            size_t position = offset * 16;
+            for (uint32_t i = 0; i < offset; ++i) {
+                const uint32_t length = Get(in, i * 16 + 8);
+                const uint32_t sub_write_length = Get(in, i * 16 + 12);
+                if (position + sub_write_length > in.size()) {
+                    return ADSERR_DEVICE_INVALIDSIZE;
+                }
+                std::vector<uint8_t> value;
+                const uint32_t error = ReadWrite(
+                    fd,
+                    route,
+                    Get(in, i * 16),
+                    Get(in, i * 16 + 4),
+                    in.data() + position,
+                    sub_write_length,
+                    value);
+                value.resize(std::min<size_t>(value.size(), length));
+                position += sub_write_length;
+                Put<uint32_t>(out, error);
+                Put<uint32_t>(out, value.size());
+                values.insert(values.end(), value.begin(), value.end());
+            }
+            out.insert(out.end(), values.begin(), values.end());
+            return 0;
+        }
+        return ADSERR_DEVICE_SRVNOTSUPP;
+    }
+
+    uint32_t Read(uint32_t group, uint32_t offset, std::vector<uint8_t> &out)
+    {
+        if (group == ADSIGRP_SYM_UPLOADINFO) {
+            const auto table = SymbolTable();
+            Put<uint32_t>(out, Symbols().size() + 1);
+            Put<uint32_t>(out, table.size());
+            return 0;
+        }
+        if (group == ADSIGRP_SYM_UPLOAD) {
+            m_symbol_uploads++;
+            out = SymbolTable();
+            return 0;
+        }
+        if (group == ADSIGRP_SYM_VERSION) {
+            out.push_back(1);
+            return 0;
+        }
+        std::scoped_lock lock(m_mutex);
+        if (group != ADSIGRP_SYM_VALBYHND || offset == 0 ||
+            offset > m_values.size()) {
+            return ADSERR_DEVICE_INVALIDOFFSET;
+        }
+        const auto *raw =
+            reinterpret_cast<const uint8_t *>(&m_values[offset - 1]);
+        out.assign(raw, raw + sizeof(uint64_t));
+        return 0;
+    }
+
+    uint32_t Write(
+        uint32_t group,
+        uint32_t offset,
+        const uint8_t *data,
+        uint32_t length)
+    {
+        if (group == ADSIGRP_SYM_RELEASEHND) {
+            return 0;
+        }
+        const auto now = Clock::now();
+        m_probe.PlcWritten(now);
+        std::scoped_lock lock(m_mutex);
+        if (group != ADSIGRP_SYM_VALBYHND || offset == 0 ||
+            offset > m_values.size() || length > sizeof(uint64_t)) {
+            return ADSERR_DEVICE_INVALIDOFFSET;
+        }
+        uint64_t value = 0;
+        std::memcpy(&value, data, length);
+        m_values[offset - 1] = value;
+        // the PLC program takes over the robot destination
+        if (Symbols()[offset - 1][1] == "robotDestinationFloor") {
+            Value<int8_t>("liftDestinationFloor") =
+                static_cast<int8_t>(value);
+        }
+        return 0;
+    }
+
+    DeviceProbe &m_probe;
+    std::mutex m_mutex;
+    std::mutex m_write_mutex;  // serializes responses and notifications
+    std::atomic<uint64_t> m_requests{0};
+    std::atomic<uint64_t> m_symbol_uploads{0};
+    std::atomic<uint64_t> m_symbol_lookups{0};
+    std::atomic<bool> m_offline{false};
+    std::atomic<Clock::duration> m_link_latency{Clock::duration::zero()};
+    std::vector<uint64_t> m_values;  // value of each symbol, by handle - 1
+    std::vector<Subscription> m_subscriptions;
+    uint32_t m_next_notification = 1;
+    std::map<std::string, size_t> m_name_index;
+    std::map<std::string, size_t> m_alias_index;
+    Clock::time_point m_next_floor;
+    TcpServer m_server;  // started last, it calls Serve()
+};
+
+#endif  // TRL_BENCHMARK_SIMULATORS_HPP
@@ -0,0 +1,130 @@
+// Compares the nlohmann::json publish path with TRLStateSerializer.
+// Checks that both produce the same bytes, then reports time and heap
+// allocations per serialized state.
+
+#include "TRLStateSerializer.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> g_allocations{0};
+
+void *operator new(size_t size)
+{
+    g_allocations++;
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+static std::string JsonDoor(const TRLDoorState &x)
+{
+    nlohmann::json door_state;
+    door_state["door_time"] = x.door_time;
+    door_state["door_name"] = x.door_name;
+    door_state["current_mode"] = x.current_mode;
+    // the old path dumped twice and copied the result into the payload
+    return std::string(door_state.dump().c_str(), door_state.dump().size());
+}
+
+static std::string JsonLift(const TRLLiftState &x)
+{
+    nlohmann::json lift_state;
+    lift_state["lift_time"] = x.lift_time;
+    lift_state["lift_name"] = x.lift_name;
+    lift_state["available_floors"] = x.available_floors;
+    lift_state["currrent_floor"] = x.current_floor;
+    lift_state["destination_floor"] = x.destination_floor;
+    lift_state["door_state"] = x.door_state;
+    lift_state["motion_state"] = x.motion_state;
+    lift_state["available_modes"] = x.available_modes;
+    lift_state["lift_mode"] = x.lift_mode;
+    lift_state["session_id"] = x.session_id;
+    return std::string(lift_state.dump().c_str(), lift_state.dump().size());
+}
+
+template <typename F>
+static void Run(const char *name, size_t iterations, F &&f)
+{
+    const size_t allocations = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        f();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+    std::printf(
+        "%-28s %10.1f ns/op %8.2f allocs/op\n",
+        name,
+        ns / iterations,
+        double(g_allocations.load() - allocations) / iterations);
+}
+
+int main(int argc, char **argv)
+{
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                       : 200000;
+
+    TRLDoorState door;
+    door.door_time = 1700000000;
+    door.door_name = "trl_lvl_2_door";
+    door.current_mode = 2;
+
+    TRLLiftState lift;
+    lift.lift_time = 1700000000;
+    lift.lift_name = "trl_service_lift";
+    lift.available_floors = {"1", "2", "3", "4", "5", "6"};
+    lift.current_floor = "3";
+    lift.destination_floor = "5";
+    lift.door_state = 1;
+    lift.motion_state = 2;
+    lift.available_modes = {0, 1, 2, 3};
+    lift.lift_mode = 2;
+    lift.session_id = "session \"42\"\t\\\x01";
+
+    std::string door_buffer, lift_buffer;
+    TRLStateSerializer::Serialize(door, door_buffer);
+    TRLStateSerializer::Serialize(lift, lift_buffer);
+    if (door_buffer != JsonDoor(door) || lift_buffer != JsonLift(lift)) {
+        std::printf("output mismatch\n%s\n%s\n", door_buffer.c_str(),
+                    JsonDoor(door).c_str());
+        std::printf("%s\n%s\n", lift_buffer.c_str(), JsonLift(lift).c_str());
+        return 1;
+    }
+
+    size_t sink = 0;
+    Run("door nlohmann::json", iterations, [&]() {
+        sink += JsonDoor(door).size();
+    });
+    Run("door TRLStateSerializer", iterations, [&]() {
+        door_buffer.clear();
+        TRLStateSerializer::Serialize(door, door_buffer);
+        sink += door_buffer.size();
+    });
+    Run("lift nlohmann::json", iterations, [&]() {
+        sink += JsonLift(lift).size();
+    });
+    Run("lift TRLStateSerializer", iterations, [&]() {
+        lift_buffer.clear();
+        TRLStateSerializer::Serialize(lift, lift_buffer);
+        sink += lift_buffer.size();
+    });
+    return sink == 0;
+}
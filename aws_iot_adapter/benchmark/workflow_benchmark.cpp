@@ -0,0 +1,365 @@
+// Compares the two ways the adapter executes device commands: a blocking
+// TRLDeviceExecutor thread per device against asynchronous workflows of
+// TRLWorkflowExecutor sharing a few TRLEventLoop threads. Every door and lift
+// gets the same number of commands through the real TRLDoorInterface and
+// TRLLiftInterface code paths.
+//
+// The simulated doors and lifts run in a child process, so the thread count
+// and the context switches reported are the ones of the command execution
+// alone.
+//
+// usage: workflow_benchmark [doors] [lifts] [commands_per_device]
+//                           [event_loops]
+
+#include "TRLDeviceExecutor.hpp"
+#include "TRLDoorInterface.hpp"
+#include "TRLEventLoop.hpp"
+#include "TRLLiftInterface.hpp"
+#include "TRLWorkflowExecutor.hpp"
+#include "simulators.hpp"
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Runs the simulators until the parent closes the pipe
+ */
+void RunSimulators(size_t num_doors, size_t num_lifts, int ports_fd, int stop_fd)
+{
+    DeviceProbe probe;
+    std::vector<std::unique_ptr<DoorSimulator>> doors;
+    std::vector<std::unique_ptr<LiftSimulator>> lifts;
+    std::vector<uint16_t> ports;
+    for (size_t i = 0; i < num_doors; ++i) {
+        doors.push_back(std::make_unique<DoorSimulator>(probe));
+        ports.push_back(doors.back()->Port());
+    }
+    for (size_t i = 0; i < num_lifts; ++i) {
+        lifts.push_back(std::make_unique<LiftSimulator>(probe));
+        ports.push_back(lifts.back()->Port());
+    }
+    (void)!write(ports_fd, ports.data(), ports.size() * sizeof(uint16_t));
+    close(ports_fd);
+    // the commands only write and read back, the devices need not move
+    char byte;
+    while (read(stop_fd, &byte, 1) > 0) {
+    }
+}
+
+size_t Threads()
+{
+    size_t threads = 0;
+    DIR *dir = opendir("/proc/self/task");
+    if (!dir) {
+        return 0;
+    }
+    while (const dirent *entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            threads++;
+        }
+    }
+    closedir(dir);
+    return threads;
+}
+
+long ContextSwitches()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+/**
+ * @brief Counts the finished commands, the main thread waits for all
+ */
+class Completion {
+public:
+    explicit Completion(size_t expected) : m_expected(expected) {}
+
+    void Done(bool success)
+    {
+        std::scoped_lock lock(m_mutex);
+        m_failed += !success;
+        if (++m_done == m_expected) {
+            m_cv.notify_one();
+        }
+    }
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_done == m_expected; });
+    }
+
+    size_t Failed()
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_failed;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    size_t m_expected;
+    size_t m_done = 0;
+    size_t m_failed = 0;
+};
+
+void Report(
+    const char *name,
+    size_t commands,
+    size_t failed,
+    size_t threads,
+    long switches,
+    Clock::duration elapsed)
+{
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    std::printf(
+        "%-28s commands=%-6zu failed=%-4zu threads=%-5zu "
+        "context_switches=%-8ld wall=%8.1fms (%.0f/s)\n",
+        name,
+        commands,
+        failed,
+        threads,
+        switches,
+        Millis(elapsed),
+        commands / seconds);
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t num_doors = argc > 1 ? std::stoul(argv[1]) : 200;
+    const size_t num_lifts = argc > 2 ? std::stoul(argv[2]) : 8;
+    const size_t per_device = argc > 3 ? std::stoul(argv[3]) : 10;
+    const size_t num_loops = argc > 4 ? std::stoul(argv[4]) : 1;
+
+    // forked before the first thread of this process exists
+    int ports_pipe[2];
+    int stop_pipe[2];
+    if (pipe(ports_pipe) || pipe(stop_pipe)) {
+        std::perror("pipe");
+        return 1;
+    }
+    const pid_t simulators = fork();
+    if (simulators == 0) {
+        close(ports_pipe[0]);
+        close(stop_pipe[1]);
+        RunSimulators(num_doors, num_lifts, ports_pipe[1], stop_pipe[0]);
+        _exit(0);
+    }
+    close(ports_pipe[1]);
+    close(stop_pipe[0]);
+    std::vector<uint16_t> ports(num_doors + num_lifts);
+    size_t received = 0;
+    while (received < ports.size() * sizeof(uint16_t)) {
+        const ssize_t n = read(
+            ports_pipe[0],
+            reinterpret_cast<char *>(ports.data()) + received,
+            ports.size() * sizeof(uint16_t) - received);
+        if (n <= 0) {
+            std::fprintf(stderr, "simulators failed to start\n");
+            return 1;
+        }
+        received += n;
+    }
+    close(ports_pipe[0]);
+
+    boost::log::core::get()->set_filter(
+        boost::log::trivial::severity >= boost::log::trivial::warning);
+
+    std::vector<std::shared_ptr<TRLDoorInterface>> doors;
+    for (size_t i = 0; i < num_doors; ++i) {
+        std::ostringstream config;
+        config << "modbusIP: \"127.0.0.1\"\n"
+               << "modbusPort: " << ports[i] << "\n"
+               << "slaveID: 1\n"
+               << "retries: 1\n";
+        doors.push_back(std::make_shared<TRLDoorInterface>());
+        doors.back()->Initialize(
+            "door_" + std::to_string(i),
+            YAML::Load(config.str()));
+    }
+    std::vector<std::shared_ptr<TRLLiftInterface>> lifts;
+    for (size_t i = 0; i < num_lifts; ++i) {
+        std::ostringstream config;
+        config << "remoteIP: \"127.0.0.1:" << ports[num_doors + i] << "\"\n"
+               << "remoteNetID: \"10.0.0." << i << ".1.1\"\n"
+               << "localNetID: \"127.0.0.1.1.1\"\n"
+               << "variables:\n";
+        for (const auto &symbol : LiftSimulator::Symbols()) {
+            config << "  " << symbol[0] << ": " << symbol[1] << "\n";
+        }
+        config << "available_floors: [\"1\", \"2\", \"3\", \"4\", \"5\", "
+                  "\"6\"]\n"
+               << "available_modes: [0, 1, 2, 3]\n";
+        lifts.push_back(std::make_shared<TRLLiftInterface>());
+        lifts.back()->Initialize(
+            "lift_" + std::to_string(i),
+            YAML::Load(config.str()));
+        lifts.back()->SetSessionID("workflow_benchmark");
+    }
+    const size_t commands = (num_doors + num_lifts) * per_device;
+    std::printf(
+        "doors=%zu lifts=%zu commands_per_device=%zu event_loops=%zu "
+        "idle_threads=%zu\n",
+        num_doors,
+        num_lifts,
+        per_device,
+        num_loops,
+        Threads());
+
+    // a thread per device, blocked during every PLC round trip and delay
+    {
+        Completion completion(commands);
+        std::vector<std::unique_ptr<TRLDeviceExecutor<TRLDoorCommand>>>
+            door_executors;
+        std::vector<std::unique_ptr<TRLDeviceExecutor<TRLLiftCommand>>>
+            lift_executors;
+        for (auto &door : doors) {
+            door_executors.push_back(
+                std::make_unique<TRLDeviceExecutor<TRLDoorCommand>>(
+                    door->GetDoorName(),
+                    per_device,
+                    [door, &completion](TRLDoorCommand &command) {
+                        completion.Done(door->ActuateDoor(command.open));
+                    }));
+        }
+        for (auto &lift : lifts) {
+            lift_executors.push_back(
+                std::make_unique<TRLDeviceExecutor<TRLLiftCommand>>(
+                    lift->GetName(),
+                    per_device,
+                    [lift, &completion](TRLLiftCommand &command) {
+                        completion.Done(
+                            lift->CommandLift(command.destination_floor));
+                    }));
+        }
+        const size_t threads = Threads();
+        const long switches = ContextSwitches();
+        const auto start = Clock::now();
+        for (size_t c = 0; c < per_device; ++c) {
+            for (auto &executor : door_executors) {
+                executor->Post(TRLDoorCommand{c % 2 == 0, start});
+            }
+            for (auto &executor : lift_executors) {
+                executor->Post(TRLLiftCommand{1, c % 2 ? "1" : "6", "", start});
+            }
+        }
+        completion.Wait();
+        Report(
+            "blocking executors",
+            commands,
+            completion.Failed(),
+            threads,
+            ContextSwitches() - switches,
+            Clock::now() - start);
+    }
+
+    // workflows of all devices on a few event loop threads
+    {
+        Completion completion(commands);
+        std::vector<std::unique_ptr<TRLWorkflowExecutor<TRLDoorCommand>>>
+            door_workflows;
+        std::vector<std::unique_ptr<TRLWorkflowExecutor<TRLLiftCommand>>>
+            lift_workflows;
+        std::vector<std::unique_ptr<TRLEventLoop>> loops;
+        for (size_t i = 0; i < num_loops; ++i) {
+            loops.push_back(std::make_unique<TRLEventLoop>(
+                "loop_" + std::to_string(i)));
+        }
+        for (size_t i = 0; i < doors.size(); ++i) {
+            TRLEventLoop *loop = loops[i % num_loops].get();
+            TRLDoorAsyncIO io;
+            io.wait_readable = [loop](
+                                   int fd,
+                                   std::chrono::milliseconds timeout,
+                                   std::function<void(bool)> handler) {
+                loop->WhenReadable(fd, timeout, std::move(handler));
+            };
+            io.after = [loop](
+                           std::chrono::milliseconds delay,
+                           std::function<void()> task) {
+                loop->After(delay, std::move(task));
+            };
+            auto door = doors[i];
+            door_workflows.push_back(
+                std::make_unique<TRLWorkflowExecutor<TRLDoorCommand>>(
+                    door->GetDoorName(),
+                    per_device,
+                    *loop,
+                    [door, io, &completion](
+                        TRLDoorCommand &command,
+                        TRLWorkflowExecutor<TRLDoorCommand>::Done done) {
+                        door->ActuateDoorAsync(
+                            command.open,
+                            io,
+                            [&completion, done](bool success) {
+                                completion.Done(success);
+                                done();
+                            });
+                    }));
+        }
+        for (size_t i = 0; i < lifts.size(); ++i) {
+            auto lift = lifts[i];
+            lift_workflows.push_back(
+                std::make_unique<TRLWorkflowExecutor<TRLLiftCommand>>(
+                    lift->GetName(),
+                    per_device,
+                    *loops[i % num_loops],
+                    [lift, &completion](
+                        TRLLiftCommand &command,
+                        TRLWorkflowExecutor<TRLLiftCommand>::Done done) {
+                        lift->CommandLiftAsync(
+                            command.destination_floor,
+                            [&completion, done](bool success, LiftCommandStats) {
+                                completion.Done(success);
+                                done();
+                            });
+                    }));
+        }
+        const size_t threads = Threads();
+        const long switches = ContextSwitches();
+        const auto start = Clock::now();
+        for (size_t c = 0; c < per_device; ++c) {
+            for (auto &workflow : door_workflows) {
+                workflow->Post(TRLDoorCommand{c % 2 == 0, start});
+            }
+            for (auto &workflow : lift_workflows) {
+                workflow->Post(TRLLiftCommand{1, c % 2 ? "1" : "6", "", start});
+            }
+        }
+        completion.Wait();
+        Report(
+            "event loop workflows",
+            commands,
+            completion.Failed(),
+            threads,
+            ContextSwitches() - switches,
+            Clock::now() - start);
+        // the loops finish before the workflow executors go away
+        loops.clear();
+    }
+
+    close(stop_pipe[1]);
+    waitpid(simulators, nullptr, 0);
+    return 0;
+}
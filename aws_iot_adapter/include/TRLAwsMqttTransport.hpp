@@ -0,0 +1,101 @@
+#ifndef TRL_AWS_MQTT_TRANSPORT_HPP
+#define TRL_AWS_MQTT_TRANSPORT_HPP
+
+// AWS IOT Core Includes
+#include <aws/crt/Api.h>
+#include <aws/crt/StlAllocator.h>
+#include <aws/crt/Types.h>
+#include <aws/crt/UUID.h>
+#include <aws/crt/auth/Credentials.h>
+#include <aws/crt/io/TlsOptions.h>
+#include <aws/iot/MqttClient.h>
+
+// MQTT transport interface
+#include "TRLMqttTransport.hpp"
+
+// Standard includes
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Logging
+#include <boost/log/trivial.hpp>
+
+// Yaml
+#include <yaml-cpp/yaml.h>
+
+class TRLAwsMqttTransport : public TRLMqttTransport {
+public:
+    /**
+     * @brief TRLAwsMqttTransport simple constructor
+     */
+    TRLAwsMqttTransport();
+
+    /**
+     * @brief Disconnects if still connected
+     */
+    ~TRLAwsMqttTransport() override;
+
+    /**
+     * @brief Creates the MQTT client and connection
+     * @param config the aws iot config, needs ca_file_path, cert_path,
+     * key_path, client_id and aws_url
+     * @return 1 if the initialization is successful
+     * @return 0 otherwise
+     */
+    bool Initialize(const YAML::Node &config);
+
+    bool Connect(const Callbacks &callbacks) override;
+
+    void Disconnect() override;
+
+    bool Subscribe(
+        const std::vector<std::pair<std::string, MessageHandler>>
+            &subscriptions) override;
+
+    bool Publish(
+        const std::string &topic,
+        const std::string &payload,
+        PublishHandler on_complete) override;
+
+private:
+    /**
+     * @brief Builds a MQTT Connection to AWS IOT Core
+     * @param client The MQTT Client
+     * @param cert_path absolute path to certificate
+     * @param key_path absolute path to key
+     * @param aws_url the url for the aws iot core instance
+     * @param ca_file_path absolute path to the ca_file
+     */
+    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> BuildDirectMQTTConnection(
+        Aws::Iot::MqttClient &client,
+        std::string &cert_path,
+        std::string &key_path,
+        std::string &aws_url,
+        std::string &ca_file_path);
+
+    /**
+     * @brief Returns a client connection from a given mqtt client and config
+     * @param client The MQTT Client
+     * @param client_config_builder config builder with all necessarary info
+     * neededed to return the client connection
+     */
+    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>
+    GetClientConnectionForMQTTConnection(
+        Aws::Iot::MqttClient &client,
+        Aws::Iot::MqttClientConnectionConfigBuilder &client_config_builder);
+
+private:
+    Aws::Crt::ApiHandle m_api_handle;        // mqtt api handle
+    Aws::Iot::MqttClient m_internal_client;  // mqtt client
+    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+    std::promise<void> m_closed_promise;  // a promise to wait for the complete
+                                          // mqtt disconnection
+    std::string m_client_id = "";         // mqtt client id
+    std::vector<std::string>
+        m_topics;  // subscribed topics, kept alive for the connection
+    bool m_connecting = false;  // Connect() succeeded, Disconnect() pending
+};
+
+#endif  // TRL_AWS_MQTT_TRANSPORT_HPP
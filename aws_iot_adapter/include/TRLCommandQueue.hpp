@@ -0,0 +1,130 @@
+#ifndef TRL_COMMAND_QUEUE_HPP
+#define TRL_COMMAND_QUEUE_HPP
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Bounded lock-free multi-producer/multi-consumer queue.
+ *
+ * Every cell carries a sequence number telling producers and consumers whose
+ * turn it is, so Push() and Pop() only need one compare-and-swap on their
+ * position counter and never block.
+ */
+template <typename T>
+class TRLCommandQueue {
+public:
+    /**
+     * @brief TRLCommandQueue constructor
+     * @param capacity maximum number of queued elements, rounded up to the
+     * next power of two
+     */
+    explicit TRLCommandQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    TRLCommandQueue(const TRLCommandQueue &) = delete;
+    TRLCommandQueue &operator=(const TRLCommandQueue &) = delete;
+
+    /**
+     * @brief Appends an element
+     * @param value the element to move into the queue
+     * @return false if the queue is full
+     */
+    bool Push(T &&value)
+    {
+        Cell *cell;
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            const size_t sequence =
+                cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(
+                        pos,
+                        pos + 1,
+                        std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element
+     * @param value receives the element
+     * @return false if the queue is empty
+     */
+    bool Pop(T &value)
+    {
+        Cell *cell;
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            const size_t sequence =
+                cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeue_pos.compare_exchange_weak(
+                        pos,
+                        pos + 1,
+                        std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Returns true if no element is queued. Only a hint while other
+     * threads push or pop concurrently.
+     */
+    bool Empty() const
+    {
+        const size_t pos = m_dequeue_pos.load(std::memory_order_acquire);
+        return m_cells[pos & m_mask].sequence.load(
+                   std::memory_order_acquire) != pos + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;  // ring of cells
+    size_t m_mask = 0;                // number of cells - 1
+    alignas(64) std::atomic<size_t> m_enqueue_pos{0};  // next cell to fill
+    alignas(64) std::atomic<size_t> m_dequeue_pos{0};  // next cell to drain
+};
+
+#endif  // TRL_COMMAND_QUEUE_HPP
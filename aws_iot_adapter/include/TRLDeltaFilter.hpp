@@ -0,0 +1,116 @@
+#ifndef TRL_DELTA_FILTER_HPP
+#define TRL_DELTA_FILTER_HPP
+
+// Device state snapshot
+#include "TRLDeviceState.hpp"
+
+// Standard includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Number of state messages sent and suppressed for one device
+ */
+struct TRLPublishCounters {
+    uint64_t sent = 0;        // messages handed to the MQTT connection
+    uint64_t suppressed = 0;  // unchanged states that were not published
+};
+
+class TRLDeltaFilter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief TRLDeltaFilter constructor
+     * @param enabled when false every state is published, only the counters
+     * are maintained
+     * @param keyframe_interval maximum time between two full publications of
+     * an unchanged device
+     */
+    TRLDeltaFilter(bool enabled, std::chrono::seconds keyframe_interval);
+
+    /**
+     * @brief Decides whether a door state has to be published. A state is
+     * published when it is the first one of the device, when any field apart
+     * from the sample time changed, or when a keyframe is due. A positive
+     * decision records the state as the last published one.
+     * @param state the freshly sampled door state
+     * @param now the current time
+     * @return true if the state should be published
+     */
+    bool ShouldPublish(const TRLDoorState &state, Clock::time_point now);
+
+    /**
+     * @brief Same as above for a lift state
+     */
+    bool ShouldPublish(const TRLLiftState &state, Clock::time_point now);
+
+    /**
+     * @brief Forgets the last published state of a door, its next state is
+     * published whatever it is. Called when the state recorded by
+     * ShouldPublish() could not be sent.
+     * @param door_name the name of the door
+     */
+    void ForgetDoor(const std::string &door_name);
+
+    /**
+     * @brief Same as above for a lift
+     */
+    void ForgetLift(const std::string &lift_name);
+
+    /**
+     * @brief Forces the next state of every device to be published, e.g.
+     * after the MQTT connection was (re)established. Safe to call from any
+     * thread.
+     */
+    void ForceKeyframe();
+
+    /**
+     * @brief Returns a copy of the per door counters
+     */
+    std::map<std::string, TRLPublishCounters> DoorCounters() const;
+
+    /**
+     * @brief Returns a copy of the per lift counters
+     */
+    std::map<std::string, TRLPublishCounters> LiftCounters() const;
+
+private:
+    template <typename State>
+    struct Entry {
+        bool valid = false;                 // a state was published already
+        State last;                         // last published state
+        Clock::time_point last_keyframe;    // last time the state was sent
+        uint64_t generation = 0;            // keyframe generation seen
+        TRLPublishCounters counters;
+    };
+
+    template <typename State>
+    bool Decide(
+        Entry<State> &entry,
+        const State &state,
+        Clock::time_point now);
+
+    template <typename State>
+    static void Forget(Entry<State> &entry);
+
+    static bool SameState(const TRLDoorState &a, const TRLDoorState &b);
+    static bool SameState(const TRLLiftState &a, const TRLLiftState &b);
+
+private:
+    const bool m_enabled;                        // delta publishing enabled
+    const Clock::duration m_keyframe_interval;   // full publication period
+    std::atomic<uint64_t> m_generation{0};       // bumped on ForceKeyframe
+    mutable std::mutex m_mutex;                  // protects the entries
+    std::unordered_map<std::string, Entry<TRLDoorState>>
+        m_doors;  // last published state per door
+    std::unordered_map<std::string, Entry<TRLLiftState>>
+        m_lifts;  // last published state per lift
+};
+
+#endif  // TRL_DELTA_FILTER_HPP
@@ -0,0 +1,146 @@
+#ifndef TRL_DEVICE_EXECUTOR_HPP
+#define TRL_DEVICE_EXECUTOR_HPP
+
+// Lock-free command queue
+#include "TRLCommandQueue.hpp"
+
+// Standard includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Logging
+#include <boost/log/trivial.hpp>
+
+/**
+ * @brief Lift command received over MQTT
+ */
+struct TRLLiftCommand {
+    int request_type = 0;               // 0/2 = end lift, 1 = command lift
+    std::string destination_floor = ""; // floor to send the cabin to
+    std::string session_id = "";        // session requesting the lift
+    std::chrono::steady_clock::time_point received;  // receipt over MQTT
+};
+
+/**
+ * @brief Door command received over MQTT
+ */
+struct TRLDoorCommand {
+    bool open = false;  // true opens the door, false closes it
+    std::chrono::steady_clock::time_point received;  // receipt over MQTT
+};
+
+/**
+ * @brief Runs the commands of a single device on a dedicated thread.
+ *
+ * Post() only pushes onto a lock-free queue, so the MQTT event-loop thread
+ * never waits for a PLC or for state polling. Commands of one device are
+ * executed one after another in arrival order.
+ */
+template <typename Command>
+class TRLDeviceExecutor {
+public:
+    using Handler = std::function<void(Command &)>;
+
+    /**
+     * @brief Starts the executor thread
+     * @param name name of the device, used for logging
+     * @param queue_size maximum number of pending commands
+     * @param handler executes one command on the device
+     */
+    TRLDeviceExecutor(
+        const std::string &name,
+        size_t queue_size,
+        Handler handler)
+        : m_name(name),
+          m_queue(queue_size),
+          m_handler(std::move(handler)),
+          m_thread(&TRLDeviceExecutor::Run, this)
+    {
+    }
+
+    /**
+     * @brief Stops the executor once the pending commands are executed
+     */
+    ~TRLDeviceExecutor()
+    {
+        m_stop = true;
+        Wake();
+        m_thread.join();
+    }
+
+    TRLDeviceExecutor(const TRLDeviceExecutor &) = delete;
+    TRLDeviceExecutor &operator=(const TRLDeviceExecutor &) = delete;
+
+    /**
+     * @brief Queues a command without blocking
+     * @param command the command to execute
+     * @return false if the queue is full and the command was dropped
+     */
+    bool Post(Command command)
+    {
+        if (!m_queue.Push(std::move(command))) {
+            BOOST_LOG_TRIVIAL(error)
+                << m_name
+                << "| TRLDeviceExecutor::Post command queue full, dropping "
+                   "command.";
+            return false;
+        }
+        Wake();
+        return true;
+    }
+
+private:
+    /**
+     * @brief Wakes the executor thread. The mutex is only held to order the
+     * notification against the sleeping thread's predicate check.
+     */
+    void Wake()
+    {
+        {
+            std::scoped_lock lock(m_wake_mutex);
+        }
+        m_wake_cv.notify_one();
+    }
+
+    /**
+     * @brief Executor thread body
+     */
+    void Run()
+    {
+        Command command;
+        for (;;) {
+            while (m_queue.Pop(command)) {
+                try {
+                    m_handler(command);
+                } catch (const std::exception &e) {
+                    BOOST_LOG_TRIVIAL(error)
+                        << m_name << "| TRLDeviceExecutor::Run command failed. "
+                        << e.what();
+                }
+            }
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            if (m_stop && m_queue.Empty()) {
+                return;
+            }
+            m_wake_cv.wait(
+                lock,
+                [&]() { return m_stop || !m_queue.Empty(); });
+        }
+    }
+
+private:
+    const std::string m_name;           // device name
+    TRLCommandQueue<Command> m_queue;   // pending commands
+    Handler m_handler;                  // executes a command on the device
+    std::atomic<bool> m_stop{false};    // set when the executor shuts down
+    std::mutex m_wake_mutex;            // only used to sleep on m_wake_cv
+    std::condition_variable m_wake_cv;  // signals new commands or stop
+    std::thread m_thread;               // executor thread, started last
+};
+
+#endif  // TRL_DEVICE_EXECUTOR_HPP
@@ -0,0 +1,42 @@
+#ifndef TRL_DEVICE_STATE_HPP
+#define TRL_DEVICE_STATE_HPP
+
+// Standard includes
+#include <string>
+#include <vector>
+
+/**
+ * @brief State of a single door sampled during a poll cycle
+ */
+struct TRLDoorState {
+    int door_time = 0;           // sample time in seconds since epoch
+    std::string door_name = "";  // name of the door
+    int current_mode = 0;        // door mode, see TRLDoorInterface.hpp
+};
+
+/**
+ * @brief State of a single lift sampled during a poll cycle
+ */
+struct TRLLiftState {
+    int lift_time = 0;                           // sample time in seconds
+    std::string lift_name = "";                  // name of the lift
+    std::vector<std::string> available_floors;   // floors served by the lift
+    std::string current_floor = "0";             // "0" if unknown
+    std::string destination_floor = "0";         // "0" if unknown
+    int door_state = 0;                          // lift door state
+    int motion_state = 0;                        // lift motion state
+    std::vector<int> available_modes;            // modes supported by the lift
+    int lift_mode = 0;                           // current lift mode
+    std::string session_id = "";                 // session owning the lift
+};
+
+/**
+ * @brief A consistent snapshot of every door and lift handled by the adapter.
+ * Entries keep the order of the adapter's device vectors.
+ */
+struct TRLFleetState {
+    std::vector<TRLDoorState> doors;
+    std::vector<TRLLiftState> lifts;
+};
+
+#endif  // TRL_DEVICE_STATE_HPP
@@ -0,0 +1,157 @@
+#ifndef TRL_EVENT_LOOP_HPP
+#define TRL_EVENT_LOOP_HPP
+
+// Timer wheel
+#include "TRLTimerWheel.hpp"
+
+// Standard includes
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Logging
+#include <boost/log/trivial.hpp>
+
+// duration of one timer tick of the event loop
+#define EVENT_LOOP_RESOLUTION_MS 1
+
+/**
+ * @brief Single threaded event loop for device workflows.
+ *
+ * A workflow is a chain of steps, each step starts an I/O or a delay and
+ * hands the next step to the loop instead of blocking: After() for delays,
+ * WhenReadable() for sockets and PostExpected() for completions arriving on
+ * other threads, e.g. asynchronous ADS requests. Any number of workflows
+ * share the loop thread, which sleeps in poll() while all of them wait.
+ */
+class TRLEventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Called once a socket is readable, with false on timeout
+     */
+    using ReadyHandler = std::function<void(bool)>;
+
+    /**
+     * @brief Starts the loop thread
+     * @param name name of the loop, used for logging
+     */
+    explicit TRLEventLoop(const std::string &name);
+
+    /**
+     * @brief Stops the loop once no task, timer, socket or expected post is
+     * pending any more
+     */
+    ~TRLEventLoop();
+
+    TRLEventLoop(const TRLEventLoop &) = delete;
+    TRLEventLoop &operator=(const TRLEventLoop &) = delete;
+
+    /**
+     * @brief Queues a task on the loop, from any thread
+     * @param task the task to run on the loop thread
+     */
+    void Post(Task task);
+
+    /**
+     * @brief Announces a PostExpected() from another thread, the loop does
+     * not stop before it arrived
+     */
+    void ExpectPost();
+
+    /**
+     * @brief Queues the task announced by ExpectPost(), from any thread
+     * @param task the task to run on the loop thread
+     */
+    void PostExpected(Task task);
+
+    /**
+     * @brief Runs a task after a delay, on the loop thread only
+     * @param delay time until the task runs, rounded up to the next tick
+     * @param task the task to run
+     */
+    void After(Clock::duration delay, Task task);
+
+    /**
+     * @brief Waits for a socket to become readable, on the loop thread only
+     * @param fd the socket, it must stay open until the handler is called
+     * @param timeout time until the handler is called with false
+     * @param handler called once on the loop thread
+     */
+    void WhenReadable(int fd, Clock::duration timeout, ReadyHandler handler);
+
+    /**
+     * @brief Returns true on the loop thread
+     */
+    bool InLoop() const;
+
+private:
+    struct Watch {
+        int fd;                       // socket waited for
+        Clock::time_point deadline;   // timeout of the wait
+        ReadyHandler handler;         // called once
+    };
+
+    /**
+     * @brief Loop thread body
+     */
+    void Run();
+
+    /**
+     * @brief Runs a task, exceptions are logged
+     */
+    void RunTask(Task &task);
+
+    /**
+     * @brief Runs the due timers
+     */
+    void RunTimers();
+
+    /**
+     * @brief Sleeps in poll() until a socket is readable, a task is posted
+     * or the next timer or watch deadline, then runs the ready watches
+     */
+    void Poll();
+
+    /**
+     * @brief Wakes the loop thread out of poll()
+     */
+    void Wake();
+
+    /**
+     * @brief Returns true if nothing is pending any more
+     */
+    bool Idle();
+
+private:
+    const std::string m_name;               // loop name
+    const Clock::time_point m_start;        // time of tick 0
+    TRLTimerWheel m_wheel;                  // pending timers, by id
+    std::vector<Task> m_timers;             // timer tasks, by id
+    std::vector<size_t> m_free_timers;      // unused ids of m_timers
+    size_t m_pending_timers = 0;            // timers in the wheel
+    std::vector<size_t> m_expired;          // reused list of due timers
+    std::vector<Watch> m_watches;           // sockets waited for
+    std::vector<pollfd> m_pollfds;          // reused poll() set, wake pipe first
+    std::vector<std::pair<ReadyHandler, bool>>
+        m_ready;                            // reused list of ready handlers
+    std::mutex m_mutex;                     // protects m_posted
+    std::vector<Task> m_posted;             // tasks posted from any thread
+    std::vector<Task> m_running;            // posted tasks being run
+    std::atomic<size_t> m_expected{0};      // announced PostExpected() calls
+    int m_wake_fds[2] = {-1, -1};           // pipe waking poll()
+    std::atomic<bool> m_stop{false};        // set when the loop shuts down
+    std::thread m_thread;                   // loop thread, started last
+};
+
+#endif  // TRL_EVENT_LOOP_HPP
@@ -1,27 +1,43 @@
 #ifndef TRL_IOT_CORE_ADAPTER_HPP
     #define HEA_DER__H_T_RLIotCoreAdapter
 
-    // AWS IOT Core Includes
-    #include <aws/crt/Api.h>
-    #include <aws/crt/StlAllocator.h>
-    #include <aws/crt/Types.h>
-    #include <aws/crt/UUID.h>
-    #include <aws/crt/auth/Credentials.h>
-    #include <aws/crt/io/TlsOptions.h>
-    #include <aws/iot/MqttClient.h>
+    // MQTT connection
+    #include "TRLMqttTransport.hpp"
 
     // TRL Lift Interface
     #include "TRLLiftInterface.hpp"
     // TRL Door Interface
     #include "TRLDoorInterface.hpp"
+    // Concurrent device state poller
+    #include "TRLStatePoller.hpp"
+    // Change-only publishing
+    #include "TRLDeltaFilter.hpp"
+    // State serialization
+    #include "TRLStateSerializer.hpp"
+    // Per device command execution
+    #include "TRLDeviceExecutor.hpp"
+    // Command workflows sharing event loops
+    #include "TRLWorkflowExecutor.hpp"
+    // Periodic polling and publishing
+    #include "TRLScheduler.hpp"
+    // Store-and-forward while the MQTT connection is down
+    #include "TRLStateJournal.hpp"
+    // Per device latency histograms
+    #include "TRLLatencyMetrics.hpp"
     // Json helper lib
     #include <nlohmann/json.hpp>
 
     // Standard includes
     #include <algorithm>
+    #include <atomic>
     #include <chrono>
+    #include <fstream>
+    #include <functional>
+    #include <map>
+    #include <memory>
     #include <mutex>
     #include <thread>
+    #include <unordered_map>
 
     // Logging
     #include <boost/date_time.hpp>
@@ -32,6 +48,32 @@
     #include <boost/log/utility/setup/console.hpp>
     #include <boost/log/utility/setup/file.hpp>
 
+    // upper bound of device polling threads when poll_workers is not set
+    #define DEFAULT_POLL_WORKERS 16
+    // seconds between two full publications of an unchanged device
+    #define DEFAULT_KEYFRAME_INTERVAL 30
+    // AWS IoT Core rejects messages larger than 128 KB
+    #define DEFAULT_MAX_PAYLOAD_SIZE 131072
+    // maximum number of pending commands per device
+    #define DEFAULT_COMMAND_QUEUE_SIZE 32
+    // event loops running the commands, 0 runs one thread per device
+    #define DEFAULT_COMMAND_LOOPS 0
+    // per device poll and publish period when the device config sets none
+    #define DEFAULT_POLL_PERIOD_MS 1000
+    #define DEFAULT_PUBLISH_PERIOD_MS 1000
+    // duration of one scheduler timer wheel tick
+    #define DEFAULT_SCHEDULER_RESOLUTION_MS 10
+    // seconds between two logs of the schedule statistics
+    #define DEFAULT_SCHEDULE_STATS_INTERVAL 60
+    // size of the state journal ring in bytes
+    #define DEFAULT_JOURNAL_SIZE 4194304
+    // journaled messages replayed per second after a reconnection
+    #define DEFAULT_JOURNAL_REPLAY_RATE 50
+    // period of the journal replay schedule
+    #define JOURNAL_REPLAY_PERIOD_MS 100
+    // seconds between two latency metrics reports
+    #define DEFAULT_METRICS_INTERVAL 60
+
 class TRLIotCoreAdapter {
 public:
     /**
@@ -57,67 +99,164 @@ public:
         const std::string &lift_config_file_path,
         const std::string &doors_config_file_path);
 
+    /**
+     * @brief Initializes the adapter on a given MQTT transport instead of AWS
+     * IOT Core, e.g. a local broker. The aws iot config only needs the topics.
+     * @param aws_iot_config_file_path path to the aws iot config file needed
+     * @param lift_config_file_path path to the lift config file needed
+     * @param doors_config_file_path path to the doors config file needed
+     * @param transport the MQTT transport to connect with
+     * @return 1 if the initialization is successful
+     * @return 0 otherwise
+     */
+    bool Initialize(
+        const std::string &aws_iot_config_file_path,
+        const std::string &lift_config_file_path,
+        const std::string &doors_config_file_path,
+        std::shared_ptr<TRLMqttTransport> transport);
+
     /**
      * @brief This function publishes a MQTT message consisting of the lift and
      * door status
      */
     void PublishState();
 
+    /**
+     * @brief Polls and publishes every device at its configured period on the
+     * calling thread. States are only published while the MQTT connection is
+     * established.
+     * @param keep_running Run() returns once it returns false
+     */
+    void Run(const std::function<bool()> &keep_running);
+
+    /**
+     * @brief Returns the jitter and overrun statistics of every poll and
+     * publish schedule
+     */
+    std::vector<TRLScheduleStats> ScheduleStats() const;
+
     /**
      * @brief Checks if the MQTT connection is completed
      */
     const bool &ConnectionCompleted() const;
 
-private:
     /**
-     * @brief Builds a MQTT Connection to AWS IOT Core
-     * @param client The MQTT Client
-     * @param cert_path absolute path to certificate
-     * @param key_path absolute path to key
-     * @param aws_url the url for the aws iot core instance
-     * @param ca_file_path absolute path to the ca_file
+     * @brief Returns the number of sent and suppressed state messages per door
      */
-    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> BuildDirectMQTTConnection(
-        Aws::Iot::MqttClient &client,
-        std::string &cert_path,
-        std::string &key_path,
-        std::string &aws_url,
-        std::string &ca_file_path);
+    std::map<std::string, TRLPublishCounters> DoorPublishCounters() const;
 
     /**
-     * @brief Returns a client connection from a given mqtt client and config
-     * @param client The MQTT Client
-     * @param client_config_builder config builder with all necessarary info
-     * neededed to return the client connection
+     * @brief Returns the number of sent and suppressed state messages per lift
      */
-    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>
-    GetClientConnectionForMQTTConnection(
-        Aws::Iot::MqttClient &client,
-        Aws::Iot::MqttClientConnectionConfigBuilder &client_config_builder);
+    std::map<std::string, TRLPublishCounters> LiftPublishCounters() const;
 
+private:
     /**
      * @brief This function is called whenever a message is heard from the lift
      * command MQTT topic
      */
     void LiftCommandReceiveCallback(
-        Aws::Crt::Mqtt::MqttConnection &,
-        const Aws::Crt::String &topic,
-        const Aws::Crt::ByteBuf &byte_buf,
-        bool /*dup*/,
-        Aws::Crt::Mqtt::QOS /*qos*/,
-        bool /*retain*/);
+        const std::string &topic,
+        const std::string &payload);
 
     /**
      * @brief This function is called whenever a message is heard from door
      * command the MQTT topic
      */
     void DoorCommandReceiveCallback(
-        Aws::Crt::Mqtt::MqttConnection &,
-        const Aws::Crt::String &topic,
-        const Aws::Crt::ByteBuf &byte_buf,
-        bool /*dup*/,
-        Aws::Crt::Mqtt::QOS /*qos*/,
-        bool /*retain*/);
+        const std::string &topic,
+        const std::string &payload);
+
+    /**
+     * @brief Expands a per device topic pattern
+     * @param pattern topic containing one or more "{name}" placeholders
+     * @param name the device name to insert
+     * @return the topic of the device
+     */
+    static std::string DeviceTopic(
+        const std::string &pattern,
+        const std::string &name);
+
+    /**
+     * @brief Creates one command executor per lift and per door, either
+     * with its own thread or running asynchronous workflows on one of the
+     * command loops
+     * @param queue_size maximum number of pending commands per device
+     * @param command_loops number of event loops shared by the devices, 0
+     * gives every device its own thread
+     */
+    void CreateExecutors(size_t queue_size, size_t command_loops);
+
+    /**
+     * @brief Records the latency of a finished lift command or logs its
+     * failure
+     */
+    static void LiftCommandDone(
+        const TRLLiftInterface &lift,
+        TRLLiftLatencies *latencies,
+        const TRLLiftCommand &command,
+        bool success,
+        const LiftCommandStats &stats);
+
+    /**
+     * @brief Same as above for a door command
+     */
+    static void DoorCommandDone(
+        const TRLDoorInterface &door,
+        TRLLatencyHistogram *latency,
+        const TRLDoorCommand &command,
+        bool success);
+
+    /**
+     * @brief Creates one poll schedule per device and one publish schedule
+     * per distinct publish period, reading the optional poll_period_ms and
+     * publish_period_ms of every device
+     * @param door_config the doors config
+     * @param lift_config the lifts config
+     * @param resolution duration of one scheduler tick
+     * @param stats_interval period of the statistics log
+     */
+    void CreateSchedules(
+        const YAML::Node &door_config,
+        const YAML::Node &lift_config,
+        std::chrono::milliseconds resolution,
+        std::chrono::seconds stats_interval);
+
+    /**
+     * @brief Starts sampling a door on the polling workers unless the
+     * previous sample is still running
+     * @param index the door index in m_doors
+     * @return false if the previous sample is still running
+     */
+    bool PollDoor(size_t index);
+
+    /**
+     * @brief Same as above for a lift
+     */
+    bool PollLift(size_t index);
+
+    /**
+     * @brief Summarizes the latency histograms and writes them to the
+     * metrics topic and the metrics file
+     */
+    void EmitMetrics();
+
+    /**
+     * @brief Publishes the next journaled messages while the MQTT connection
+     * is up, at most m_journal_replay_budget per call
+     */
+    void ReplayJournal();
+
+    /**
+     * @brief Publishes the latest sampled state of the given devices. The
+     * states are journaled instead while the MQTT connection is down or older
+     * journaled states still wait for replay.
+     * @param doors indices in m_doors
+     * @param lifts indices in m_lifts
+     */
+    void PublishDevices(
+        const std::vector<size_t> &doors,
+        const std::vector<size_t> &lifts);
 
     /**
      * @brief Encompassing function to create subscribers for lift and door
@@ -125,14 +264,48 @@ private:
      */
     void CreateSubscribers();
 
+    /**
+     * @brief Publishes the serialized device states of one cycle. In batch
+     * mode the states are packed into JSON arrays, split into chunks of at
+     * most m_max_payload_size bytes, otherwise every state is sent on its own
+     * @param topic the mqtt topic to publish on
+     * @param buffers serialized device states, one per device
+     * @param pending indices of the buffers to publish
+     * @param latencies records the PUBACK latencies, may be null
+     * @param failed receives the indices of the buffers that could not be
+     * queued
+     */
+    void PublishMessages(
+        const std::string &topic,
+        const std::vector<std::string> &buffers,
+        const std::vector<size_t> &pending,
+        TRLPublishLatencies *latencies,
+        std::vector<size_t> &failed);
+
+    /**
+     * @brief Publishes a single message with QoS 1
+     * @param topic the mqtt topic to publish on
+     * @param message the payload
+     * @param latency records the time until the PUBACK, may be null
+     * @return false if the message could not be queued
+     */
+    bool Publish(
+        const std::string &topic,
+        const std::string &message,
+        TRLLatencyHistogram *latency = nullptr);
+
 private:
-    Aws::Crt::ApiHandle m_api_handle;        // mqtt api handle
-    Aws::Iot::MqttClient m_internal_client;  // mqtt client
-    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
-    std::promise<void> m_closed_promise;  // a promise to wait for the complete
-                                          // mqtt disconnection
-    std::mutex m_mutex;  // mutex to ensure thread safety for simultaneous
-                         // subscribing and publishing
+    /**
+     * @brief Devices sharing a publish period
+     */
+    struct PublishGroup {
+        std::vector<size_t> doors;  // indices in m_doors
+        std::vector<size_t> lifts;  // indices in m_lifts
+    };
+
+    std::shared_ptr<TRLMqttTransport>
+        m_transport;  // mqtt connection, AWS IOT Core by default
+    std::mutex m_mutex;  // serializes publish cycles
     std::string m_lift_command_topic =
         "";  // the mqtt topic for receiving lift commands
     std::string m_lift_state_topic =
@@ -145,6 +318,63 @@ private:
         m_doors;  // vector of door instances
     std::vector<std::shared_ptr<TRLLiftInterface>>
         m_lifts;  // vector of lift instances
+    std::unordered_map<std::string, size_t>
+        m_door_index;  // door name to index in m_doors
+    std::unordered_map<std::string, size_t>
+        m_lift_index;  // lift name to index in m_lifts
+    std::unordered_map<std::string, size_t>
+        m_door_topic_index;  // per door command topic to index in m_doors
+    std::unordered_map<std::string, size_t>
+        m_lift_topic_index;  // per lift command topic to index in m_lifts
+    std::unique_ptr<TRLStatePoller>
+        m_poller;  // samples all doors and lifts concurrently
+    std::unique_ptr<TRLDeltaFilter>
+        m_delta_filter;  // suppresses unchanged states between keyframes
+    bool m_batch_publish = false;  // pack all states of a cycle into arrays
+    size_t m_max_payload_size =
+        DEFAULT_MAX_PAYLOAD_SIZE;  // max bytes of a batched message
+    std::vector<std::string>
+        m_door_buffers;  // reusable serialized state, one per door
+    std::vector<std::string>
+        m_lift_buffers;  // reusable serialized state, one per lift
+    std::vector<size_t> m_door_pending;  // doors to publish this cycle
+    std::vector<size_t> m_lift_pending;  // lifts to publish this cycle
+    std::vector<size_t> m_failed;        // pending states not queued
+    std::string m_batch_buffer;          // reusable batched payload
+    std::vector<std::unique_ptr<TRLDeviceExecutor<TRLLiftCommand>>>
+        m_lift_executors;  // command executor per lift, same order as m_lifts
+    std::vector<std::unique_ptr<TRLDeviceExecutor<TRLDoorCommand>>>
+        m_door_executors;  // command executor per door, same order as m_doors
+    std::vector<std::unique_ptr<TRLWorkflowExecutor<TRLLiftCommand>>>
+        m_lift_workflows;  // replace m_lift_executors with command loops
+    std::vector<std::unique_ptr<TRLWorkflowExecutor<TRLDoorCommand>>>
+        m_door_workflows;  // replace m_door_executors with command loops
+    std::vector<std::unique_ptr<TRLEventLoop>>
+        m_command_loops;  // run the workflows, destroyed before them
+    std::unique_ptr<TRLScheduler>
+        m_scheduler;  // runs the poll and publish schedules
+    std::vector<PublishGroup>
+        m_publish_groups;  // devices published together, one per period
+    std::vector<size_t> m_all_doors;  // every index of m_doors
+    std::vector<size_t> m_all_lifts;  // every index of m_lifts
+    std::mutex m_latest_mutex;        // protects m_latest
+    TRLFleetState m_latest;  // latest sampled state, same order as devices
+    std::unique_ptr<std::atomic<bool>[]>
+        m_door_polling;  // per door, a sample is running on the workers
+    std::unique_ptr<std::atomic<bool>[]>
+        m_lift_polling;  // per lift, a sample is running on the workers
+
+    std::unique_ptr<TRLStateJournal>
+        m_journal;  // states kept while the connection is down, optional
+    size_t m_journal_replay_budget =
+        0;  // journaled messages replayed per replay schedule run
+    std::atomic<bool> m_online{false};  // the MQTT connection is up
+    std::unique_ptr<TRLLatencyMetrics>
+        m_metrics;  // latency histograms, only when reported somewhere
+    std::string m_metrics_topic = "";  // the mqtt topic of latency reports
+    std::ofstream m_metrics_file;      // local file of latency reports
+    int m_metrics_interval =
+        DEFAULT_METRICS_INTERVAL;  // seconds between two latency reports
 
     bool m_connected = false;
 };
@@ -0,0 +1,111 @@
+#ifndef TRL_LATENCY_HISTOGRAM_HPP
+#define TRL_LATENCY_HISTOGRAM_HPP
+
+// Standard includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// sub-buckets per power of two, bounds the relative error to 1/16
+#define HISTOGRAM_SUB_BUCKET_BITS 4
+// latencies above 2^HISTOGRAM_MAX_BITS us (~134 s) land in the last bucket
+#define HISTOGRAM_MAX_BITS 27
+
+/**
+ * @brief Summary of the latencies recorded during one interval, in
+ * microseconds
+ */
+struct TRLLatencySummary {
+    uint64_t count = 0;
+    uint64_t mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+/**
+ * @brief HDR-style latency histogram with log-linear buckets.
+ *
+ * Every power of two is split into 2^HISTOGRAM_SUB_BUCKET_BITS buckets.
+ * Record() only increments atomic counters of a fixed array, it neither
+ * locks nor allocates and can be called from any thread. TakeSummary()
+ * resets the counters, so every summary covers the interval since the
+ * previous one.
+ */
+class TRLLatencyHistogram {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Records one latency
+     * @param latency the measured duration
+     */
+    void Record(Clock::duration latency)
+    {
+        const auto us =
+            std::chrono::duration_cast<std::chrono::microseconds>(latency)
+                .count();
+        RecordValue(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+
+    /**
+     * @brief Records a value that is not a duration, such as a count
+     */
+    void RecordValue(uint64_t value)
+    {
+        m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max &&
+               !m_max.compare_exchange_weak(
+                   max,
+                   value,
+                   std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Records the time elapsed since start
+     */
+    void RecordSince(Clock::time_point start)
+    {
+        Record(Clock::now() - start);
+    }
+
+    /**
+     * @brief Returns the summary of the latencies recorded since the last
+     * call and resets the histogram. Values recorded concurrently are counted
+     * in this or in the next summary.
+     */
+    TRLLatencySummary TakeSummary();
+
+private:
+    static const size_t kSubBuckets = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+    static const size_t kBuckets =
+        (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) * kSubBuckets;
+
+    static size_t BucketIndex(uint64_t value)
+    {
+        if (value < kSubBuckets) {
+            return value;
+        }
+        const unsigned msb = 63 - __builtin_clzll(value);
+        const unsigned shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+        const size_t index =
+            (shift + 1) * kSubBuckets + (value >> shift) - kSubBuckets;
+        return index < kBuckets ? index : kBuckets - 1;
+    }
+
+    /**
+     * @brief Returns the largest value falling into a bucket
+     */
+    static uint64_t BucketValue(size_t index);
+
+    std::array<std::atomic<uint64_t>, kBuckets> m_buckets{};
+    std::atomic<uint64_t> m_sum{0};  // sum of the recorded values
+    std::atomic<uint64_t> m_max{0};  // largest recorded value
+};
+
+#endif  // TRL_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,109 @@
+#ifndef TRL_LATENCY_METRICS_HPP
+#define TRL_LATENCY_METRICS_HPP
+
+// Latency histogram
+#include "TRLLatencyHistogram.hpp"
+// Json helper lib
+#include <nlohmann/json.hpp>
+
+// Standard includes
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Latencies recorded for one door
+ */
+struct TRLDoorLatencies {
+    TRLLatencyHistogram door_state;  // Modbus read inside GetDoorState()
+    TRLLatencyHistogram publish;     // Publish() to PUBACK
+    TRLLatencyHistogram command;     // command receipt to PLC acknowledgement
+};
+
+/**
+ * @brief Latencies recorded for one lift
+ */
+struct TRLLiftLatencies {
+    TRLLatencyHistogram snapshot;  // ADS sum-up read inside Snapshot()
+    TRLLatencyHistogram publish;   // Publish() to PUBACK
+    TRLLatencyHistogram command;   // command receipt to PLC acknowledgement
+    TRLLatencyHistogram
+        command_exchange;  // ADS sum-up exchange inside the lift command
+    TRLLatencyHistogram
+        command_plc_cycles;  // PLC cycles spanned by that exchange, a count
+    TRLLatencyHistogram reconnect;  // PLC lost to variables recreated
+    TRLLatencyHistogram
+        reconnect_attempts;  // attempts that reconnection took, a count
+};
+
+/**
+ * @brief Publish latencies of the state messages on one topic
+ */
+struct TRLPublishLatencies {
+    std::vector<TRLLatencyHistogram *>
+        devices;                // per device histogram, same order as devices
+    TRLLatencyHistogram batch;  // batched messages holding several devices
+};
+
+/**
+ * @brief Per device latency histograms of the adapter.
+ *
+ * All histograms are created up front, recording into them never allocates.
+ */
+class TRLLatencyMetrics {
+public:
+    /**
+     * @brief Creates the histograms of every device
+     * @param door_names names of the doors, in the adapter's order
+     * @param lift_names names of the lifts, in the adapter's order
+     */
+    TRLLatencyMetrics(
+        const std::vector<std::string> &door_names,
+        const std::vector<std::string> &lift_names);
+
+    TRLLatencyMetrics(const TRLLatencyMetrics &) = delete;
+    TRLLatencyMetrics &operator=(const TRLLatencyMetrics &) = delete;
+
+    /**
+     * @brief Returns the histograms of a door
+     * @param index the door index in the adapter
+     */
+    TRLDoorLatencies &Door(size_t index);
+
+    /**
+     * @brief Returns the histograms of a lift
+     * @param index the lift index in the adapter
+     */
+    TRLLiftLatencies &Lift(size_t index);
+
+    /**
+     * @brief Returns the publish histograms of the door state messages
+     */
+    TRLPublishLatencies &DoorPublish();
+
+    /**
+     * @brief Returns the publish histograms of the lift state messages
+     */
+    TRLPublishLatencies &LiftPublish();
+
+    /**
+     * @brief Summarizes and resets every histogram, one JSON message per
+     * device with samples in the interval plus one per batched topic
+     * @param time report time in seconds since epoch
+     * @param messages receives the serialized messages
+     */
+    void Report(int time, std::vector<std::string> &messages);
+
+private:
+    static nlohmann::json ToJson(const TRLLatencySummary &summary);
+
+private:
+    std::vector<std::string> m_door_names;
+    std::vector<std::string> m_lift_names;
+    std::vector<std::unique_ptr<TRLDoorLatencies>> m_doors;
+    std::vector<std::unique_ptr<TRLLiftLatencies>> m_lifts;
+    TRLPublishLatencies m_door_publish;
+    TRLPublishLatencies m_lift_publish;
+};
+
+#endif  // TRL_LATENCY_METRICS_HPP
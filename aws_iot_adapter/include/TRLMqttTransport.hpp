@@ -0,0 +1,78 @@
+#ifndef TRL_MQTT_TRANSPORT_HPP
+#define TRL_MQTT_TRANSPORT_HPP
+
+// Standard includes
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief MQTT connection used by the adapter.
+ *
+ * TRLAwsMqttTransport talks to AWS IoT Core, other implementations allow the
+ * adapter to run against a local broker or an in-process stand-in.
+ */
+class TRLMqttTransport {
+public:
+    /**
+     * @brief Called for every message received on a subscribed topic
+     */
+    using MessageHandler = std::function<
+        void(const std::string &topic, const std::string &payload)>;
+
+    /**
+     * @brief Called once a published message is acknowledged, error_code is
+     * zero on success
+     */
+    using PublishHandler = std::function<void(int error_code)>;
+
+    /**
+     * @brief Connection events, every callback is optional and may be called
+     * from a transport thread
+     */
+    struct Callbacks {
+        std::function<void()> on_connected;        // connection established
+        std::function<void(int)> on_interrupted;   // connection lost
+        std::function<void()> on_resumed;          // connection re-established
+    };
+
+    virtual ~TRLMqttTransport() = default;
+
+    /**
+     * @brief Starts connecting, the result is reported through the callbacks
+     * @param callbacks the connection event callbacks
+     * @return false if the connection could not be started
+     */
+    virtual bool Connect(const Callbacks &callbacks) = 0;
+
+    /**
+     * @brief Disconnects and waits for the disconnection to complete
+     */
+    virtual void Disconnect() = 0;
+
+    /**
+     * @brief Subscribes to several topics at once with QoS 1
+     * @param subscriptions topics and the handler of each topic
+     * @return false if the subscription could not be sent
+     */
+    virtual bool Subscribe(
+        const std::vector<std::pair<std::string, MessageHandler>>
+            &subscriptions) = 0;
+
+    /**
+     * @brief Publishes a message with QoS 1. The payload is copied before the
+     * call returns.
+     * @param topic the topic to publish on
+     * @param payload the message
+     * @param on_complete called once the message is acknowledged, may be
+     * empty
+     * @return false if the message could not be queued
+     */
+    virtual bool Publish(
+        const std::string &topic,
+        const std::string &payload,
+        PublishHandler on_complete) = 0;
+};
+
+#endif  // TRL_MQTT_TRANSPORT_HPP
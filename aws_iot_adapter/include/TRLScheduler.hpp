@@ -0,0 +1,122 @@
+#ifndef TRL_SCHEDULER_HPP
+#define TRL_SCHEDULER_HPP
+
+// Timer wheel
+#include "TRLTimerWheel.hpp"
+
+// Standard includes
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Logging
+#include <boost/log/trivial.hpp>
+
+/**
+ * @brief Timing statistics of one periodic schedule
+ */
+struct TRLScheduleStats {
+    std::string name = "";                 // schedule name
+    std::chrono::milliseconds period{0};   // configured period
+    uint64_t runs = 0;                     // number of times the task ran
+    uint64_t overruns = 0;                 // periods missed or skipped
+    std::chrono::microseconds max_jitter{0};   // worst start delay
+    std::chrono::microseconds mean_jitter{0};  // average start delay
+};
+
+/**
+ * @brief Runs periodic tasks on a hierarchical timer wheel.
+ *
+ * Deadlines are computed on the monotonic clock from the start of the
+ * schedule, so a late run does not shift the following ones. A run that
+ * starts one or more periods late counts the missed periods as overruns and
+ * the schedule continues with the next deadline in the future. The start
+ * delay of every run is recorded as jitter, it includes up to one tick of
+ * timer resolution.
+ */
+class TRLScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief A periodic task. It returns false when it skipped its run,
+     * e.g. because the previous run is still busy, which counts as overrun.
+     */
+    using Task = std::function<bool()>;
+
+    /**
+     * @brief TRLScheduler constructor
+     * @param resolution duration of one timer wheel tick
+     * @param stats_interval period of the statistics log, zero disables it
+     */
+    TRLScheduler(
+        std::chrono::milliseconds resolution,
+        std::chrono::seconds stats_interval);
+
+    TRLScheduler(const TRLScheduler &) = delete;
+    TRLScheduler &operator=(const TRLScheduler &) = delete;
+
+    /**
+     * @brief Adds a periodic task, must be called before Run()
+     * @param name name used in logs and statistics
+     * @param period time between two runs, at least one tick
+     * @param task the task to run on the scheduler thread, it should return
+     * quickly and hand blocking work to another thread
+     */
+    void Add(
+        const std::string &name,
+        std::chrono::milliseconds period,
+        Task task);
+
+    /**
+     * @brief Runs the schedules on the calling thread
+     * @param keep_running checked at least every 100ms, Run() returns once it
+     * returns false
+     */
+    void Run(const std::function<bool()> &keep_running);
+
+    /**
+     * @brief Returns a copy of the statistics of every schedule. Safe to call
+     * from any thread.
+     */
+    std::vector<TRLScheduleStats> Stats() const;
+
+    /**
+     * @brief Logs the statistics of every schedule
+     */
+    void LogStats() const;
+
+private:
+    struct Schedule {
+        Clock::duration period;        // time between two runs
+        Task task;                     // the periodic task
+        Clock::time_point deadline;    // start time of the next run
+        Clock::duration jitter_sum{0}; // sum of all start delays
+        uint64_t fires = 0;            // runs and skipped runs
+    };
+
+    /**
+     * @brief Runs a due schedule and inserts its next deadline in the wheel
+     */
+    void Fire(size_t id);
+
+    /**
+     * @brief Converts a time point to the first tick not earlier than it
+     */
+    uint64_t ToTick(Clock::time_point time) const;
+
+private:
+    const Clock::duration m_resolution;      // duration of one tick
+    const Clock::duration m_stats_interval;  // statistics log period
+    Clock::time_point m_start;               // time of tick 0
+    TRLTimerWheel m_wheel;                   // pending deadlines
+    std::vector<Schedule> m_schedules;       // all schedules, by id
+    std::vector<size_t> m_due;               // reused list of due schedules
+    mutable std::mutex m_stats_mutex;        // protects m_stats
+    std::vector<TRLScheduleStats> m_stats;   // statistics, by schedule id
+};
+
+#endif  // TRL_SCHEDULER_HPP
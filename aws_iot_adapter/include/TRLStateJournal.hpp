@@ -0,0 +1,156 @@
+#ifndef TRL_STATE_JOURNAL_HPP
+#define TRL_STATE_JOURNAL_HPP
+
+// Standard includes
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Logging
+#include <boost/log/trivial.hpp>
+
+/**
+ * @brief Bounded store-and-forward journal of state messages.
+ *
+ * Messages are appended to a byte ring inside a memory-mapped file, so the
+ * journal survives a restart of the process. When the ring is full the
+ * oldest messages are dropped. Replay() returns the messages in the order
+ * they were appended and skips every message superseded by a newer one of
+ * the same device on the same topic.
+ */
+class TRLStateJournal {
+public:
+    /**
+     * @brief Publishes one replayed message, returns false if the message
+     * could not be sent and has to stay in the journal
+     */
+    using Publisher = std::function<bool(
+        const std::string &topic,
+        const std::string &payload)>;
+
+    /**
+     * @brief TRLStateJournal simple constructor
+     */
+    TRLStateJournal();
+
+    /**
+     * @brief Flushes and unmaps the journal file
+     */
+    ~TRLStateJournal();
+
+    TRLStateJournal(const TRLStateJournal &) = delete;
+    TRLStateJournal &operator=(const TRLStateJournal &) = delete;
+
+    /**
+     * @brief Opens or creates the journal file. The messages of an existing
+     * journal of the same capacity are kept, any other file is reset.
+     * @param path path of the journal file
+     * @param capacity size of the message ring in bytes
+     * @return 1 if the initialization is successful
+     * @return 0 otherwise
+     */
+    bool Initialize(const std::string &path, size_t capacity);
+
+    /**
+     * @brief Appends a state message, dropping the oldest messages if the
+     * ring is full
+     * @param topic the mqtt topic of the message
+     * @param device name of the device the state belongs to
+     * @param payload the serialized state
+     */
+    void Append(
+        const std::string &topic,
+        const std::string &device,
+        const std::string &payload);
+
+    /**
+     * @brief Publishes up to max_messages of the oldest messages and removes
+     * them from the journal. Superseded messages are removed without being
+     * published and do not count towards max_messages.
+     * @param max_messages maximum number of messages to publish
+     * @param publish publishes one message
+     * @return the number of published messages
+     */
+    size_t Replay(size_t max_messages, const Publisher &publish);
+
+    /**
+     * @brief Checks if no message is waiting for replay
+     */
+    bool Empty() const;
+
+    /**
+     * @brief Returns the number of messages dropped because the ring was full
+     */
+    uint64_t Dropped() const;
+
+private:
+    /**
+     * @brief Start of the journal file
+     */
+    struct Header {
+        uint32_t magic;     // JOURNAL_MAGIC
+        uint32_t version;   // JOURNAL_VERSION
+        uint64_t capacity;  // size of the ring in bytes
+        uint64_t head;      // offset of the oldest message
+        uint64_t tail;      // offset past the newest message
+    };
+
+    /**
+     * @brief Start of every message in the ring, followed by the topic, the
+     * device name and the payload
+     */
+    struct Record {
+        uint32_t payload_size;
+        uint16_t topic_size;
+        uint16_t device_size;
+    };
+
+    /**
+     * @brief Copies bytes into the ring, wrapping at its end
+     * @param offset journal offset, not reduced to the ring size
+     */
+    void Write(uint64_t offset, const void *data, size_t size);
+
+    /**
+     * @brief Copies bytes out of the ring, wrapping at its end
+     */
+    void Read(uint64_t offset, void *data, size_t size) const;
+
+    /**
+     * @brief Reads the message at offset into m_topic, m_device and
+     * m_payload
+     * @return the size of the message in the ring
+     */
+    uint64_t ReadRecord(uint64_t offset);
+
+    /**
+     * @brief Removes the oldest message
+     */
+    void DropHead();
+
+    /**
+     * @brief Rebuilds m_latest from the messages of an existing journal,
+     * discarding a torn message at the end
+     */
+    void Recover();
+
+    static std::string Key(const std::string &topic, const std::string &device);
+
+private:
+    mutable std::mutex m_mutex;  // protects the ring and the index
+    int m_fd = -1;               // journal file
+    size_t m_mapped_size = 0;    // size of the mapping
+    Header *m_header = nullptr;  // mapped file header
+    uint8_t *m_ring = nullptr;   // mapped message ring
+    uint64_t m_capacity = 0;     // size of the ring in bytes
+    std::unordered_map<std::string, uint64_t>
+        m_latest;              // topic and device to offset of the newest
+    uint64_t m_dropped = 0;    // messages dropped because the ring was full
+    std::string m_topic;       // reusable topic of the message being read
+    std::string m_device;      // reusable device of the message being read
+    std::string m_payload;     // reusable payload of the message being read
+};
+
+#endif  // TRL_STATE_JOURNAL_HPP
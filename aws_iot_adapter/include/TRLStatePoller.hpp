@@ -0,0 +1,80 @@
+#ifndef TRL_STATE_POLLER_HPP
+#define TRL_STATE_POLLER_HPP
+
+// TRL Lift Interface
+#include "TRLLiftInterface.hpp"
+// TRL Door Interface
+#include "TRLDoorInterface.hpp"
+// Device state snapshot
+#include "TRLDeviceState.hpp"
+// Worker pool
+#include "TRLWorkerPool.hpp"
+// Device read latencies
+#include "TRLLatencyMetrics.hpp"
+
+// Standard includes
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Logging
+#include <boost/log/trivial.hpp>
+
+class TRLStatePoller {
+public:
+    /**
+     * @brief TRLStatePoller constructor
+     * @param num_workers maximum number of devices sampled at the same time
+     */
+    explicit TRLStatePoller(size_t num_workers);
+
+    /**
+     * @brief Samples every door and lift concurrently on the worker pool and
+     * blocks until all of them are done
+     * @param doors doors to sample
+     * @param lifts lifts to sample
+     * @return a snapshot holding one entry per device, in the order of the
+     * given vectors, all stamped with the same cycle time
+     */
+    TRLFleetState Poll(
+        const std::vector<std::shared_ptr<TRLDoorInterface>> &doors,
+        const std::vector<std::shared_ptr<TRLLiftInterface>> &lifts);
+
+    /**
+     * @brief Runs a task on the polling workers without waiting for it
+     * @param task the task to run, it must not throw
+     */
+    void Submit(std::function<void()> task);
+
+    /**
+     * @brief Returns the current sample time in seconds since epoch
+     */
+    static int SampleTime();
+
+    /**
+     * @brief Samples a single door on the calling thread
+     * @param door the door to sample
+     * @param time the sample time in seconds since epoch
+     * @param latencies records the read latency, may be null
+     */
+    static TRLDoorState SampleDoor(
+        TRLDoorInterface &door,
+        int time,
+        TRLDoorLatencies *latencies = nullptr);
+
+    /**
+     * @brief Samples a single lift on the calling thread
+     * @param lift the lift to sample
+     * @param time the sample time in seconds since epoch
+     * @param latencies records the read latencies, may be null
+     */
+    static TRLLiftState SampleLift(
+        TRLLiftInterface &lift,
+        int time,
+        TRLLiftLatencies *latencies = nullptr);
+
+private:
+    TRLWorkerPool m_pool;  // bounded pool running the device reads
+};
+
+#endif  // TRL_STATE_POLLER_HPP
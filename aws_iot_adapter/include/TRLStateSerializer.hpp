@@ -0,0 +1,48 @@
+#ifndef TRL_STATE_SERIALIZER_HPP
+#define TRL_STATE_SERIALIZER_HPP
+
+// Device state snapshot
+#include "TRLDeviceState.hpp"
+
+// Standard includes
+#include <string>
+#include <vector>
+
+/**
+ * @brief Serializes door and lift states to JSON without building a DOM.
+ *
+ * The output is byte-for-byte identical to nlohmann::json::dump() of the
+ * objects the adapter used to build: keys in lexicographic order, no
+ * whitespace, control characters escaped the same way. Strings are expected
+ * to be valid UTF-8 and are copied as they are.
+ *
+ * Every function appends to the given buffer. Once the buffer has grown to
+ * the size of a message, serializing into it again after clear() does not
+ * allocate.
+ */
+class TRLStateSerializer {
+public:
+    /**
+     * @brief Appends the JSON object of a door state
+     * @param state the door state
+     * @param out the buffer to append to
+     */
+    static void Serialize(const TRLDoorState &state, std::string &out);
+
+    /**
+     * @brief Appends the JSON object of a lift state
+     * @param state the lift state
+     * @param out the buffer to append to
+     */
+    static void Serialize(const TRLLiftState &state, std::string &out);
+
+private:
+    static void AppendInt(long long value, std::string &out);
+    static void AppendString(const std::string &value, std::string &out);
+    static void AppendArray(const std::vector<int> &values, std::string &out);
+    static void AppendArray(
+        const std::vector<std::string> &values,
+        std::string &out);
+};
+
+#endif  // TRL_STATE_SERIALIZER_HPP
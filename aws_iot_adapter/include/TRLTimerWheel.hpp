@@ -0,0 +1,86 @@
+#ifndef TRL_TIMER_WHEEL_HPP
+#define TRL_TIMER_WHEEL_HPP
+
+// Standard includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// number of wheel levels, each level covers 64 times the range of the one
+// below, so timers can be at most 2^24 ticks ahead
+#define TIMER_WHEEL_LEVELS 4
+// log2 of the number of slots per level
+#define TIMER_WHEEL_SLOT_BITS 6
+
+/**
+ * @brief Hierarchical timer wheel counting in abstract ticks.
+ *
+ * A timer close to its expiry sits in the 64 slots of level 0, timers further
+ * away sit in the coarser upper levels and are cascaded down whenever the
+ * current tick crosses the boundary of their slot. Inserting and expiring a
+ * timer is O(1), independent of the number of timers. The wheel is not
+ * thread safe.
+ */
+class TRLTimerWheel {
+public:
+    /**
+     * @brief TRLTimerWheel constructor, the wheel starts at tick 0
+     */
+    TRLTimerWheel();
+
+    /**
+     * @brief Adds a timer
+     * @param id identifier reported when the timer expires
+     * @param expiry tick at which the timer expires, timers in the past
+     * expire on the next tick
+     */
+    void Insert(size_t id, uint64_t expiry);
+
+    /**
+     * @brief Moves the wheel forward to the given tick
+     * @param tick the new current tick, ignored if not in the future
+     * @param expired receives the ids of all timers that expired on the way,
+     * in expiry order
+     */
+    void Advance(uint64_t tick, std::vector<size_t> &expired);
+
+    /**
+     * @brief Returns the earliest tick at which Advance() may expire a timer.
+     * Timers in the upper levels are only seen once they are cascaded, so the
+     * result can be earlier than the real next expiry, but never later.
+     */
+    uint64_t NextTick() const;
+
+    /**
+     * @brief Returns the current tick
+     */
+    uint64_t Current() const;
+
+private:
+    struct Timer {
+        size_t id;        // caller provided identifier
+        uint64_t expiry;  // absolute expiry tick
+    };
+
+    using Slot = std::vector<Timer>;
+    using Level = std::array<Slot, 1 << TIMER_WHEEL_SLOT_BITS>;
+
+    /**
+     * @brief Places a timer in the level and slot matching its distance to
+     * the current tick
+     */
+    void Place(const Timer &timer);
+
+    /**
+     * @brief Redistributes the timers of one upper level slot
+     */
+    void Cascade(size_t level);
+
+private:
+    std::array<Level, TIMER_WHEEL_LEVELS> m_levels;  // slots of every level
+    uint64_t m_current = 0;                          // current tick
+    Slot m_scratch;  // reused while expiring or cascading a slot
+};
+
+#endif  // TRL_TIMER_WHEEL_HPP
@@ -0,0 +1,53 @@
+#ifndef TRL_WORKER_POOL_HPP
+#define TRL_WORKER_POOL_HPP
+
+// Standard includes
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TRLWorkerPool {
+public:
+    /**
+     * @brief Starts a fixed number of worker threads
+     * @param num_workers number of threads, at least one thread is started
+     */
+    explicit TRLWorkerPool(size_t num_workers);
+
+    /**
+     * @brief Stops the workers once the queued tasks are drained
+     */
+    ~TRLWorkerPool();
+
+    TRLWorkerPool(const TRLWorkerPool &) = delete;
+    TRLWorkerPool &operator=(const TRLWorkerPool &) = delete;
+
+    /**
+     * @brief Queues a task to be run by one of the workers
+     * @param task the task to run, it must not throw
+     */
+    void Submit(std::function<void()> task);
+
+    /**
+     * @brief Returns the number of worker threads
+     */
+    size_t Size() const;
+
+private:
+    /**
+     * @brief Worker thread body, runs queued tasks until the pool stops
+     */
+    void Run();
+
+private:
+    std::vector<std::thread> m_workers;        // worker threads
+    std::deque<std::function<void()>> m_tasks; // queued tasks
+    std::mutex m_mutex;                        // protects m_tasks and m_stop
+    std::condition_variable m_cv;              // signals new tasks or stop
+    bool m_stop = false;                       // set when the pool shuts down
+};
+
+#endif  // TRL_WORKER_POOL_HPP
@@ -0,0 +1,126 @@
+#ifndef TRL_WORKFLOW_EXECUTOR_HPP
+#define TRL_WORKFLOW_EXECUTOR_HPP
+
+// Lock-free command queue
+#include "TRLCommandQueue.hpp"
+// Shared event loop
+#include "TRLEventLoop.hpp"
+
+// Standard includes
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Logging
+#include <boost/log/trivial.hpp>
+
+/**
+ * @brief Runs the commands of a single device as asynchronous workflows on a
+ * shared event loop.
+ *
+ * It keeps the contract of TRLDeviceExecutor: Post() never blocks and the
+ * commands of one device are executed one after another in arrival order.
+ * Instead of a thread per device, the handler starts a workflow on the loop
+ * and calls done once it finished, the next command then starts.
+ */
+template <typename Command>
+class TRLWorkflowExecutor {
+public:
+    /**
+     * @brief Ends the workflow of a command, called once from any thread.
+     * Further calls are logged and ignored.
+     */
+    using Done = std::function<void()>;
+    using Handler = std::function<void(Command &, Done)>;
+
+    /**
+     * @brief TRLWorkflowExecutor constructor
+     * @param name name of the device, used for logging
+     * @param queue_size maximum number of pending commands
+     * @param loop the loop running the workflows, it must be destroyed
+     * before the executor and then runs the pending commands
+     * @param handler starts the workflow of one command on the loop thread
+     */
+    TRLWorkflowExecutor(
+        const std::string &name,
+        size_t queue_size,
+        TRLEventLoop &loop,
+        Handler handler)
+        : m_name(name),
+          m_queue(queue_size),
+          m_loop(loop),
+          m_handler(std::move(handler))
+    {
+    }
+
+    TRLWorkflowExecutor(const TRLWorkflowExecutor &) = delete;
+    TRLWorkflowExecutor &operator=(const TRLWorkflowExecutor &) = delete;
+
+    /**
+     * @brief Queues a command without blocking
+     * @param command the command to execute
+     * @return false if the queue is full and the command was dropped
+     */
+    bool Post(Command command)
+    {
+        if (!m_queue.Push(std::move(command))) {
+            BOOST_LOG_TRIVIAL(error)
+                << m_name
+                << "| TRLWorkflowExecutor::Post command queue full, dropping "
+                   "command.";
+            return false;
+        }
+        m_loop.Post([this]() { Next(); });
+        return true;
+    }
+
+private:
+    /**
+     * @brief Starts the next command unless a workflow is running, on the
+     * loop thread
+     */
+    void Next()
+    {
+        if (m_busy || !m_queue.Pop(m_current)) {
+            return;
+        }
+        m_busy = true;
+        // the loop keeps running until the workflow ended
+        m_loop.ExpectPost();
+        // a handler throwing after it ended the workflow must not end it
+        // twice, the loop would then wait for a post forever
+        auto called = std::make_shared<std::atomic<bool>>(false);
+        Done done = [this, called]() {
+            if (called->exchange(true)) {
+                BOOST_LOG_TRIVIAL(warning)
+                    << m_name
+                    << "| TRLWorkflowExecutor::Next workflow ended twice, "
+                       "ignored.";
+                return;
+            }
+            m_loop.PostExpected([this]() {
+                m_busy = false;
+                Next();
+            });
+        };
+        try {
+            m_handler(m_current, done);
+        } catch (const std::exception &e) {
+            BOOST_LOG_TRIVIAL(error)
+                << m_name << "| TRLWorkflowExecutor::Next command failed. "
+                << e.what();
+            done();
+        }
+    }
+
+private:
+    const std::string m_name;          // device name
+    TRLCommandQueue<Command> m_queue;  // pending commands
+    TRLEventLoop &m_loop;              // runs the workflows
+    Handler m_handler;                 // starts the workflow of a command
+    Command m_current;                 // command of the running workflow
+    bool m_busy = false;               // a workflow runs, loop thread only
+};
+
+#endif  // TRL_WORKFLOW_EXECUTOR_HPP
@@ -0,0 +1,244 @@
+#include "TRLAwsMqttTransport.hpp"
+
+TRLAwsMqttTransport::TRLAwsMqttTransport() {}
+
+TRLAwsMqttTransport::~TRLAwsMqttTransport()
+{
+    Disconnect();
+}
+
+bool TRLAwsMqttTransport::Initialize(const YAML::Node &config)
+{
+    if (!(config["ca_file_path"] && config["cert_path"] &&
+          config["key_path"] && config["client_id"] && config["aws_url"])) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLAwsMqttTransport::Initialize failed. Config file needs to have ca_file_path, cert_path, key_path, client_id and aws_url.";
+        return false;
+    }
+    std::string cert_path = config["cert_path"].as<std::string>();
+    std::string key_path = config["key_path"].as<std::string>();
+    std::string aws_url = config["aws_url"].as<std::string>();
+    std::string ca_file_path = config["ca_file_path"].as<std::string>();
+    m_client_id = config["client_id"].as<std::string>();
+
+    m_internal_client = Aws::Iot::MqttClient();
+
+    if (!m_internal_client) {
+        BOOST_LOG_TRIVIAL(error)
+            << ("TRLAwsMqttTransport::Initialize MQTT Client Creation failed with error %s",
+                Aws::Crt::ErrorDebugString(m_internal_client.LastError()));
+        return false;
+    }
+
+    m_connection = BuildDirectMQTTConnection(
+        m_internal_client,
+        cert_path,
+        key_path,
+        aws_url,
+        ca_file_path);
+    return true;
+}
+
+bool TRLAwsMqttTransport::Connect(const Callbacks &callbacks)
+{
+    auto onConnectionCompleted = [callbacks](
+                                     Aws::Crt::Mqtt::MqttConnection &,
+                                     int error_code,
+                                     Aws::Crt::Mqtt::ReturnCode return_code,
+                                     bool) {
+        if (error_code) {
+            BOOST_LOG_TRIVIAL(error)
+                << "TRLAwsMqttTransport::Connect MQTT Client Connection failed with error code: "
+                << error_code;
+            return false;
+        } else {
+            BOOST_LOG_TRIVIAL(info)
+                << "TRLAwsMqttTransport::Connect Connection completed with return code "
+                << return_code;
+        }
+        if (callbacks.on_connected) {
+            callbacks.on_connected();
+        }
+        return true;
+    };
+
+    auto onInterrupted = [callbacks](Aws::Crt::Mqtt::MqttConnection &,
+                                     int error) {
+        BOOST_LOG_TRIVIAL(error)
+            << "m_connection::onInterrupted interrupted with error: "
+            << error;
+        if (callbacks.on_interrupted) {
+            callbacks.on_interrupted(error);
+        }
+    };
+
+    auto onResumed = [callbacks](Aws::Crt::Mqtt::MqttConnection &,
+                                 Aws::Crt::Mqtt::ReturnCode,
+                                 bool) {
+        BOOST_LOG_TRIVIAL(info) << ("m_connection::onResumedConnection resumed");
+        if (callbacks.on_resumed) {
+            callbacks.on_resumed();
+        }
+    };
+
+    auto onDisconnect = [&](Aws::Crt::Mqtt::MqttConnection &) {
+        {
+            BOOST_LOG_TRIVIAL(info)
+                << ("m_connection::onDisconnect Disconnection completed.");
+            m_closed_promise.set_value();
+        }
+    };
+    m_connection->OnConnectionCompleted = std::move(onConnectionCompleted);
+    m_connection->OnDisconnect = std::move(onDisconnect);
+    m_connection->OnConnectionInterrupted = std::move(onInterrupted);
+    m_connection->OnConnectionResumed = std::move(onResumed);
+
+    // connecting
+    BOOST_LOG_TRIVIAL(info) << ("TRLAwsMqttTransport::MQTT Connecting..");
+
+    if (!m_connection->Connect(
+            m_client_id.c_str(),
+            false /*cleanSession*/,
+            1000 /*keepAliveTimeSecs*/)) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLAwsMqttTransport::Connect MQTT Connecting Failed.";
+        return false;
+    }
+    m_connecting = true;
+    return true;
+}
+
+void TRLAwsMqttTransport::Disconnect()
+{
+    if (!m_connecting) {
+        return;
+    }
+    m_connecting = false;
+    if (m_connection->Disconnect()) {
+        m_closed_promise.get_future().wait();
+    }
+}
+
+bool TRLAwsMqttTransport::Subscribe(
+    const std::vector<std::pair<std::string, MessageHandler>> &subscriptions)
+{
+    auto onMultiSubAck = [](Aws::Crt::Mqtt::MqttConnection &,
+                             uint16_t packet_id,
+                             const Aws::Crt::Vector<Aws::Crt::String> &topics,
+                             Aws::Crt::Mqtt::QOS qos,
+                             int error_code) {
+        if (error_code) {
+            BOOST_LOG_TRIVIAL(error)
+                << "m_connection::Subscribe::onSubAck MQTT Subscribe Connection failed with error code: "
+                << error_code;
+            return false;
+        } else {
+            if (!packet_id || qos == AWS_MQTT_QOS_FAILURE) {
+                BOOST_LOG_TRIVIAL(error)
+                    << "m_connection::Subscribe::onSubAck Subscriber rejected by the broker.";
+                return false;
+            } else {
+                for (auto x : topics) {
+                    BOOST_LOG_TRIVIAL(info)
+                        << "m_connection::Subscribe::onSubAck Subscribe on topic "
+                        << x.c_str() << " on packet id " << packet_id
+                        << " succeeded";
+                }
+                return true;
+            }
+        }
+    };
+
+    Aws::Crt::Vector<
+        std::pair<const char *, Aws::Crt::Mqtt::OnMessageReceivedHandler>>
+        aws_subscriptions;
+    // the topic strings must outlive the subscription
+    m_topics.clear();
+    m_topics.reserve(subscriptions.size());
+    for (const auto &[topic, handler] : subscriptions) {
+        m_topics.push_back(topic);
+        aws_subscriptions.emplace_back(
+            m_topics.back().c_str(),
+            [handler](
+                Aws::Crt::Mqtt::MqttConnection &,
+                const Aws::Crt::String &topic,
+                const Aws::Crt::ByteBuf &byte_buf,
+                bool /*dup*/,
+                Aws::Crt::Mqtt::QOS /*qos*/,
+                bool /*retain*/) {
+                handler(
+                    std::string(topic.c_str(), topic.size()),
+                    std::string(
+                        byte_buf.buffer,
+                        byte_buf.buffer + byte_buf.len));
+            });
+    }
+
+    return m_connection->Subscribe(
+               aws_subscriptions,
+               AWS_MQTT_QOS_AT_LEAST_ONCE,
+               onMultiSubAck) != 0;
+}
+
+bool TRLAwsMqttTransport::Publish(
+    const std::string &topic,
+    const std::string &payload,
+    PublishHandler on_complete)
+{
+    auto onPublishComplete = [on_complete = std::move(on_complete)](
+                                 Aws::Crt::Mqtt::MqttConnection &,
+                                 uint16_t,
+                                 int error_code) {
+        if (on_complete) {
+            on_complete(error_code);
+        }
+    };
+    Aws::Crt::ByteBuf byte_buf = Aws::Crt::ByteBufFromArray(
+        (const uint8_t *)payload.data(),
+        payload.length());
+    return m_connection->Publish(
+               topic.c_str(),
+               AWS_MQTT_QOS_AT_LEAST_ONCE,
+               false,
+               byte_buf,
+               std::move(onPublishComplete)) != 0;
+}
+
+std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>
+TRLAwsMqttTransport::BuildDirectMQTTConnection(
+    Aws::Iot::MqttClient &client,
+    std::string &cert_path,
+    std::string &key_path,
+    std::string &aws_url,
+    std::string &ca_file_path)
+{
+    auto client_config_builder = Aws::Iot::MqttClientConnectionConfigBuilder(
+        cert_path.c_str(),
+        key_path.c_str());
+    client_config_builder.WithEndpoint(aws_url.c_str());
+    client_config_builder.WithCertificateAuthority(ca_file_path.c_str());
+    return GetClientConnectionForMQTTConnection(client, client_config_builder);
+}
+
+std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>
+TRLAwsMqttTransport::GetClientConnectionForMQTTConnection(
+    Aws::Iot::MqttClient &client,
+    Aws::Iot::MqttClientConnectionConfigBuilder &client_config_builder)
+{
+    auto clientConfig = client_config_builder.Build();
+    if (!clientConfig) {
+        BOOST_LOG_TRIVIAL(fatal)
+            << ("TRLAwsMqttTransport::GetClientConnectionForMQTTConnection Client Configuration initialization failed with error %s\n",
+                Aws::Crt::ErrorDebugString(clientConfig.LastError()));
+        exit(-1);
+    }
+
+    auto connection = client.NewConnection(clientConfig);
+    if (!*connection) {
+        BOOST_LOG_TRIVIAL(fatal)
+            << ("TRLAwsMqttTransport::GetClientConnectionForMQTTConnection MQTT Connection Creation failed with error %s\n",
+                Aws::Crt::ErrorDebugString(connection->LastError()));
+        exit(-1);
+    }
+    return connection;
+}
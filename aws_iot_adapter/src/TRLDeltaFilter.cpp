@@ -0,0 +1,117 @@
+#include "TRLDeltaFilter.hpp"
+
+TRLDeltaFilter::TRLDeltaFilter(
+    bool enabled,
+    std::chrono::seconds keyframe_interval)
+    : m_enabled(enabled), m_keyframe_interval(keyframe_interval)
+{
+}
+
+bool TRLDeltaFilter::ShouldPublish(
+    const TRLDoorState &state,
+    Clock::time_point now)
+{
+    std::scoped_lock lock(m_mutex);
+    return Decide(m_doors[state.door_name], state, now);
+}
+
+bool TRLDeltaFilter::ShouldPublish(
+    const TRLLiftState &state,
+    Clock::time_point now)
+{
+    std::scoped_lock lock(m_mutex);
+    return Decide(m_lifts[state.lift_name], state, now);
+}
+
+void TRLDeltaFilter::ForgetDoor(const std::string &door_name)
+{
+    std::scoped_lock lock(m_mutex);
+    Forget(m_doors[door_name]);
+}
+
+void TRLDeltaFilter::ForgetLift(const std::string &lift_name)
+{
+    std::scoped_lock lock(m_mutex);
+    Forget(m_lifts[lift_name]);
+}
+
+void TRLDeltaFilter::ForceKeyframe()
+{
+    m_generation++;
+}
+
+std::map<std::string, TRLPublishCounters> TRLDeltaFilter::DoorCounters()
+    const
+{
+    std::scoped_lock lock(m_mutex);
+    std::map<std::string, TRLPublishCounters> counters;
+    for (const auto &[name, entry] : m_doors) {
+        counters[name] = entry.counters;
+    }
+    return counters;
+}
+
+std::map<std::string, TRLPublishCounters> TRLDeltaFilter::LiftCounters()
+    const
+{
+    std::scoped_lock lock(m_mutex);
+    std::map<std::string, TRLPublishCounters> counters;
+    for (const auto &[name, entry] : m_lifts) {
+        counters[name] = entry.counters;
+    }
+    return counters;
+}
+
+template <typename State>
+bool TRLDeltaFilter::Decide(
+    Entry<State> &entry,
+    const State &state,
+    Clock::time_point now)
+{
+    const uint64_t generation = m_generation.load();
+    const bool keyframe_due = !entry.valid ||
+                              entry.generation != generation ||
+                              now - entry.last_keyframe >= m_keyframe_interval;
+
+    if (m_enabled && !keyframe_due && SameState(entry.last, state)) {
+        entry.counters.suppressed++;
+        return false;
+    }
+
+    if (keyframe_due) {
+        entry.last_keyframe = now;
+        entry.generation = generation;
+    }
+    entry.valid = true;
+    entry.last = state;
+    entry.counters.sent++;
+    return true;
+}
+
+template <typename State>
+void TRLDeltaFilter::Forget(Entry<State> &entry)
+{
+    if (entry.valid) {
+        entry.valid = false;
+        entry.counters.sent--;
+    }
+}
+
+bool TRLDeltaFilter::SameState(const TRLDoorState &a, const TRLDoorState &b)
+{
+    // the sample time is not part of the comparison
+    return a.door_name == b.door_name && a.current_mode == b.current_mode;
+}
+
+bool TRLDeltaFilter::SameState(const TRLLiftState &a, const TRLLiftState &b)
+{
+    // the sample time is not part of the comparison
+    return a.lift_name == b.lift_name &&
+           a.available_floors == b.available_floors &&
+           a.current_floor == b.current_floor &&
+           a.destination_floor == b.destination_floor &&
+           a.door_state == b.door_state &&
+           a.motion_state == b.motion_state &&
+           a.available_modes == b.available_modes &&
+           a.lift_mode == b.lift_mode && a.session_id == b.session_id;
+}
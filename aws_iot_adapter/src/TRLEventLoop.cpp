@@ -0,0 +1,206 @@
+#include "TRLEventLoop.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+TRLEventLoop::TRLEventLoop(const std::string &name)
+    : m_name(name), m_start(Clock::now())
+{
+    if (pipe(m_wake_fds)) {
+        throw std::runtime_error("TRLEventLoop cannot create wake pipe");
+    }
+    for (const int fd : m_wake_fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    m_thread = std::thread(&TRLEventLoop::Run, this);
+}
+
+TRLEventLoop::~TRLEventLoop()
+{
+    m_stop = true;
+    Wake();
+    m_thread.join();
+    close(m_wake_fds[0]);
+    close(m_wake_fds[1]);
+}
+
+void TRLEventLoop::Post(Task task)
+{
+    bool wake = false;
+    {
+        std::scoped_lock lock(m_mutex);
+        // the loop only needs one byte in the pipe per batch of tasks
+        wake = m_posted.empty();
+        m_posted.push_back(std::move(task));
+    }
+    if (wake) {
+        Wake();
+    }
+}
+
+void TRLEventLoop::ExpectPost()
+{
+    m_expected++;
+}
+
+void TRLEventLoop::PostExpected(Task task)
+{
+    // the task is queued before the loop may see nothing pending
+    Post(std::move(task));
+    m_expected--;
+}
+
+void TRLEventLoop::After(Clock::duration delay, Task task)
+{
+    const auto resolution = std::chrono::milliseconds(EVENT_LOOP_RESOLUTION_MS);
+    const auto due = Clock::now() + delay - m_start;
+    const uint64_t expiry = (due + resolution - Clock::duration(1)) / resolution;
+    size_t id;
+    if (m_free_timers.empty()) {
+        id = m_timers.size();
+        m_timers.push_back(std::move(task));
+    } else {
+        id = m_free_timers.back();
+        m_free_timers.pop_back();
+        m_timers[id] = std::move(task);
+    }
+    m_wheel.Insert(id, expiry);
+    m_pending_timers++;
+}
+
+void TRLEventLoop::WhenReadable(
+    int fd,
+    Clock::duration timeout,
+    ReadyHandler handler)
+{
+    m_watches.push_back(Watch{fd, Clock::now() + timeout, std::move(handler)});
+}
+
+bool TRLEventLoop::InLoop() const
+{
+    return std::this_thread::get_id() == m_thread.get_id();
+}
+
+void TRLEventLoop::Run()
+{
+    for (;;) {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_running.swap(m_posted);
+        }
+        for (auto &task : m_running) {
+            RunTask(task);
+        }
+        m_running.clear();
+        RunTimers();
+        if (m_stop && Idle()) {
+            return;
+        }
+        Poll();
+    }
+}
+
+void TRLEventLoop::RunTask(Task &task)
+{
+    try {
+        task();
+    } catch (const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error)
+            << m_name << "| TRLEventLoop::Run task failed. " << e.what();
+    }
+}
+
+void TRLEventLoop::RunTimers()
+{
+    const auto resolution = std::chrono::milliseconds(EVENT_LOOP_RESOLUTION_MS);
+    m_expired.clear();
+    m_wheel.Advance((Clock::now() - m_start) / resolution, m_expired);
+    for (const auto id : m_expired) {
+        // the task may add timers, which can reuse its id
+        Task task = std::move(m_timers[id]);
+        m_timers[id] = nullptr;
+        m_free_timers.push_back(id);
+        m_pending_timers--;
+        RunTask(task);
+    }
+}
+
+void TRLEventLoop::Poll()
+{
+    const auto resolution = std::chrono::milliseconds(EVENT_LOOP_RESOLUTION_MS);
+    const auto now = Clock::now();
+    auto wake = Clock::time_point::max();
+    if (m_pending_timers) {
+        wake = m_start + resolution * static_cast<Clock::rep>(
+                                          m_wheel.NextTick());
+    }
+    m_pollfds.clear();
+    m_pollfds.push_back(pollfd{m_wake_fds[0], POLLIN, 0});
+    for (const auto &watch : m_watches) {
+        m_pollfds.push_back(pollfd{watch.fd, POLLIN, 0});
+        wake = std::min(wake, watch.deadline);
+    }
+    int timeout = -1;
+    if (wake != Clock::time_point::max()) {
+        // rounded up, poll() must not return before the deadline
+        timeout = static_cast<int>(std::max<Clock::rep>(
+            0,
+            std::chrono::ceil<std::chrono::milliseconds>(wake - now).count()));
+    }
+    if (poll(m_pollfds.data(), m_pollfds.size(), timeout) < 0) {
+        for (auto &fd : m_pollfds) {
+            fd.revents = 0;
+        }
+    }
+    if (m_pollfds[0].revents) {
+        char buffer[64];
+        while (read(m_wake_fds[0], buffer, sizeof(buffer)) > 0) {
+        }
+    }
+
+    // the handlers may add watches, the ready ones are removed first
+    const auto polled = Clock::now();
+    size_t kept = 0;
+    for (size_t i = 0; i < m_watches.size(); ++i) {
+        // errors and hang ups are reported as readable, the read fails
+        const bool readable = m_pollfds[i + 1].revents != 0;
+        if (readable || polled >= m_watches[i].deadline) {
+            m_ready.emplace_back(std::move(m_watches[i].handler), readable);
+        } else {
+            if (kept != i) {
+                m_watches[kept] = std::move(m_watches[i]);
+            }
+            kept++;
+        }
+    }
+    m_watches.resize(kept);
+    for (auto &[handler, readable] : m_ready) {
+        try {
+            handler(readable);
+        } catch (const std::exception &e) {
+            BOOST_LOG_TRIVIAL(error)
+                << m_name << "| TRLEventLoop::Run handler failed. "
+                << e.what();
+        }
+    }
+    m_ready.clear();
+}
+
+void TRLEventLoop::Wake()
+{
+    const char byte = 0;
+    // a full pipe already wakes the loop
+    (void)!write(m_wake_fds[1], &byte, 1);
+}
+
+bool TRLEventLoop::Idle()
+{
+    std::scoped_lock lock(m_mutex);
+    return m_posted.empty() && !m_pending_timers && m_watches.empty() &&
+           !m_expected;
+}
@@ -1,11 +1,28 @@
 #include "TRLIotCoreAdapter.hpp"
 
+// MQTT connection to AWS IOT Core
+#include "TRLAwsMqttTransport.hpp"
+
 TRLIotCoreAdapter::TRLIotCoreAdapter() {}
 
 TRLIotCoreAdapter::~TRLIotCoreAdapter()
 {
-    if (m_connection->Disconnect()) {
-        m_closed_promise.get_future().wait();
+    // finish pending samples while the state cache still exists
+    m_poller.reset();
+    // finish pending commands while the histograms exist, the loops drain
+    // their workflows before the workflow executors go away
+    m_command_loops.clear();
+    // the blocking executors record latencies too, join them as well
+    m_lift_executors.clear();
+    m_door_executors.clear();
+    // the lifts may outlive the histograms
+    if (m_metrics) {
+        for (auto &lift : m_lifts) {
+            lift->SetReconnectHandler(nullptr);
+        }
+    }
+    if (m_transport) {
+        m_transport->Disconnect();
     }
 }
 
@@ -13,6 +30,34 @@ bool TRLIotCoreAdapter::Initialize(
     const std::string &aws_iot_config_file_path,
     const std::string &lift_config_file_path,
     const std::string &doors_config_file_path)
+{
+    try {
+        YAML::Node config = YAML::LoadFile(aws_iot_config_file_path);
+        auto transport = std::make_shared<TRLAwsMqttTransport>();
+        if (!transport->Initialize(config)) {
+            return false;
+        }
+        return Initialize(
+            aws_iot_config_file_path,
+            lift_config_file_path,
+            doors_config_file_path,
+            transport);
+    } catch (const YAML::ParserException &ex) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLIotCoreAdapter::initialize failed YAML error.";
+        return false;
+    } catch (const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLIotCoreAdapter::initialize failed. " << e.what();
+        return false;
+    }
+}
+
+bool TRLIotCoreAdapter::Initialize(
+    const std::string &aws_iot_config_file_path,
+    const std::string &lift_config_file_path,
+    const std::string &doors_config_file_path,
+    std::shared_ptr<TRLMqttTransport> transport)
 {
     try {
         BOOST_LOG_TRIVIAL(info) << "TRLIotCoreAdapter::Initializing";
@@ -25,6 +70,7 @@ bool TRLIotCoreAdapter::Initialize(
             std::shared_ptr<TRLDoorInterface> door =
                 std::make_shared<TRLDoorInterface>();
             door->Initialize(name, door_config[name]);
+            m_door_index[name] = m_doors.size();
             m_doors.push_back(door);
         }
 
@@ -36,14 +82,31 @@ bool TRLIotCoreAdapter::Initialize(
             std::shared_ptr<TRLLiftInterface> lift =
                 std::make_shared<TRLLiftInterface>();
             lift->Initialize(name, lift_config[name]);
+            m_lift_index[name] = m_lifts.size();
             m_lifts.push_back(lift);
         }
+        // one reusable serialization buffer per device
+        m_door_buffers.resize(m_doors.size());
+        m_lift_buffers.resize(m_lifts.size());
+        m_door_pending.reserve(m_doors.size());
+        m_lift_pending.reserve(m_lifts.size());
+        // latest sampled state per device, filled by the poll schedules
+        m_latest.doors.resize(m_doors.size());
+        m_latest.lifts.resize(m_lifts.size());
+        m_door_polling.reset(new std::atomic<bool>[m_doors.size()]());
+        m_lift_polling.reset(new std::atomic<bool>[m_lifts.size()]());
+        for (size_t i = 0; i < m_doors.size(); ++i) {
+            m_door_polling[i] = false;
+            m_all_doors.push_back(i);
+        }
+        for (size_t i = 0; i < m_lifts.size(); ++i) {
+            m_lift_polling[i] = false;
+            m_all_lifts.push_back(i);
+        }
         // load yaml
         YAML::Node config = YAML::LoadFile(aws_iot_config_file_path);
         BOOST_LOG_TRIVIAL(info) << "TRLIotCoreAdapter::Yaml Loaded";
-        if (config["ca_file_path"] && config["cert_path"] &&
-            config["key_path"] && config["client_id"] && config["aws_url"] &&
-            config["lift_state_topic"] && config["lift_command_topic"] &&
+        if (config["lift_state_topic"] && config["lift_command_topic"] &&
             config["door_state_topic"] && config["door_command_topic"]) {
             m_lift_state_topic = config["lift_state_topic"].as<std::string>();
             m_lift_command_topic =
@@ -51,82 +114,175 @@ bool TRLIotCoreAdapter::Initialize(
             m_door_state_topic = config["door_state_topic"].as<std::string>();
             m_door_command_topic =
                 config["door_command_topic"].as<std::string>();
-            std::string cert_path = config["cert_path"].as<std::string>();
-            std::string key_path = config["key_path"].as<std::string>();
-            std::string aws_url = config["aws_url"].as<std::string>();
-            std::string ca_file_path = config["ca_file_path"].as<std::string>();
-            m_internal_client = Aws::Iot::MqttClient();
 
-            if (!m_internal_client) {
-                BOOST_LOG_TRIVIAL(error)
-                    << ("TRLIotCoreAdapter::initialize MQTT Client Creation failed with error %s",
-                        Aws::Crt::ErrorDebugString(
-                            m_internal_client.LastError()));
-                return false;
+            // bounded pool used to sample all devices at the same time
+            size_t poll_workers = std::max<size_t>(
+                1,
+                std::min<size_t>(
+                    m_doors.size() + m_lifts.size(),
+                    DEFAULT_POLL_WORKERS));
+            if (config["poll_workers"]) {
+                poll_workers =
+                    std::max(1, config["poll_workers"].as<int>());
+            }
+            m_poller = std::make_unique<TRLStatePoller>(poll_workers);
+            BOOST_LOG_TRIVIAL(info)
+                << "TRLIotCoreAdapter::Initialize polling devices with "
+                << poll_workers << " workers";
+
+            // only publish changed states, with periodic full keyframes
+            bool publish_on_change = true;
+            int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL;
+            if (config["publish_on_change"]) {
+                publish_on_change = config["publish_on_change"].as<bool>();
+            }
+            if (config["keyframe_interval"]) {
+                keyframe_interval = config["keyframe_interval"].as<int>();
+            }
+            m_delta_filter = std::make_unique<TRLDeltaFilter>(
+                publish_on_change,
+                std::chrono::seconds(keyframe_interval));
+
+            // optionally pack all states of a cycle into one message
+            if (config["batch_publish"]) {
+                m_batch_publish = config["batch_publish"].as<bool>();
+            }
+            if (config["max_payload_size"]) {
+                m_max_payload_size = config["max_payload_size"].as<size_t>();
+            }
+
+            // optional per device command topics, "{name}" is replaced by
+            // the device name, e.g. "building/lift/{name}/command"
+            if (config["lift_device_command_topic"]) {
+                const auto pattern =
+                    config["lift_device_command_topic"].as<std::string>();
+                for (const auto &[name, index] : m_lift_index) {
+                    m_lift_topic_index[DeviceTopic(pattern, name)] = index;
+                }
+            }
+            if (config["door_device_command_topic"]) {
+                const auto pattern =
+                    config["door_device_command_topic"].as<std::string>();
+                for (const auto &[name, index] : m_door_index) {
+                    m_door_topic_index[DeviceTopic(pattern, name)] = index;
+                }
             }
 
-            m_connection = BuildDirectMQTTConnection(
-                m_internal_client,
-                cert_path,
-                key_path,
-                aws_url,
-                ca_file_path);
-
-            auto onConnectionCompleted = [&](Aws::Crt::Mqtt::MqttConnection &,
-                                             int error_code,
-                                             Aws::Crt::Mqtt::ReturnCode
-                                                 return_code,
-                                             bool) {
-                if (error_code) {
+            // optional per device latency histograms, reported on a topic
+            // and/or appended to a local file as one JSON line per device
+            if (config["metrics_topic"]) {
+                m_metrics_topic = config["metrics_topic"].as<std::string>();
+            }
+            if (config["metrics_file"]) {
+                const auto path = config["metrics_file"].as<std::string>();
+                m_metrics_file.open(path, std::ios::app);
+                if (!m_metrics_file) {
                     BOOST_LOG_TRIVIAL(error)
-                        << "TRLIotCoreAdapter::initialize MQTT Client Connection failed with error code: "
-                        << error_code;
-                    return false;
-                } else {
-                    BOOST_LOG_TRIVIAL(info)
-                        << "TRLIotCoreAdapter::initialize Connection completed with return code "
-                        << return_code;
+                        << "TRLIotCoreAdapter::Initialize cannot open "
+                           "metrics file "
+                        << path;
+                }
+            }
+            if (config["metrics_interval"]) {
+                m_metrics_interval = config["metrics_interval"].as<int>();
+            }
+            if ((!m_metrics_topic.empty() || m_metrics_file.is_open()) &&
+                m_metrics_interval > 0) {
+                std::vector<std::string> door_names;
+                std::vector<std::string> lift_names;
+                for (const auto &door : m_doors) {
+                    door_names.push_back(door->GetDoorName());
+                }
+                for (const auto &lift : m_lifts) {
+                    lift_names.push_back(lift->GetName());
                 }
+                m_metrics =
+                    std::make_unique<TRLLatencyMetrics>(door_names, lift_names);
+                // reconnections run on the lift reconnection threads
+                for (size_t i = 0; i < m_lifts.size(); ++i) {
+                    TRLLiftLatencies *latencies = &m_metrics->Lift(i);
+                    m_lifts[i]->SetReconnectHandler(
+                        [latencies](
+                            std::chrono::steady_clock::duration duration,
+                            uint32_t attempts) {
+                            latencies->reconnect.Record(duration);
+                            latencies->reconnect_attempts.RecordValue(
+                                attempts);
+                        });
+                }
+            }
 
+            // commands are executed off the MQTT thread, one queue per device
+            size_t command_queue_size = DEFAULT_COMMAND_QUEUE_SIZE;
+            if (config["command_queue_size"]) {
+                command_queue_size = config["command_queue_size"].as<size_t>();
+            }
+            size_t command_loops = DEFAULT_COMMAND_LOOPS;
+            if (config["command_loops"]) {
+                command_loops = config["command_loops"].as<size_t>();
+            }
+            CreateExecutors(command_queue_size, command_loops);
+
+            // optional journal keeping the states while the connection is
+            // down, replayed at a bounded rate once it is back
+            if (config["journal_path"]) {
+                size_t journal_size = DEFAULT_JOURNAL_SIZE;
+                int replay_rate = DEFAULT_JOURNAL_REPLAY_RATE;
+                if (config["journal_size"]) {
+                    journal_size = config["journal_size"].as<size_t>();
+                }
+                if (config["journal_replay_rate"]) {
+                    replay_rate = config["journal_replay_rate"].as<int>();
+                }
+                m_journal = std::make_unique<TRLStateJournal>();
+                if (!m_journal->Initialize(
+                        config["journal_path"].as<std::string>(),
+                        journal_size)) {
+                    BOOST_LOG_TRIVIAL(error)
+                        << "TRLIotCoreAdapter::Initialize journal "
+                           "initialization failed, continuing without it.";
+                    m_journal.reset();
+                }
+                m_journal_replay_budget = std::max<size_t>(
+                    1,
+                    std::max(0, replay_rate) * JOURNAL_REPLAY_PERIOD_MS /
+                        1000);
+            }
+
+            // every device is polled and published at its own period
+            int scheduler_resolution = DEFAULT_SCHEDULER_RESOLUTION_MS;
+            int schedule_stats_interval = DEFAULT_SCHEDULE_STATS_INTERVAL;
+            if (config["scheduler_resolution_ms"]) {
+                scheduler_resolution =
+                    config["scheduler_resolution_ms"].as<int>();
+            }
+            if (config["schedule_stats_interval"]) {
+                schedule_stats_interval =
+                    config["schedule_stats_interval"].as<int>();
+            }
+            CreateSchedules(
+                door_config,
+                lift_config,
+                std::chrono::milliseconds(scheduler_resolution),
+                std::chrono::seconds(schedule_stats_interval));
+            m_transport = std::move(transport);
+            TRLMqttTransport::Callbacks callbacks;
+            callbacks.on_connected = [this]() {
                 CreateSubscribers();
+                m_delta_filter->ForceKeyframe();
+                m_online = true;
                 m_connected = true;
-                return true;
             };
-
-            auto onInterrupted = [&](Aws::Crt::Mqtt::MqttConnection &,
-                                     int error) {
-                BOOST_LOG_TRIVIAL(error)
-                    << "m_connection::onInterrupted interrupted with error: "
-                    << error;
-            };
-
-            auto onResumed = [&](Aws::Crt::Mqtt::MqttConnection &,
-                                 Aws::Crt::Mqtt::ReturnCode,
-                                 bool) {
-                BOOST_LOG_TRIVIAL(info)
-                    << ("m_connection::onResumedConnection resumed");
-            };
-
-            auto onDisconnect = [&](Aws::Crt::Mqtt::MqttConnection &) {
-                {
-                    BOOST_LOG_TRIVIAL(info)
-                        << ("m_connection::onDisconnect Disconnection completed.");
-                    m_closed_promise.set_value();
+            callbacks.on_interrupted = [this](int) { m_online = false; };
+            callbacks.on_resumed = [this]() {
+                m_online = true;
+                // the journal holds the states published while offline,
+                // without it republish every device
+                if (!m_journal) {
+                    m_delta_filter->ForceKeyframe();
                 }
             };
-            m_connection->OnConnectionCompleted =
-                std::move(onConnectionCompleted);
-            m_connection->OnDisconnect = std::move(onDisconnect);
-            m_connection->OnConnectionInterrupted = std::move(onInterrupted);
-            m_connection->OnConnectionResumed = std::move(onResumed);
-
-            // connecting
-            BOOST_LOG_TRIVIAL(info) << ("TRLIotCoreAdapter::MQTT Connecting..");
-
-            if (!m_connection->Connect(
-                    config["client_id"].as<string>().c_str(),
-                    false /*cleanSession*/,
-                    1000 /*keepAliveTimeSecs*/)) {
+            if (!m_transport->Connect(callbacks)) {
                 BOOST_LOG_TRIVIAL(error)
                     << "TRLIotCoreAdapter::initialize MQTT Connecting Failed.";
                 return false;
@@ -136,7 +292,7 @@ bool TRLIotCoreAdapter::Initialize(
             return true;
         } else {
             BOOST_LOG_TRIVIAL(error)
-                << "TRLIotCoreAdapter:initialize failed. Config file needs to have ca_file_path, cert_path, key_path, client_id, lift_command_topic, lift_state_topic, door_command_topic, door_state_topic, and aws_url.";
+                << "TRLIotCoreAdapter:initialize failed. Config file needs to have lift_command_topic, lift_state_topic, door_command_topic and door_state_topic.";
             return false;
         }
     } catch (const YAML::ParserException &ex) {
@@ -150,192 +306,563 @@ bool TRLIotCoreAdapter::Initialize(
     }
 }
 
-std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>
-TRLIotCoreAdapter::BuildDirectMQTTConnection(
-    Aws::Iot::MqttClient &client,
-    std::string &cert_path,
-    std::string &key_path,
-    std::string &aws_url,
-    std::string &ca_file_path)
+std::string TRLIotCoreAdapter::DeviceTopic(
+    const std::string &pattern,
+    const std::string &name)
 {
-    auto client_config_builder = Aws::Iot::MqttClientConnectionConfigBuilder(
-        cert_path.c_str(),
-        key_path.c_str());
-    client_config_builder.WithEndpoint(aws_url.c_str());
-    client_config_builder.WithCertificateAuthority(ca_file_path.c_str());
-    return GetClientConnectionForMQTTConnection(client, client_config_builder);
+    static const std::string placeholder = "{name}";
+    std::string topic = pattern;
+    for (auto pos = topic.find(placeholder); pos != std::string::npos;
+         pos = topic.find(placeholder, pos + name.size())) {
+        topic.replace(pos, placeholder.size(), name);
+    }
+    return topic;
 }
 
-std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>
-TRLIotCoreAdapter::GetClientConnectionForMQTTConnection(
-    Aws::Iot::MqttClient &client,
-    Aws::Iot::MqttClientConnectionConfigBuilder &client_config_builder)
+void TRLIotCoreAdapter::CreateExecutors(
+    size_t queue_size,
+    size_t command_loops)
 {
-    auto clientConfig = client_config_builder.Build();
-    if (!clientConfig) {
-        BOOST_LOG_TRIVIAL(fatal)
-            << ("TRLIotCoreAdapter::GetClientConnectionForMQTTConnection Client Configuration initialization failed with error %s\n",
-                Aws::Crt::ErrorDebugString(clientConfig.LastError()));
-        exit(-1);
-    }
-
-    auto connection = client.NewConnection(clientConfig);
-    if (!*connection) {
-        BOOST_LOG_TRIVIAL(fatal)
-            << ("TRLIotCoreAdapter::GetClientConnectionForMQTTConnection MQTT Connection Creation failed with error %s\n",
-                Aws::Crt::ErrorDebugString(connection->LastError()));
-        exit(-1);
-    }
-    return connection;
+    if (command_loops) {
+        for (size_t i = 0; i < command_loops; ++i) {
+            m_command_loops.push_back(std::make_unique<TRLEventLoop>(
+                "command_loop_" + std::to_string(i)));
+        }
+        BOOST_LOG_TRIVIAL(info)
+            << "TRLIotCoreAdapter::Initialize running commands on "
+            << command_loops << " event loops";
+    }
+    for (size_t i = 0; i < m_lifts.size(); ++i) {
+        auto lift = m_lifts[i];
+        TRLLiftLatencies *latencies =
+            m_metrics ? &m_metrics->Lift(i) : nullptr;
+        if (command_loops) {
+            TRLEventLoop &loop = *m_command_loops[i % command_loops];
+            m_lift_workflows.push_back(
+                std::make_unique<TRLWorkflowExecutor<TRLLiftCommand>>(
+                    lift->GetName(),
+                    queue_size,
+                    loop,
+                    [lift, latencies](
+                        TRLLiftCommand &command,
+                        TRLWorkflowExecutor<TRLLiftCommand>::Done done) {
+                        lift->SetSessionID(command.session_id);
+                        // the exchange completes on the ADS connection
+                        auto finished = [lift, latencies, command, done](
+                                            bool success,
+                                            LiftCommandStats stats) {
+                            LiftCommandDone(
+                                *lift,
+                                latencies,
+                                command,
+                                success,
+                                stats);
+                            done();
+                        };
+                        if (command.request_type == 1) {
+                            lift->CommandLiftAsync(
+                                command.destination_floor,
+                                finished);
+                        } else {
+                            lift->EndLiftAsync(finished);
+                        }
+                    }));
+            continue;
+        }
+        m_lift_executors.push_back(
+            std::make_unique<TRLDeviceExecutor<TRLLiftCommand>>(
+                lift->GetName(),
+                queue_size,
+                [lift, latencies](TRLLiftCommand &command) {
+                    lift->SetSessionID(command.session_id);
+                    bool success = false;
+                    LiftCommandStats stats;
+                    if (command.request_type == 1) {
+                        success = lift->CommandLift(
+                            command.destination_floor,
+                            &stats);
+                    } else {
+                        success = lift->EndLift(&stats);
+                    }
+                    LiftCommandDone(*lift, latencies, command, success, stats);
+                }));
+    }
+    for (size_t i = 0; i < m_doors.size(); ++i) {
+        auto door = m_doors[i];
+        TRLLatencyHistogram *latency =
+            m_metrics ? &m_metrics->Door(i).command : nullptr;
+        if (command_loops) {
+            TRLEventLoop *loop = m_command_loops[i % command_loops].get();
+            TRLDoorAsyncIO io;
+            io.wait_readable = [loop](
+                                   int fd,
+                                   std::chrono::milliseconds timeout,
+                                   std::function<void(bool)> handler) {
+                loop->WhenReadable(fd, timeout, std::move(handler));
+            };
+            io.after = [loop](
+                           std::chrono::milliseconds delay,
+                           std::function<void()> task) {
+                loop->After(delay, std::move(task));
+            };
+            m_door_workflows.push_back(
+                std::make_unique<TRLWorkflowExecutor<TRLDoorCommand>>(
+                    door->GetDoorName(),
+                    queue_size,
+                    *loop,
+                    [door, latency, io](
+                        TRLDoorCommand &command,
+                        TRLWorkflowExecutor<TRLDoorCommand>::Done done) {
+                        door->ActuateDoorAsync(
+                            command.open,
+                            io,
+                            [door, latency, command, done](bool success) {
+                                DoorCommandDone(
+                                    *door,
+                                    latency,
+                                    command,
+                                    success);
+                                done();
+                            });
+                    }));
+            continue;
+        }
+        m_door_executors.push_back(
+            std::make_unique<TRLDeviceExecutor<TRLDoorCommand>>(
+                door->GetDoorName(),
+                queue_size,
+                [door, latency](TRLDoorCommand &command) {
+                    DoorCommandDone(
+                        *door,
+                        latency,
+                        command,
+                        door->ActuateDoor(command.open));
+                }));
+    }
+}
+
+void TRLIotCoreAdapter::LiftCommandDone(
+    const TRLLiftInterface &lift,
+    TRLLiftLatencies *latencies,
+    const TRLLiftCommand &command,
+    bool success,
+    const LiftCommandStats &stats)
+{
+    if (success && latencies) {
+        latencies->command.RecordSince(command.received);
+        latencies->command_exchange.Record(stats.exchange);
+        if (stats.plc_cycles) {
+            latencies->command_plc_cycles.RecordValue(*stats.plc_cycles);
+        }
+    }
+    if (!success) {
+        BOOST_LOG_TRIVIAL(warning)
+            << lift.GetName() << "| TRLIotCoreAdapter lift command of type "
+            << command.request_type << " failed.";
+    }
+}
+
+void TRLIotCoreAdapter::DoorCommandDone(
+    const TRLDoorInterface &door,
+    TRLLatencyHistogram *latency,
+    const TRLDoorCommand &command,
+    bool success)
+{
+    if (success) {
+        if (latency) {
+            latency->RecordSince(command.received);
+        }
+    } else {
+        BOOST_LOG_TRIVIAL(warning)
+            << door.GetDoorName() << "| TRLIotCoreAdapter door command failed.";
+    }
 }
 
 void TRLIotCoreAdapter::CreateSubscribers()
 {
-    auto onMultiSubAck = [&](Aws::Crt::Mqtt::MqttConnection &,
-                             uint16_t packet_id,
-                             const Aws::Crt::Vector<Aws::Crt::String> &topics,
-                             Aws::Crt::Mqtt::QOS qos,
-                             int error_code) {
-        if (error_code) {
-            BOOST_LOG_TRIVIAL(error)
-                << "m_connection::Subscribe::onSubAck MQTT Subscribe Connection failed with error code: "
-                << error_code;
-            return false;
-        } else {
-            if (!packet_id || qos == AWS_MQTT_QOS_FAILURE) {
-                BOOST_LOG_TRIVIAL(error)
-                    << "m_connection::Subscribe::onSubAck Subscriber rejected by the broker.";
-                return false;
-            } else {
-                for (auto x : topics) {
-                    BOOST_LOG_TRIVIAL(info)
-                        << "m_connection::Subscribe::onSubAck Subscribe on topic "
-                        << x.c_str() << " on packet id " << packet_id
-                        << " succeeded";
+    TRLMqttTransport::MessageHandler lift_handler =
+        [this](const std::string &topic, const std::string &payload) {
+            LiftCommandReceiveCallback(topic, payload);
+        };
+    TRLMqttTransport::MessageHandler door_handler =
+        [this](const std::string &topic, const std::string &payload) {
+            DoorCommandReceiveCallback(topic, payload);
+        };
+
+    std::vector<std::pair<std::string, TRLMqttTransport::MessageHandler>>
+        subscriptions;
+
+    // either one topic per device or the shared topic of all devices
+    if (m_lift_topic_index.empty()) {
+        subscriptions.emplace_back(m_lift_command_topic, lift_handler);
+    }
+    for (const auto &[topic, index] : m_lift_topic_index) {
+        subscriptions.emplace_back(topic, lift_handler);
+    }
+    if (m_door_topic_index.empty()) {
+        subscriptions.emplace_back(m_door_command_topic, door_handler);
+    }
+    for (const auto &[topic, index] : m_door_topic_index) {
+        subscriptions.emplace_back(topic, door_handler);
+    }
+
+    if (!m_transport->Subscribe(subscriptions)) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLIotCoreAdapter::CreateSubscribers subscribing failed.";
+    }
+}
+
+void TRLIotCoreAdapter::CreateSchedules(
+    const YAML::Node &door_config,
+    const YAML::Node &lift_config,
+    std::chrono::milliseconds resolution,
+    std::chrono::seconds stats_interval)
+{
+    m_scheduler = std::make_unique<TRLScheduler>(resolution, stats_interval);
+    // devices with the same publish period are published together
+    std::map<int, PublishGroup> groups;
+
+    for (size_t i = 0; i < m_doors.size(); ++i) {
+        const std::string &name = m_doors[i]->GetDoorName();
+        const YAML::Node node = door_config[name];
+        int poll_period = DEFAULT_POLL_PERIOD_MS;
+        int publish_period = DEFAULT_PUBLISH_PERIOD_MS;
+        if (node["poll_period_ms"]) {
+            poll_period = node["poll_period_ms"].as<int>();
+        }
+        if (node["publish_period_ms"]) {
+            publish_period = node["publish_period_ms"].as<int>();
+        }
+        m_scheduler->Add(
+            name + "/poll",
+            std::chrono::milliseconds(poll_period),
+            [this, i]() { return PollDoor(i); });
+        groups[publish_period].doors.push_back(i);
+    }
+
+    for (size_t i = 0; i < m_lifts.size(); ++i) {
+        const std::string &name = m_lifts[i]->GetName();
+        const YAML::Node node = lift_config[name];
+        int poll_period = DEFAULT_POLL_PERIOD_MS;
+        int publish_period = DEFAULT_PUBLISH_PERIOD_MS;
+        if (node["poll_period_ms"]) {
+            poll_period = node["poll_period_ms"].as<int>();
+        }
+        if (node["publish_period_ms"]) {
+            publish_period = node["publish_period_ms"].as<int>();
+        }
+        m_scheduler->Add(
+            name + "/poll",
+            std::chrono::milliseconds(poll_period),
+            [this, i]() { return PollLift(i); });
+        groups[publish_period].lifts.push_back(i);
+    }
+
+    // the groups are captured by index, m_publish_groups does not change
+    // once the schedules exist
+    for (auto &[period, group] : groups) {
+        m_publish_groups.push_back(std::move(group));
+    }
+    size_t index = 0;
+    for (const auto &[period, group] : groups) {
+        m_scheduler->Add(
+            "publish/" + std::to_string(period) + "ms",
+            std::chrono::milliseconds(period),
+            [this, index]() {
+                if (m_connected) {
+                    PublishDevices(
+                        m_publish_groups[index].doors,
+                        m_publish_groups[index].lifts);
                 }
                 return true;
-            }
-        }
-    };
+            });
+        index++;
+    }
 
-    std::pair<const char *, Aws::Crt::Mqtt::OnMessageReceivedHandler>
-        lift_subscription, door_subscription;
+    if (m_metrics) {
+        m_scheduler->Add(
+            "metrics",
+            std::chrono::seconds(m_metrics_interval),
+            [this]() {
+                EmitMetrics();
+                return true;
+            });
+    }
 
-    Aws::Crt::Vector<
-        std::pair<const char *, Aws::Crt::Mqtt::OnMessageReceivedHandler>>
-        subscriptions;
+    if (m_journal) {
+        m_scheduler->Add(
+            "journal/replay",
+            std::chrono::milliseconds(JOURNAL_REPLAY_PERIOD_MS),
+            [this]() {
+                ReplayJournal();
+                return true;
+            });
+    }
+}
 
-    lift_subscription.first = m_lift_command_topic.c_str();
-    lift_subscription.second = std::bind(
-        &TRLIotCoreAdapter::LiftCommandReceiveCallback,
-        this,
-        std::placeholders::_1,
-        std::placeholders::_2,
-        std::placeholders::_3,
-        std::placeholders::_4,
-        std::placeholders::_5,
-        std::placeholders::_6);
-
-    door_subscription.first = m_door_command_topic.c_str();
-    door_subscription.second = std::bind(
-        &TRLIotCoreAdapter::DoorCommandReceiveCallback,
-        this,
-        std::placeholders::_1,
-        std::placeholders::_2,
-        std::placeholders::_3,
-        std::placeholders::_4,
-        std::placeholders::_5,
-        std::placeholders::_6);
-
-    subscriptions.push_back(lift_subscription);
-    subscriptions.push_back(door_subscription);
-
-    m_connection->Subscribe(
-        subscriptions,
-        AWS_MQTT_QOS_AT_LEAST_ONCE,
-        onMultiSubAck);
+void TRLIotCoreAdapter::Run(const std::function<bool()> &keep_running)
+{
+    m_scheduler->Run(keep_running);
+}
+
+std::vector<TRLScheduleStats> TRLIotCoreAdapter::ScheduleStats() const
+{
+    return m_scheduler->Stats();
+}
+
+bool TRLIotCoreAdapter::PollDoor(size_t index)
+{
+    if (m_door_polling[index].exchange(true)) {
+        return false;
+    }
+    m_poller->Submit([this, index]() {
+        TRLDoorState state = TRLStatePoller::SampleDoor(
+            *m_doors[index],
+            TRLStatePoller::SampleTime(),
+            m_metrics ? &m_metrics->Door(index) : nullptr);
+        {
+            std::scoped_lock lock(m_latest_mutex);
+            m_latest.doors[index] = std::move(state);
+        }
+        m_door_polling[index] = false;
+    });
+    return true;
+}
+
+bool TRLIotCoreAdapter::PollLift(size_t index)
+{
+    if (m_lift_polling[index].exchange(true)) {
+        return false;
+    }
+    m_poller->Submit([this, index]() {
+        TRLLiftState state = TRLStatePoller::SampleLift(
+            *m_lifts[index],
+            TRLStatePoller::SampleTime(),
+            m_metrics ? &m_metrics->Lift(index) : nullptr);
+        {
+            std::scoped_lock lock(m_latest_mutex);
+            m_latest.lifts[index] = std::move(state);
+        }
+        m_lift_polling[index] = false;
+    });
+    return true;
 }
 
 void TRLIotCoreAdapter::PublishState()
 {
-    std::scoped_lock lock(m_mutex);
     try {
-        auto onPublishComplete =
-            [](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int) {};
-        // publish state for all the doors
-        for (auto x : m_doors) {
-            nlohmann::json door_state;
-            const auto p1 = std::chrono::system_clock::now();
-            int time = std::chrono::duration_cast<std::chrono::seconds>(
-                           p1.time_since_epoch())
-                           .count();
-            door_state["door_time"] = time;
-            door_state["door_name"] = x->GetDoorName();
-            door_state["current_mode"] = x->GetDoorState();
-            Aws::Crt::String message(
-                door_state.dump().c_str(),
-                door_state.dump().size());
-            Aws::Crt::ByteBuf payload = Aws::Crt::ByteBufFromArray(
-                (const uint8_t *)message.data(),
-                message.length());
-            m_connection->Publish(
-                m_door_state_topic.c_str(),
-                AWS_MQTT_QOS_AT_LEAST_ONCE,
-                false,
-                payload,
-                onPublishComplete);
-        }
-        // publish state for all the lifts
-        for (auto x : m_lifts) {
-            nlohmann::json lift_state;
-            const auto p1 = std::chrono::system_clock::now();
-            int time = std::chrono::duration_cast<std::chrono::seconds>(
-                           p1.time_since_epoch())
-                           .count();
-            lift_state["lift_time"] = time;
-            lift_state["lift_name"] = x->GetName();
-            lift_state["available_floors"] = x->AvailableFloors();
-            ;
-            lift_state["currrent_floor"] = x->CurrentFloor().value_or("0");
-            lift_state["destination_floor"] =
-                x->DestinationFloor().value_or("0");
-            lift_state["door_state"] = x->LiftDoorState();
-            lift_state["motion_state"] = x->LiftMotionState();
-            lift_state["available_modes"] = x->AvailableModes();
-            lift_state["lift_mode"] = x->CurrentMode();
-            lift_state["session_id"] = x->GetSessionID();
-            Aws::Crt::String message(
-                lift_state.dump().c_str(),
-                lift_state.dump().size());
-            Aws::Crt::ByteBuf payload = Aws::Crt::ByteBufFromArray(
-                (const uint8_t *)message.data(),
-                message.length());
-            m_connection->Publish(
-                m_lift_state_topic.c_str(),
-                AWS_MQTT_QOS_AT_LEAST_ONCE,
-                false,
-                payload,
-                onPublishComplete);
+        // sample every device concurrently before publishing anything
+        TRLFleetState fleet = m_poller->Poll(m_doors, m_lifts);
+        {
+            std::scoped_lock lock(m_latest_mutex);
+            m_latest = std::move(fleet);
         }
+        PublishDevices(m_all_doors, m_all_lifts);
     } catch (const std::exception &e) {
         BOOST_LOG_TRIVIAL(error)
             << "TRLIotCoreAdapter::PublishState failed. " << e.what();
     }
 }
 
-void TRLIotCoreAdapter::LiftCommandReceiveCallback(
-    Aws::Crt::Mqtt::MqttConnection &,
-    const Aws::Crt::String &topic,
-    const Aws::Crt::ByteBuf &byte_buf,
-    bool /*dup*/,
-    Aws::Crt::Mqtt::QOS /*qos*/,
-    bool /*retain*/)
+void TRLIotCoreAdapter::EmitMetrics()
+{
+    std::vector<std::string> messages;
+    m_metrics->Report(TRLStatePoller::SampleTime(), messages);
+    for (const auto &message : messages) {
+        if (m_metrics_file.is_open()) {
+            m_metrics_file << message << '\n';
+        }
+        if (!m_metrics_topic.empty() && m_online) {
+            Publish(m_metrics_topic, message);
+        }
+    }
+    m_metrics_file.flush();
+}
+
+void TRLIotCoreAdapter::ReplayJournal()
+{
+    std::scoped_lock lock(m_mutex);
+    if (!m_online || m_journal->Empty()) {
+        return;
+    }
+    const size_t replayed = m_journal->Replay(
+        m_journal_replay_budget,
+        [this](const std::string &topic, const std::string &payload) {
+            return m_online && m_transport->Publish(topic, payload, nullptr);
+        });
+    if (replayed && m_journal->Empty()) {
+        BOOST_LOG_TRIVIAL(info)
+            << "TRLIotCoreAdapter::ReplayJournal journal replayed, "
+            << m_journal->Dropped() << " messages were dropped while offline.";
+    }
+}
+
+void TRLIotCoreAdapter::PublishDevices(
+    const std::vector<size_t> &doors,
+    const std::vector<size_t> &lifts)
 {
     std::scoped_lock lock(m_mutex);
+    try {
+        const auto now = TRLDeltaFilter::Clock::now();
+        m_door_pending.clear();
+        m_lift_pending.clear();
+        {
+            std::scoped_lock latest_lock(m_latest_mutex);
+            // serialize state for the doors into their reusable buffers,
+            // doors that were not sampled yet have no name
+            for (const auto i : doors) {
+                const TRLDoorState &state = m_latest.doors[i];
+                if (state.door_name.empty() ||
+                    !m_delta_filter->ShouldPublish(state, now)) {
+                    continue;
+                }
+                m_door_buffers[i].clear();
+                TRLStateSerializer::Serialize(state, m_door_buffers[i]);
+                m_door_pending.push_back(i);
+            }
+            // serialize state for the lifts into their reusable buffers
+            for (const auto i : lifts) {
+                const TRLLiftState &state = m_latest.lifts[i];
+                if (state.lift_name.empty() ||
+                    !m_delta_filter->ShouldPublish(state, now)) {
+                    continue;
+                }
+                m_lift_buffers[i].clear();
+                TRLStateSerializer::Serialize(state, m_lift_buffers[i]);
+                m_lift_pending.push_back(i);
+            }
+        }
+        // newer states queue behind the journaled ones to keep their order
+        if (m_journal && (!m_online || !m_journal->Empty())) {
+            for (const auto i : m_door_pending) {
+                m_journal->Append(
+                    m_door_state_topic,
+                    m_doors[i]->GetDoorName(),
+                    m_door_buffers[i]);
+            }
+            for (const auto i : m_lift_pending) {
+                m_journal->Append(
+                    m_lift_state_topic,
+                    m_lifts[i]->GetName(),
+                    m_lift_buffers[i]);
+            }
+            return;
+        }
+        // a state that was not queued is published again next cycle
+        PublishMessages(
+            m_door_state_topic,
+            m_door_buffers,
+            m_door_pending,
+            m_metrics ? &m_metrics->DoorPublish() : nullptr,
+            m_failed);
+        for (const auto i : m_failed) {
+            m_delta_filter->ForgetDoor(m_doors[i]->GetDoorName());
+        }
+        PublishMessages(
+            m_lift_state_topic,
+            m_lift_buffers,
+            m_lift_pending,
+            m_metrics ? &m_metrics->LiftPublish() : nullptr,
+            m_failed);
+        for (const auto i : m_failed) {
+            m_delta_filter->ForgetLift(m_lifts[i]->GetName());
+        }
+    } catch (const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLIotCoreAdapter::PublishDevices failed. " << e.what();
+    }
+}
+
+void TRLIotCoreAdapter::PublishMessages(
+    const std::string &topic,
+    const std::vector<std::string> &buffers,
+    const std::vector<size_t> &pending,
+    TRLPublishLatencies *latencies,
+    std::vector<size_t> &failed)
+{
+    failed.clear();
+    if (!m_batch_publish) {
+        for (const auto i : pending) {
+            if (!Publish(
+                    topic,
+                    buffers[i],
+                    latencies ? latencies->devices[i] : nullptr)) {
+                failed.push_back(i);
+            }
+        }
+        return;
+    }
+    TRLLatencyHistogram *batch_latency =
+        latencies ? &latencies->batch : nullptr;
+
+    // pack the messages into JSON arrays of at most m_max_payload_size bytes
+    std::string &batch = m_batch_buffer;
+    batch.clear();
+    size_t first = 0;  // index in pending of the first state of the batch
+    for (size_t p = 0; p < pending.size(); ++p) {
+        const size_t i = pending[p];
+        const std::string &message = buffers[i];
+        if (!batch.empty() &&
+            batch.size() + message.size() + 2 > m_max_payload_size) {
+            batch += ']';
+            if (!Publish(topic, batch, batch_latency)) {
+                failed.insert(
+                    failed.end(),
+                    pending.begin() + first,
+                    pending.begin() + p);
+            }
+            batch.clear();
+            first = p;
+        }
+        if (batch.empty()) {
+            if (message.size() + 2 > m_max_payload_size) {
+                BOOST_LOG_TRIVIAL(warning)
+                    << "TRLIotCoreAdapter::PublishMessages state of "
+                    << message.size()
+                    << " bytes exceeds max_payload_size, sending it alone.";
+            }
+            batch += '[';
+        } else {
+            batch += ',';
+        }
+        batch += message;
+    }
+    if (!batch.empty()) {
+        batch += ']';
+        if (!Publish(topic, batch, batch_latency)) {
+            failed.insert(failed.end(), pending.begin() + first, pending.end());
+        }
+    }
+}
+
+bool TRLIotCoreAdapter::Publish(
+    const std::string &topic,
+    const std::string &message,
+    TRLLatencyHistogram *latency)
+{
+    if (!latency) {
+        return m_transport->Publish(topic, message, nullptr);
+    }
+    // the capture fits the small buffer of std::function
+    const auto start = TRLLatencyHistogram::Clock::now();
+    return m_transport->Publish(
+        topic,
+        message,
+        [latency, start](int error_code) {
+            if (!error_code) {
+                latency->RecordSince(start);
+            }
+        });
+}
+
+void TRLIotCoreAdapter::LiftCommandReceiveCallback(
+    const std::string &topic,
+    const std::string &payload)
+{
+    const auto received = std::chrono::steady_clock::now();
     BOOST_LOG_TRIVIAL(info) << "Received lift command topic\n";
     try {
-        std::string s(byte_buf.buffer, byte_buf.buffer + byte_buf.len);
-        nlohmann::json received_data = nlohmann::json::parse(s);
+        nlohmann::json received_data = nlohmann::json::parse(payload);
 
         // check if all fields are present
         if (received_data["lift_name"].empty() ||
@@ -351,18 +878,39 @@ void TRLIotCoreAdapter::LiftCommandReceiveCallback(
                        std::chrono::system_clock::now().time_since_epoch())
                        .count();
 
-        for (auto x : m_lifts) {
-            if (received_data["lift_name"] == x->GetName() &&
-                received_data["request_time"] <= time) {
-                x->SetSessionID(received_data["session_id"]);
-                if (received_data["request_type"] == 0 ||
-                    received_data["request_type"] == 2) {
-                    x->EndLift();
-                } else if (received_data["request_type"] == 1) {
-                    x->CommandLift(
-                        to_string(received_data["destination_floor"]));
-                }
-            }
+        if (received_data["request_time"] > time) {
+            return;
+        }
+
+        // the executor runs the ADS writes, this thread only queues them
+        TRLLiftCommand command;
+        command.received = received;
+        command.request_type = received_data["request_type"].get<int>();
+        command.destination_floor =
+            to_string(received_data["destination_floor"]);
+        command.session_id = received_data["session_id"].get<std::string>();
+        if (command.request_type < 0 || command.request_type > 2) {
+            return;
+        }
+        const auto lift = m_lift_index.find(
+            received_data["lift_name"].get<std::string>());
+        if (lift == m_lift_index.end()) {
+            return;
+        }
+        // a per device topic only accepts commands for its own device
+        const auto device_topic = m_lift_topic_index.find(topic);
+        if (device_topic != m_lift_topic_index.end() &&
+            device_topic->second != lift->second) {
+            BOOST_LOG_TRIVIAL(warning)
+                << "TRLIotCoreAdapter::LiftCommandReceiveCallback lift_name "
+                   "does not match topic "
+                << topic;
+            return;
+        }
+        if (m_lift_workflows.empty()) {
+            m_lift_executors[lift->second]->Post(std::move(command));
+        } else {
+            m_lift_workflows[lift->second]->Post(std::move(command));
         }
 
     } catch (nlohmann::detail::parse_error ex) {
@@ -376,19 +924,14 @@ void TRLIotCoreAdapter::LiftCommandReceiveCallback(
 }
 
 void TRLIotCoreAdapter::DoorCommandReceiveCallback(
-    Aws::Crt::Mqtt::MqttConnection &,
-    const Aws::Crt::String &topic,
-    const Aws::Crt::ByteBuf &byte_buf,
-    bool /*dup*/,
-    Aws::Crt::Mqtt::QOS /*qos*/,
-    bool /*retain*/)
+    const std::string &topic,
+    const std::string &payload)
 {
-    std::scoped_lock lock(m_mutex);
+    const auto received = std::chrono::steady_clock::now();
     BOOST_LOG_TRIVIAL(info) << "Received door command topic\n";
 
     try {
-        std::string s(byte_buf.buffer, byte_buf.buffer + byte_buf.len);
-        nlohmann::json received_data = nlohmann::json::parse(s);
+        nlohmann::json received_data = nlohmann::json::parse(payload);
 
         // check if all fields are present
         if (received_data["door_name"].empty() ||
@@ -402,15 +945,39 @@ void TRLIotCoreAdapter::DoorCommandReceiveCallback(
                        std::chrono::system_clock::now().time_since_epoch())
                        .count();
 
-        for (auto x : m_doors) {
-            if (received_data["door_name"] == x->GetDoorName() &&
-                received_data["request_time"] <= time) {
-                if (received_data["requested_mode"] == 0) {
-                    x->ActuateDoor(false);
-                } else if (received_data["requested_mode"] == 2) {
-                    x->ActuateDoor(true);
-                }
-            }
+        if (received_data["request_time"] > time) {
+            return;
+        }
+
+        // the executor runs the Modbus writes, this thread only queues them
+        TRLDoorCommand command;
+        command.received = received;
+        if (received_data["requested_mode"] == 0) {
+            command.open = false;
+        } else if (received_data["requested_mode"] == 2) {
+            command.open = true;
+        } else {
+            return;
+        }
+        const auto door = m_door_index.find(
+            received_data["door_name"].get<std::string>());
+        if (door == m_door_index.end()) {
+            return;
+        }
+        // a per device topic only accepts commands for its own device
+        const auto device_topic = m_door_topic_index.find(topic);
+        if (device_topic != m_door_topic_index.end() &&
+            device_topic->second != door->second) {
+            BOOST_LOG_TRIVIAL(warning)
+                << "TRLIotCoreAdapter::DoorCommandReceiveCallback door_name "
+                   "does not match topic "
+                << topic;
+            return;
+        }
+        if (m_door_workflows.empty()) {
+            m_door_executors[door->second]->Post(std::move(command));
+        } else {
+            m_door_workflows[door->second]->Post(std::move(command));
         }
 
     } catch (nlohmann::detail::parse_error ex) {
@@ -427,3 +994,15 @@ const bool &TRLIotCoreAdapter::ConnectionCompleted() const
 {
     return m_connected;
 }
+
+std::map<std::string, TRLPublishCounters>
+TRLIotCoreAdapter::DoorPublishCounters() const
+{
+    return m_delta_filter->DoorCounters();
+}
+
+std::map<std::string, TRLPublishCounters>
+TRLIotCoreAdapter::LiftPublishCounters() const
+{
+    return m_delta_filter->LiftCounters();
+}
\ No newline at end of file
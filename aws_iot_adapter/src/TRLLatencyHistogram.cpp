@@ -0,0 +1,57 @@
+#include "TRLLatencyHistogram.hpp"
+
+#include <algorithm>
+
+TRLLatencySummary TRLLatencyHistogram::TakeSummary()
+{
+    std::array<uint64_t, kBuckets> counts;
+    TRLLatencySummary summary;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        counts[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+        summary.count += counts[i];
+    }
+    const uint64_t sum = m_sum.exchange(0, std::memory_order_relaxed);
+    summary.max = m_max.exchange(0, std::memory_order_relaxed);
+    if (!summary.count) {
+        return summary;
+    }
+    summary.mean = sum / summary.count;
+
+    // the percentiles are the upper bounds of the buckets they fall into
+    const uint64_t p50_rank = (summary.count * 500 + 999) / 1000;
+    const uint64_t p99_rank = (summary.count * 990 + 999) / 1000;
+    const uint64_t p999_rank = (summary.count * 999 + 999) / 1000;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        if (!counts[i]) {
+            continue;
+        }
+        const uint64_t before = seen;
+        seen += counts[i];
+        const uint64_t value = BucketValue(i);
+        if (before < p50_rank && seen >= p50_rank) {
+            summary.p50 = value;
+        }
+        if (before < p99_rank && seen >= p99_rank) {
+            summary.p99 = value;
+        }
+        if (before < p999_rank && seen >= p999_rank) {
+            summary.p999 = value;
+        }
+    }
+    // a bucket bound can exceed the largest value recorded in it
+    summary.p50 = std::min(summary.p50, summary.max);
+    summary.p99 = std::min(summary.p99, summary.max);
+    summary.p999 = std::min(summary.p999, summary.max);
+    return summary;
+}
+
+uint64_t TRLLatencyHistogram::BucketValue(size_t index)
+{
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const unsigned shift = index / kSubBuckets - 1;
+    const uint64_t sub = index % kSubBuckets + kSubBuckets;
+    return ((sub + 1) << shift) - 1;
+}
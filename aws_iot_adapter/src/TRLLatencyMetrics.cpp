@@ -0,0 +1,102 @@
+#include "TRLLatencyMetrics.hpp"
+
+TRLLatencyMetrics::TRLLatencyMetrics(
+    const std::vector<std::string> &door_names,
+    const std::vector<std::string> &lift_names)
+    : m_door_names(door_names), m_lift_names(lift_names)
+{
+    for (size_t i = 0; i < m_door_names.size(); ++i) {
+        m_doors.push_back(std::make_unique<TRLDoorLatencies>());
+        m_door_publish.devices.push_back(&m_doors.back()->publish);
+    }
+    for (size_t i = 0; i < m_lift_names.size(); ++i) {
+        m_lifts.push_back(std::make_unique<TRLLiftLatencies>());
+        m_lift_publish.devices.push_back(&m_lifts.back()->publish);
+    }
+}
+
+TRLDoorLatencies &TRLLatencyMetrics::Door(size_t index)
+{
+    return *m_doors[index];
+}
+
+TRLLiftLatencies &TRLLatencyMetrics::Lift(size_t index)
+{
+    return *m_lifts[index];
+}
+
+TRLPublishLatencies &TRLLatencyMetrics::DoorPublish()
+{
+    return m_door_publish;
+}
+
+TRLPublishLatencies &TRLLatencyMetrics::LiftPublish()
+{
+    return m_lift_publish;
+}
+
+void TRLLatencyMetrics::Report(int time, std::vector<std::string> &messages)
+{
+    // latencies in microseconds, histograms without samples are left out
+    auto add = [](nlohmann::json &message,
+                  const char *name,
+                  TRLLatencyHistogram &histogram) {
+        const TRLLatencySummary summary = histogram.TakeSummary();
+        if (summary.count) {
+            message[name] = ToJson(summary);
+        }
+    };
+    auto emit = [&](nlohmann::json &message) {
+        if (message.size() > 3) {
+            messages.push_back(message.dump());
+        }
+    };
+
+    for (size_t i = 0; i < m_doors.size(); ++i) {
+        nlohmann::json message;
+        message["door_name"] = m_door_names[i];
+        message["metrics_time"] = time;
+        message["unit"] = "us";
+        add(message, "door_state", m_doors[i]->door_state);
+        add(message, "publish", m_doors[i]->publish);
+        add(message, "command", m_doors[i]->command);
+        emit(message);
+    }
+    for (size_t i = 0; i < m_lifts.size(); ++i) {
+        nlohmann::json message;
+        message["lift_name"] = m_lift_names[i];
+        message["metrics_time"] = time;
+        message["unit"] = "us";
+        add(message, "snapshot", m_lifts[i]->snapshot);
+        add(message, "publish", m_lifts[i]->publish);
+        add(message, "command", m_lifts[i]->command);
+        add(message, "command_exchange", m_lifts[i]->command_exchange);
+        // counted in PLC cycles, not in microseconds
+        add(message, "command_plc_cycles", m_lifts[i]->command_plc_cycles);
+        add(message, "reconnect", m_lifts[i]->reconnect);
+        // counted in attempts, not in microseconds
+        add(message, "reconnect_attempts", m_lifts[i]->reconnect_attempts);
+        emit(message);
+    }
+
+    nlohmann::json batches;
+    batches["metrics_time"] = time;
+    batches["unit"] = "us";
+    add(batches, "door_batch_publish", m_door_publish.batch);
+    add(batches, "lift_batch_publish", m_lift_publish.batch);
+    if (batches.size() > 2) {
+        messages.push_back(batches.dump());
+    }
+}
+
+nlohmann::json TRLLatencyMetrics::ToJson(const TRLLatencySummary &summary)
+{
+    nlohmann::json json;
+    json["count"] = summary.count;
+    json["mean"] = summary.mean;
+    json["p50"] = summary.p50;
+    json["p99"] = summary.p99;
+    json["p999"] = summary.p999;
+    json["max"] = summary.max;
+    return json;
+}
@@ -0,0 +1,120 @@
+#include "TRLScheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+TRLScheduler::TRLScheduler(
+    std::chrono::milliseconds resolution,
+    std::chrono::seconds stats_interval)
+    : m_resolution(std::max(resolution, std::chrono::milliseconds(1))),
+      m_stats_interval(stats_interval)
+{
+}
+
+void TRLScheduler::Add(
+    const std::string &name,
+    std::chrono::milliseconds period,
+    Task task)
+{
+    Schedule schedule;
+    schedule.period = std::max<Clock::duration>(period, m_resolution);
+    schedule.task = std::move(task);
+    m_schedules.push_back(std::move(schedule));
+
+    TRLScheduleStats stats;
+    stats.name = name;
+    stats.period = std::chrono::duration_cast<std::chrono::milliseconds>(
+        m_schedules.back().period);
+    std::scoped_lock lock(m_stats_mutex);
+    m_stats.push_back(stats);
+}
+
+void TRLScheduler::Run(const std::function<bool()> &keep_running)
+{
+    m_start = Clock::now();
+    for (size_t id = 0; id < m_schedules.size(); ++id) {
+        m_schedules[id].deadline = m_start;
+        m_wheel.Insert(id, 0);
+    }
+    m_due.reserve(m_schedules.size());
+    auto next_stats = m_start + m_stats_interval;
+
+    while (keep_running()) {
+        const auto now = Clock::now();
+        m_due.clear();
+        m_wheel.Advance((now - m_start) / m_resolution, m_due);
+        for (const auto id : m_due) {
+            Fire(id);
+        }
+        if (m_stats_interval.count() && now >= next_stats) {
+            LogStats();
+            next_stats += m_stats_interval;
+        }
+        // sleep until the next tick that can expire a timer
+        const auto wake = std::min<Clock::time_point>(
+            m_start + m_resolution * static_cast<Clock::rep>(
+                                         m_wheel.NextTick()),
+            Clock::now() + std::chrono::milliseconds(100));
+        std::this_thread::sleep_until(wake);
+    }
+}
+
+std::vector<TRLScheduleStats> TRLScheduler::Stats() const
+{
+    std::scoped_lock lock(m_stats_mutex);
+    return m_stats;
+}
+
+void TRLScheduler::LogStats() const
+{
+    for (const auto &stats : Stats()) {
+        BOOST_LOG_TRIVIAL(info)
+            << stats.name << "| TRLScheduler period " << stats.period.count()
+            << "ms runs " << stats.runs << " overruns " << stats.overruns
+            << " jitter mean " << stats.mean_jitter.count() << "us max "
+            << stats.max_jitter.count() << "us";
+    }
+}
+
+void TRLScheduler::Fire(size_t id)
+{
+    Schedule &schedule = m_schedules[id];
+    const auto delay =
+        std::max(Clock::now() - schedule.deadline, Clock::duration::zero());
+    // periods that passed completely before this run started
+    const uint64_t missed = delay / schedule.period;
+
+    bool ran = false;
+    try {
+        ran = schedule.task();
+    } catch (const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLScheduler::Fire task " << id << " failed. " << e.what();
+    }
+
+    // keep the phase of the schedule, skip the deadlines already missed
+    schedule.deadline +=
+        schedule.period * static_cast<Clock::rep>(missed + 1);
+    m_wheel.Insert(id, ToTick(schedule.deadline));
+    schedule.jitter_sum += delay;
+    schedule.fires++;
+
+    std::scoped_lock lock(m_stats_mutex);
+    TRLScheduleStats &stats = m_stats[id];
+    stats.overruns += missed + (ran ? 0 : 1);
+    stats.runs += ran ? 1 : 0;
+    const auto jitter =
+        std::chrono::duration_cast<std::chrono::microseconds>(delay);
+    stats.max_jitter = std::max(stats.max_jitter, jitter);
+    stats.mean_jitter = std::chrono::duration_cast<std::chrono::microseconds>(
+        schedule.jitter_sum / schedule.fires);
+}
+
+uint64_t TRLScheduler::ToTick(Clock::time_point time) const
+{
+    if (time <= m_start) {
+        return 0;
+    }
+    return (time - m_start + m_resolution - Clock::duration(1)) /
+           m_resolution;
+}
@@ -0,0 +1,266 @@
+#include "TRLStateJournal.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// identifies a journal file, "TRLJ"
+#define JOURNAL_MAGIC 0x4a4c5254
+#define JOURNAL_VERSION 1
+// the ring starts on its own cache line
+#define JOURNAL_RING_OFFSET 64
+
+TRLStateJournal::TRLStateJournal() {}
+
+TRLStateJournal::~TRLStateJournal()
+{
+    if (m_header) {
+        msync(m_header, m_mapped_size, MS_SYNC);
+        munmap(m_header, m_mapped_size);
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+bool TRLStateJournal::Initialize(const std::string &path, size_t capacity)
+{
+    static_assert(sizeof(Header) <= JOURNAL_RING_OFFSET);
+    std::scoped_lock lock(m_mutex);
+    if (capacity < sizeof(Record)) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLStateJournal::Initialize failed. Capacity of " << capacity
+            << " bytes is too small.";
+        return false;
+    }
+
+    m_fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLStateJournal::Initialize failed to open " << path << ". "
+            << std::strerror(errno);
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(m_fd, &file_stat)) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLStateJournal::Initialize failed to stat " << path << ". "
+            << std::strerror(errno);
+        return false;
+    }
+    m_capacity = capacity;
+    m_mapped_size = JOURNAL_RING_OFFSET + capacity;
+    const bool existing =
+        static_cast<size_t>(file_stat.st_size) == m_mapped_size;
+    if (!existing && ftruncate(m_fd, m_mapped_size)) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLStateJournal::Initialize failed to resize " << path << ". "
+            << std::strerror(errno);
+        return false;
+    }
+
+    void *mapping = mmap(
+        nullptr,
+        m_mapped_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED,
+        m_fd,
+        0);
+    if (mapping == MAP_FAILED) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLStateJournal::Initialize failed to map " << path << ". "
+            << std::strerror(errno);
+        return false;
+    }
+    m_header = static_cast<Header *>(mapping);
+    m_ring = static_cast<uint8_t *>(mapping) + JOURNAL_RING_OFFSET;
+
+    if (existing && m_header->magic == JOURNAL_MAGIC &&
+        m_header->version == JOURNAL_VERSION &&
+        m_header->capacity == m_capacity && m_header->head <= m_header->tail &&
+        m_header->tail - m_header->head <= m_capacity) {
+        Recover();
+    } else {
+        m_header->magic = JOURNAL_MAGIC;
+        m_header->version = JOURNAL_VERSION;
+        m_header->capacity = m_capacity;
+        m_header->head = 0;
+        m_header->tail = 0;
+    }
+    BOOST_LOG_TRIVIAL(info)
+        << "TRLStateJournal::Initialize journal " << path << " holds "
+        << m_header->tail - m_header->head << " of " << m_capacity
+        << " bytes";
+    return true;
+}
+
+void TRLStateJournal::Append(
+    const std::string &topic,
+    const std::string &device,
+    const std::string &payload)
+{
+    std::scoped_lock lock(m_mutex);
+    if (!m_header) {
+        return;
+    }
+    Record record;
+    record.payload_size = static_cast<uint32_t>(payload.size());
+    record.topic_size = static_cast<uint16_t>(topic.size());
+    record.device_size = static_cast<uint16_t>(device.size());
+    const uint64_t size =
+        sizeof(record) + topic.size() + device.size() + payload.size();
+    if (size > m_capacity || topic.size() > UINT16_MAX ||
+        device.size() > UINT16_MAX) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "TRLStateJournal::Append message of " << size
+            << " bytes does not fit the journal, dropping it.";
+        m_dropped++;
+        return;
+    }
+    while (m_header->tail + size - m_header->head > m_capacity) {
+        DropHead();
+        m_dropped++;
+    }
+
+    const uint64_t offset = m_header->tail;
+    Write(offset, &record, sizeof(record));
+    Write(offset + sizeof(record), topic.data(), topic.size());
+    Write(offset + sizeof(record) + topic.size(), device.data(), device.size());
+    Write(
+        offset + sizeof(record) + topic.size() + device.size(),
+        payload.data(),
+        payload.size());
+    // the message only becomes part of the journal once it is complete
+    m_header->tail = offset + size;
+    m_latest[Key(topic, device)] = offset;
+}
+
+size_t TRLStateJournal::Replay(size_t max_messages, const Publisher &publish)
+{
+    std::scoped_lock lock(m_mutex);
+    if (!m_header) {
+        return 0;
+    }
+    size_t published = 0;
+    while (published < max_messages && m_header->head != m_header->tail) {
+        const uint64_t offset = m_header->head;
+        const uint64_t size = ReadRecord(offset);
+        const auto latest = m_latest.find(Key(m_topic, m_device));
+        if (latest == m_latest.end() || latest->second != offset) {
+            // a newer state of the same device follows
+            m_header->head = offset + size;
+            continue;
+        }
+        if (!publish(m_topic, m_payload)) {
+            break;
+        }
+        m_latest.erase(latest);
+        m_header->head = offset + size;
+        published++;
+    }
+    return published;
+}
+
+bool TRLStateJournal::Empty() const
+{
+    std::scoped_lock lock(m_mutex);
+    return !m_header || m_header->head == m_header->tail;
+}
+
+uint64_t TRLStateJournal::Dropped() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_dropped;
+}
+
+void TRLStateJournal::Write(uint64_t offset, const void *data, size_t size)
+{
+    const size_t start = offset % m_capacity;
+    const size_t first = std::min<size_t>(size, m_capacity - start);
+    std::memcpy(m_ring + start, data, first);
+    std::memcpy(m_ring, static_cast<const uint8_t *>(data) + first, size - first);
+}
+
+void TRLStateJournal::Read(uint64_t offset, void *data, size_t size) const
+{
+    const size_t start = offset % m_capacity;
+    const size_t first = std::min<size_t>(size, m_capacity - start);
+    std::memcpy(data, m_ring + start, first);
+    std::memcpy(static_cast<uint8_t *>(data) + first, m_ring, size - first);
+}
+
+uint64_t TRLStateJournal::ReadRecord(uint64_t offset)
+{
+    Record record;
+    Read(offset, &record, sizeof(record));
+    offset += sizeof(record);
+    m_topic.resize(record.topic_size);
+    Read(offset, m_topic.data(), record.topic_size);
+    offset += record.topic_size;
+    m_device.resize(record.device_size);
+    Read(offset, m_device.data(), record.device_size);
+    offset += record.device_size;
+    m_payload.resize(record.payload_size);
+    Read(offset, m_payload.data(), record.payload_size);
+    return sizeof(record) + record.topic_size + record.device_size +
+           record.payload_size;
+}
+
+void TRLStateJournal::DropHead()
+{
+    const uint64_t offset = m_header->head;
+    m_header->head = offset + ReadRecord(offset);
+    const auto latest = m_latest.find(Key(m_topic, m_device));
+    if (latest != m_latest.end() && latest->second == offset) {
+        m_latest.erase(latest);
+    }
+}
+
+void TRLStateJournal::Recover()
+{
+    uint64_t offset = m_header->head;
+    size_t messages = 0;
+    while (offset != m_header->tail) {
+        Record record;
+        if (m_header->tail - offset < sizeof(record)) {
+            break;
+        }
+        Read(offset, &record, sizeof(record));
+        const uint64_t size = sizeof(record) + record.topic_size +
+                              record.device_size + record.payload_size;
+        if (size > m_header->tail - offset) {
+            break;
+        }
+        ReadRecord(offset);
+        m_latest[Key(m_topic, m_device)] = offset;
+        offset += size;
+        messages++;
+    }
+    if (offset != m_header->tail) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "TRLStateJournal::Recover discarding "
+            << m_header->tail - offset << " bytes of a torn message.";
+        m_header->tail = offset;
+    }
+    BOOST_LOG_TRIVIAL(info)
+        << "TRLStateJournal::Recover " << messages
+        << " messages waiting for replay";
+}
+
+std::string TRLStateJournal::Key(
+    const std::string &topic,
+    const std::string &device)
+{
+    // topics cannot contain a null character
+    std::string key;
+    key.reserve(topic.size() + device.size() + 1);
+    key += topic;
+    key += '\0';
+    key += device;
+    return key;
+}
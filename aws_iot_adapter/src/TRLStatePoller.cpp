@@ -0,0 +1,111 @@
+#include "TRLStatePoller.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+TRLStatePoller::TRLStatePoller(size_t num_workers) : m_pool(num_workers) {}
+
+TRLFleetState TRLStatePoller::Poll(
+    const std::vector<std::shared_ptr<TRLDoorInterface>> &doors,
+    const std::vector<std::shared_ptr<TRLLiftInterface>> &lifts)
+{
+    TRLFleetState fleet;
+    fleet.doors.resize(doors.size());
+    fleet.lifts.resize(lifts.size());
+
+    const int time = SampleTime();
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t pending = doors.size() + lifts.size();
+    auto done = [&]() {
+        std::scoped_lock lock(done_mutex);
+        if (--pending == 0) {
+            done_cv.notify_one();
+        }
+    };
+
+    // every task only writes its own slot, so the snapshot needs no locking
+    for (size_t i = 0; i < doors.size(); ++i) {
+        m_pool.Submit([&, i]() {
+            fleet.doors[i] = SampleDoor(*doors[i], time);
+            done();
+        });
+    }
+    for (size_t i = 0; i < lifts.size(); ++i) {
+        m_pool.Submit([&, i]() {
+            fleet.lifts[i] = SampleLift(*lifts[i], time);
+            done();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&]() { return pending == 0; });
+    return fleet;
+}
+
+void TRLStatePoller::Submit(std::function<void()> task)
+{
+    m_pool.Submit(std::move(task));
+}
+
+int TRLStatePoller::SampleTime()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+TRLDoorState TRLStatePoller::SampleDoor(
+    TRLDoorInterface &door,
+    int time,
+    TRLDoorLatencies *latencies)
+{
+    TRLDoorState state;
+    state.door_time = time;
+    state.door_name = door.GetDoorName();
+    try {
+        const auto start = TRLLatencyHistogram::Clock::now();
+        state.current_mode = door.GetDoorState();
+        if (latencies) {
+            latencies->door_state.RecordSince(start);
+        }
+    } catch (const std::exception &e) {
+        state.current_mode = UNKNOWN;
+        BOOST_LOG_TRIVIAL(error)
+            << state.door_name << "| TRLStatePoller::SampleDoor failed. "
+            << e.what();
+    }
+    return state;
+}
+
+TRLLiftState TRLStatePoller::SampleLift(
+    TRLLiftInterface &lift,
+    int time,
+    TRLLiftLatencies *latencies)
+{
+    TRLLiftState state;
+    state.lift_time = time;
+    state.lift_name = lift.GetName();
+    state.available_floors = lift.AvailableFloors();
+    state.available_modes = lift.AvailableModes();
+    state.session_id = lift.GetSessionID();
+    try {
+        const auto start = TRLLatencyHistogram::Clock::now();
+        const LiftSnapshot snapshot = lift.Snapshot();
+        if (latencies) {
+            latencies->snapshot.RecordSince(start);
+        }
+        state.current_floor = snapshot.current_floor.value_or("0");
+        state.destination_floor = snapshot.destination_floor.value_or("0");
+        state.door_state = snapshot.door_state;
+        state.motion_state = snapshot.motion_state;
+        state.lift_mode = snapshot.mode;
+    } catch (const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error)
+            << state.lift_name << "| TRLStatePoller::SampleLift failed. "
+            << e.what();
+    }
+    return state;
+}
@@ -0,0 +1,119 @@
+#include "TRLStateSerializer.hpp"
+
+#include <charconv>
+
+void TRLStateSerializer::Serialize(const TRLDoorState &state, std::string &out)
+{
+    // keys are written in the order nlohmann::json stores them
+    out += "{\"current_mode\":";
+    AppendInt(state.current_mode, out);
+    out += ",\"door_name\":";
+    AppendString(state.door_name, out);
+    out += ",\"door_time\":";
+    AppendInt(state.door_time, out);
+    out += '}';
+}
+
+void TRLStateSerializer::Serialize(const TRLLiftState &state, std::string &out)
+{
+    // keys are written in the order nlohmann::json stores them, the
+    // misspelled "currrent_floor" is part of the published schema
+    out += "{\"available_floors\":";
+    AppendArray(state.available_floors, out);
+    out += ",\"available_modes\":";
+    AppendArray(state.available_modes, out);
+    out += ",\"currrent_floor\":";
+    AppendString(state.current_floor, out);
+    out += ",\"destination_floor\":";
+    AppendString(state.destination_floor, out);
+    out += ",\"door_state\":";
+    AppendInt(state.door_state, out);
+    out += ",\"lift_mode\":";
+    AppendInt(state.lift_mode, out);
+    out += ",\"lift_name\":";
+    AppendString(state.lift_name, out);
+    out += ",\"lift_time\":";
+    AppendInt(state.lift_time, out);
+    out += ",\"motion_state\":";
+    AppendInt(state.motion_state, out);
+    out += ",\"session_id\":";
+    AppendString(state.session_id, out);
+    out += '}';
+}
+
+void TRLStateSerializer::AppendInt(long long value, std::string &out)
+{
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void TRLStateSerializer::AppendString(
+    const std::string &value,
+    std::string &out)
+{
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (const char c : value) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) <= 0x1F) {
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0x0F];
+                    out += hex[c & 0x0F];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void TRLStateSerializer::AppendArray(
+    const std::vector<int> &values,
+    std::string &out)
+{
+    out += '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i) {
+            out += ',';
+        }
+        AppendInt(values[i], out);
+    }
+    out += ']';
+}
+
+void TRLStateSerializer::AppendArray(
+    const std::vector<std::string> &values,
+    std::string &out)
+{
+    out += '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i) {
+            out += ',';
+        }
+        AppendString(values[i], out);
+    }
+    out += ']';
+}
@@ -0,0 +1,98 @@
+#include "TRLTimerWheel.hpp"
+
+#include <algorithm>
+
+namespace {
+const uint64_t kSlots = 1 << TIMER_WHEEL_SLOT_BITS;
+const uint64_t kSlotMask = kSlots - 1;
+
+// number of ticks covered by one slot of the given level
+uint64_t SlotSpan(size_t level)
+{
+    return uint64_t(1) << (TIMER_WHEEL_SLOT_BITS * level);
+}
+}  // namespace
+
+TRLTimerWheel::TRLTimerWheel() {}
+
+void TRLTimerWheel::Insert(size_t id, uint64_t expiry)
+{
+    // the current tick was already expired, fire on the next one
+    Place(Timer{id, std::max(expiry, m_current + 1)});
+}
+
+void TRLTimerWheel::Advance(uint64_t tick, std::vector<size_t> &expired)
+{
+    while (m_current < tick) {
+        m_current++;
+        // crossing the boundary of a level 1 slot, pull its timers down and
+        // continue upwards while the upper levels wrap as well
+        for (size_t level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+            if (m_current & (SlotSpan(level) - 1)) {
+                break;
+            }
+            Cascade(level);
+        }
+        Slot &slot = m_levels[0][m_current & kSlotMask];
+        if (slot.empty()) {
+            continue;
+        }
+        m_scratch.swap(slot);
+        for (const auto &timer : m_scratch) {
+            expired.push_back(timer.id);
+        }
+        m_scratch.clear();
+    }
+}
+
+uint64_t TRLTimerWheel::NextTick() const
+{
+    // the next cascade may bring timers into level 0
+    const uint64_t boundary = (m_current | kSlotMask) + 1;
+    for (uint64_t tick = m_current + 1; tick < boundary; ++tick) {
+        if (!m_levels[0][tick & kSlotMask].empty()) {
+            return tick;
+        }
+    }
+    return boundary;
+}
+
+uint64_t TRLTimerWheel::Current() const
+{
+    return m_current;
+}
+
+void TRLTimerWheel::Place(const Timer &timer)
+{
+    const uint64_t distance = timer.expiry - m_current;
+    for (size_t level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+        if (distance < SlotSpan(level + 1)) {
+            const uint64_t slot = (timer.expiry >> (TIMER_WHEEL_SLOT_BITS *
+                                                    level)) &
+                                  kSlotMask;
+            m_levels[level][slot].push_back(timer);
+            return;
+        }
+    }
+    // beyond the range of the wheel, park the timer in the slot of the top
+    // level that is cascaded last, it is placed again from there
+    const size_t top = TIMER_WHEEL_LEVELS - 1;
+    const uint64_t slot =
+        ((m_current >> (TIMER_WHEEL_SLOT_BITS * top)) - 1) & kSlotMask;
+    m_levels[top][slot].push_back(timer);
+}
+
+void TRLTimerWheel::Cascade(size_t level)
+{
+    Slot &slot =
+        m_levels[level][(m_current >> (TIMER_WHEEL_SLOT_BITS * level)) &
+                        kSlotMask];
+    if (slot.empty()) {
+        return;
+    }
+    m_scratch.swap(slot);
+    for (const auto &timer : m_scratch) {
+        Place(timer);
+    }
+    m_scratch.clear();
+}
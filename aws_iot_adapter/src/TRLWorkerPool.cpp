@@ -0,0 +1,55 @@
+#include "TRLWorkerPool.hpp"
+
+TRLWorkerPool::TRLWorkerPool(size_t num_workers)
+{
+    if (num_workers == 0) {
+        num_workers = 1;
+    }
+    m_workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        m_workers.emplace_back(&TRLWorkerPool::Run, this);
+    }
+}
+
+TRLWorkerPool::~TRLWorkerPool()
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+}
+
+void TRLWorkerPool::Submit(std::function<void()> task)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+size_t TRLWorkerPool::Size() const
+{
+    return m_workers.size();
+}
+
+void TRLWorkerPool::Run()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&]() { return m_stop || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -46,12 +46,8 @@ int main(int argc, char **argv)
             aws_config_file_path,
             lift_config_file_path,
             doors_config_file_path)) {
-        while (!stop) {
-            if (interface.ConnectionCompleted()) {
-                interface.PublishState();
-            }
-            boost::this_thread::sleep_for(boost::chrono::milliseconds(1000));
-        }
+        // polls and publishes every device at its own period until SIGINT
+        interface.Run([]() { return !stop; });
         BOOST_LOG_TRIVIAL(info) << "Exiting..";
         exit(-1);
     } else {
@@ -6,8 +6,10 @@
 #include "modbus.hpp"
 
 // Standard includes
+#include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -32,6 +34,25 @@
 #define OFFLINE 3
 #define UNKNOWN 4
 
+// a Modbus response is awaited as long as the socket timeout of the client
+#define MODBUS_RESPONSE_TIMEOUT_MS 20000
+// largest delay between the attempts of a command to lock the client
+#define MODBUS_LOCK_RETRY_MAX_MS 16
+
+/**
+ * @brief Hooks of the event loop running asynchronous door commands, both
+ * call their function later on the loop thread
+ */
+struct TRLDoorAsyncIO {
+    // calls the handler once the socket is readable, with false on timeout
+    std::function<
+        void(int, std::chrono::milliseconds, std::function<void(bool)>)>
+        wait_readable;
+    // calls the task once the delay elapsed
+    std::function<void(std::chrono::milliseconds, std::function<void()>)>
+        after;
+};
+
 class TRLDoorInterface {
 public:
     /**
@@ -62,6 +83,19 @@ public:
      */
     bool ActuateDoor(const bool state);
 
+    /**
+     * @brief Same as ActuateDoor() without blocking the calling thread, the
+     * Modbus responses and the settling delays are awaited on an event loop.
+     * Must be called on the loop thread.
+     * @param state true means open, false means close
+     * @param io the hooks of the event loop
+     * @param done called once on the loop thread with the result
+     */
+    void ActuateDoorAsync(
+        bool state,
+        const TRLDoorAsyncIO &io,
+        std::function<void(bool)> done);
+
     /**
      * @brief retrieves door state
      * @return an int corresponding to the door state
@@ -83,7 +117,46 @@ public:
     const std::string &GetDoorName() const;
 
 private:
+    /**
+     * @brief Locks the client without blocking the loop thread, the
+     * attempts back off while the state poller holds it
+     * @param io the hooks of the event loop
+     * @param delay time until the next attempt, doubled up to
+     * MODBUS_LOCK_RETRY_MAX_MS
+     * @param locked called once on the loop thread with the client locked
+     */
+    void LockAsync(
+        const TRLDoorAsyncIO &io,
+        std::chrono::milliseconds delay,
+        std::function<void()> locked);
+
+    /**
+     * @brief ActuateDoorAsync() once the client is locked, unlocks it
+     * before calling done
+     */
+    void ActuateDoorLocked(
+        bool state,
+        const TRLDoorAsyncIO &io,
+        std::function<void(bool)> done);
+
+    /**
+     * @brief Sends a Modbus request and receives its response once the
+     * socket is readable
+     * @param send sends the request, returns 0 on success
+     * @param receive reads the response, returns its status
+     * @param io the hooks of the event loop
+     * @param done called once with the status, BAD_CON on timeout. The
+     * connection is then closed, GetDoorState() connects again.
+     */
+    void ModbusAsync(
+        std::function<int()> send,
+        std::function<int()> receive,
+        const TRLDoorAsyncIO &io,
+        std::function<void(int)> done);
+
     modbus m_mb;
+    std::mutex m_mb_mutex;  // the modbus client is shared by the state poller
+                            // and the command executor
     std::string m_name = "";
 };
 #endif  // TRL_DOOR_INTERFACE_HPP
\ No newline at end of file
@@ -23,6 +23,8 @@
 // 1. Make variable & function conventions consistent
 // 2. Make new function called SetHostPort instead of passing variables via
 // constructor
+// 3. Split ReadCoils and WriteCoil into request and response so an event
+// loop can wait for the response
 
 #ifndef MODBUSPP_MODBUS_H
 #define MODBUSPP_MODBUS_H
@@ -111,7 +113,8 @@ public:
     ~modbus();
 
     bool ModbusConnect();
-    void ModbusClose() const;
+    void ModbusClose();
+    void ModbusAbort();
 
     bool IsConnected() const
     {
@@ -122,12 +125,20 @@ public:
     void SetSlaveID(int id);
 
     int ReadCoils(uint16_t address, uint16_t amount, bool *buffer);
+    int SendReadCoils(uint16_t address, uint16_t amount);
+    int ReceiveReadCoils(uint16_t amount, bool *buffer);
     int ReadInputBits(uint16_t address, uint16_t amount, bool *buffer);
     int
     ReadHoldingRegisters(uint16_t address, uint16_t amount, uint16_t *buffer);
     int ReadInputRegisters(uint16_t address, uint16_t amount, uint16_t *buffer);
 
     int WriteCoil(uint16_t address, const bool &to_write);
+    int SendWriteCoil(uint16_t address, const bool &to_write);
+    int ReceiveWriteCoil();
+    X_SOCKET Socket() const
+    {
+        return m_socket;
+    }
     int WriteRegisters(uint16_t address, const uint16_t &value);
     int WriteCoils(uint16_t address, uint16_t amount, const bool *value);
     int
@@ -262,6 +273,7 @@ inline bool modbus::ModbusConnect()
     if (!X_ISCONNECTSUCCEED(
             connect(m_socket, (SOCKADDR *)&m_server, sizeof(m_server)))) {
         LOG("Connection Error");
+        X_CLOSE_SOCKET(m_socket);
 #ifdef _WIN32
         WSACleanup();
 #endif
@@ -276,8 +288,12 @@ inline bool modbus::ModbusConnect()
 /**
  * Close the Modbus/TCP Connection
  */
-inline void modbus::ModbusClose() const
+inline void modbus::ModbusClose()
 {
+    if (!m_connected) {
+        return;
+    }
+    m_connected = false;
     X_CLOSE_SOCKET(m_socket);
 #ifdef _WIN32
     WSACleanup();
@@ -285,6 +301,17 @@ inline void modbus::ModbusClose() const
     LOG("Socket Closed");
 }
 
+/**
+ * Drop a Connection Whose Response Was Lost
+ * A late response would be taken for the one of the next request, the
+ * connection is closed instead and has to be built up again
+ */
+inline void modbus::ModbusAbort()
+{
+    ModbusClose();
+    SetBadCon();
+}
+
 /**
  * Modbus Request Builder
  * @param to_send   Message Buffer to Be Sent
@@ -447,6 +474,20 @@ modbus::ReadInputRegisters(uint16_t address, uint16_t amount, uint16_t *buffer)
  * @param buffer      Buffer to Store Data Read from Coils
  */
 inline int modbus::ReadCoils(uint16_t address, uint16_t amount, bool *buffer)
+{
+    const int status = SendReadCoils(address, amount);
+    if (status) {
+        return status;
+    }
+    return ReceiveReadCoils(amount, buffer);
+}
+
+/**
+ * Read Coils Request, the response is read by ReceiveReadCoils()
+ * @param address     Reference Address
+ * @param amount      Amount of Coils to Read
+ */
+inline int modbus::SendReadCoils(uint16_t address, uint16_t amount)
 {
     if (m_connected) {
         if (amount > 2040) {
@@ -454,18 +495,6 @@ inline int modbus::ReadCoils(uint16_t address, uint16_t amount, bool *buffer)
             return EX_BAD_DATA;
         }
         ModbusRead(address, amount, READ_COILS);
-        uint8_t to_rec[MAX_MSG_LENGTH];
-        ssize_t k = ModbusReceive(to_rec);
-        if (k == -1) {
-            SetBadCon();
-            return BAD_CON;
-        }
-        ModbuserrorHandle(to_rec, READ_COILS);
-        if (err)
-            return err_no;
-        for (auto i = 0; i < amount; i++) {
-            buffer[i] = (bool)((to_rec[9u + i / 8u] >> (i % 8u)) & 1u);
-        }
         return 0;
     } else {
         SetBadCon();
@@ -473,6 +502,28 @@ inline int modbus::ReadCoils(uint16_t address, uint16_t amount, bool *buffer)
     }
 }
 
+/**
+ * Read Coils Response, blocks until it arrives
+ * @param amount      Amount of Coils Requested
+ * @param buffer      Buffer to Store Data Read from Coils
+ */
+inline int modbus::ReceiveReadCoils(uint16_t amount, bool *buffer)
+{
+    uint8_t to_rec[MAX_MSG_LENGTH];
+    ssize_t k = ModbusReceive(to_rec);
+    if (k == -1) {
+        SetBadCon();
+        return BAD_CON;
+    }
+    ModbuserrorHandle(to_rec, READ_COILS);
+    if (err)
+        return err_no;
+    for (auto i = 0; i < amount; i++) {
+        buffer[i] = (bool)((to_rec[9u + i / 8u] >> (i % 8u)) & 1u);
+    }
+    return 0;
+}
+
 /**
  * Read Input Bits(Discrete Data)
  * MODBUS FUNCITON 0x02
@@ -514,19 +565,24 @@ modbus::ReadInputBits(uint16_t address, uint16_t amount, bool *buffer)
  * @param to_write   Value to be Written to Coil
  */
 inline int modbus::WriteCoil(uint16_t address, const bool &to_write)
+{
+    const int status = SendWriteCoil(address, to_write);
+    if (status) {
+        return status;
+    }
+    return ReceiveWriteCoil();
+}
+
+/**
+ * Write Single Coil Request, the response is read by ReceiveWriteCoil()
+ * @param address    Reference Address
+ * @param to_write   Value to be Written to Coil
+ */
+inline int modbus::SendWriteCoil(uint16_t address, const bool &to_write)
 {
     if (m_connected) {
         int value = to_write * 0xFF00;
         ModbusWrite(address, 1, WRITE_COIL, (uint16_t *)&value);
-        uint8_t to_rec[MAX_MSG_LENGTH];
-        ssize_t k = ModbusReceive(to_rec);
-        if (k == -1) {
-            SetBadCon();
-            return BAD_CON;
-        }
-        ModbuserrorHandle(to_rec, WRITE_COIL);
-        if (err)
-            return err_no;
         return 0;
     } else {
         SetBadCon();
@@ -534,6 +590,23 @@ inline int modbus::WriteCoil(uint16_t address, const bool &to_write)
     }
 }
 
+/**
+ * Write Single Coil Response, blocks until it arrives
+ */
+inline int modbus::ReceiveWriteCoil()
+{
+    uint8_t to_rec[MAX_MSG_LENGTH];
+    ssize_t k = ModbusReceive(to_rec);
+    if (k == -1) {
+        SetBadCon();
+        return BAD_CON;
+    }
+    ModbuserrorHandle(to_rec, WRITE_COIL);
+    if (err)
+        return err_no;
+    return 0;
+}
+
 /**
  * Write Single Register
  * FUCTION 0x06
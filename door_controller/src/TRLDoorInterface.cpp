@@ -53,6 +53,7 @@ bool TRLDoorInterface::Initialize(
 
 bool TRLDoorInterface::ActuateDoor(const bool state)
 {
+    std::scoped_lock lock(m_mb_mutex);
     bool read_coil;
     try {
         // TODO: Check if needed and remove
@@ -80,10 +81,141 @@ bool TRLDoorInterface::ActuateDoor(const bool state)
     }
 }
 
+void TRLDoorInterface::ActuateDoorAsync(
+    bool state,
+    const TRLDoorAsyncIO &io,
+    std::function<void(bool)> done)
+{
+    LockAsync(io, std::chrono::milliseconds(1), [this, state, io, done]() {
+        ActuateDoorLocked(state, io, done);
+    });
+}
+
+void TRLDoorInterface::LockAsync(
+    const TRLDoorAsyncIO &io,
+    std::chrono::milliseconds delay,
+    std::function<void()> locked)
+{
+    // the loop thread must not wait for the state poller, which may hold
+    // the client for a whole response timeout
+    if (!m_mb_mutex.try_lock()) {
+        const auto next = std::min(
+            delay * 2,
+            std::chrono::milliseconds(MODBUS_LOCK_RETRY_MAX_MS));
+        io.after(delay, [this, io, next, locked]() {
+            LockAsync(io, next, locked);
+        });
+        return;
+    }
+    locked();
+}
+
+void TRLDoorInterface::ActuateDoorLocked(
+    bool state,
+    const TRLDoorAsyncIO &io,
+    std::function<void(bool)> done)
+{
+    // the client stays locked across the steps, all run on the loop thread
+    auto finish = [this, done](bool success) {
+        m_mb_mutex.unlock();
+        done(success);
+    };
+    ModbusAsync(
+        [this, state]() { return m_mb.SendWriteCoil(DOOR_ACTUATE, state); },
+        [this]() { return m_mb.ReceiveWriteCoil(); },
+        io,
+        [this, state, io, finish](int status) {
+            if (status == -1) {
+                BOOST_LOG_TRIVIAL(info)
+                    << m_name
+                    << ("| TRLDoorInterface::actuateDoor Modbus not connected when actuating door.");
+                finish(false);
+                return;
+            }
+            io.after(std::chrono::milliseconds(20), [this, state, io, finish]() {
+                auto read_coil = std::make_shared<bool>(false);
+                ModbusAsync(
+                    [this]() { return m_mb.SendReadCoils(DOOR_ACTUATE, 1); },
+                    [this, read_coil]() {
+                        return m_mb.ReceiveReadCoils(1, read_coil.get());
+                    },
+                    io,
+                    [this, state, io, finish, read_coil](int status) {
+                        if (status == -1) {
+                            BOOST_LOG_TRIVIAL(info)
+                                << m_name
+                                << ("| TRLDoorInterface::actuateDoor Modbus not connected when actuating door.");
+                            finish(false);
+                            return;
+                        }
+                        io.after(
+                            std::chrono::milliseconds(5),
+                            [state, finish, read_coil]() {
+                                finish(*read_coil == state);
+                            });
+                    });
+            });
+        });
+}
+
+void TRLDoorInterface::ModbusAsync(
+    std::function<int()> send,
+    std::function<int()> receive,
+    const TRLDoorAsyncIO &io,
+    std::function<void(int)> done)
+{
+    int status = BAD_CON;
+    try {
+        status = send();
+    } catch (const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error)
+            << m_name << "| TRLDoorInterface::ModbusAsync Error! " << e.what();
+    }
+    if (status) {
+        done(status);
+        return;
+    }
+    io.wait_readable(
+        m_mb.Socket(),
+        std::chrono::milliseconds(MODBUS_RESPONSE_TIMEOUT_MS),
+        [this, receive, done](bool readable) {
+            int status = BAD_CON;
+            try {
+                // the response is waiting, receiving it does not block
+                if (readable) {
+                    status = receive();
+                }
+            } catch (const std::exception &e) {
+                BOOST_LOG_TRIVIAL(error)
+                    << m_name << "| TRLDoorInterface::ModbusAsync Error! "
+                    << e.what();
+            }
+            // a late response must not answer the next request, the state
+            // poller connects again
+            if (status == BAD_CON) {
+                BOOST_LOG_TRIVIAL(warning)
+                    << m_name
+                    << "| TRLDoorInterface::ModbusAsync no response, closing the MODBUS connection.";
+                m_mb.ModbusAbort();
+            }
+            done(status);
+        });
+}
+
 int TRLDoorInterface::GetDoorState()
 {
+    std::scoped_lock lock(m_mb_mutex);
     bool fully_open_coil, fully_closed_coil;
     try {
+        // the connection is closed when a response is lost
+        if (!m_mb.IsConnected()) {
+            if (!m_mb.ModbusConnect()) {
+                return OFFLINE;
+            }
+            BOOST_LOG_TRIVIAL(info)
+                << m_name
+                << "| TRLDoorInterface::getDoorState MODBUS connection restored.";
+        }
         // TODO: Check if this is needed
         if (m_mb.ReadCoils(DOOR_OPEN_STATE, 1, &fully_open_coil) == -1) {
             return OFFLINE;
@@ -112,6 +244,7 @@ int TRLDoorInterface::GetDoorState()
 
 bool TRLDoorInterface::CheckConnection()
 {
+    std::scoped_lock lock(m_mb_mutex);
     bool read_coil;
     try {
         return m_mb.ReadCoils(9, 1, &read_coil) == -1;
@@ -4,9 +4,20 @@
 #include <time.h>
 #include <yaml-cpp/yaml.h>
 
+#include <array>
+#include <atomic>
 #include <boost/thread/thread.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
 #include <variant>
 
 #include "../lib/ADS/AdsLib/AdsLib.h"
@@ -15,6 +26,20 @@
 
 using namespace std;
 
+// variables of all devices that can be cached from ADS notifications
+#define ADS_CACHE_MAX_VARIABLES 4096
+// default delays between reconnection attempts in ms
+#define ADS_RECONNECT_BACKOFF_MIN_MS 100
+#define ADS_RECONNECT_BACKOFF_MAX_MS 10000
+// default number of requests of a device in flight at once
+#define ADS_MAX_REQUESTS_IN_FLIGHT 8
+// default period of the ADS state reads confirming the notification cache
+#define ADS_CACHE_HEARTBEAT_MS 1000
+// heartbeats that may be missed before cached values are read from the PLC
+#define ADS_CACHE_MAX_MISSED_HEARTBEATS 3
+// timeout of the request deleting the notifications of a device in ms
+#define ADS_NOTIFICATION_DELETE_TIMEOUT_MS 500
+
 class AdsInterface {
     enum
     {
@@ -45,6 +70,15 @@ public:
         double,
         tm>;
 
+    /**
+     * @brief a value served from the notification cache
+     */
+    struct CachedValue {
+        AdsInterface::variant_t value;  // last known value of the variable
+        std::chrono::steady_clock::time_point
+            updated;  // when the value was received from the PLC
+    };
+
     /**
      * @brief AdsInterface simple constructor
      */
@@ -71,13 +105,170 @@ public:
     AdsInterface::variant_t AdsReadValue(const std::string& var_name);
 
     /**
-     * @brief adsReadVariables reads multiple variables' value
+     * @brief adsReadVariables reads multiple variables' value in a single
+     * sum-up round trip
      * @param var_names names of the variables to read
-     * @return vector<variant_t> values of the variables
+     * @return vector<variant_t> values of the variables, in the order of
+     * var_names. Unknown or unreadable variables hold a default value.
      */
     std::vector<AdsInterface::variant_t> AdsReadVariables(
         const std::vector<std::string>& var_names);
 
+    /**
+     * @brief one step of an AdsExchange()
+     */
+    struct Operation {
+        std::string name;  // alias of the variable
+        std::optional<AdsInterface::variant_t>
+            write;  // value to write, the variable is read if empty
+    };
+
+    /**
+     * @brief adsExchange writes and reads several variables in a single
+     * sum-up read/write round trip. The PLC processes the whole request in
+     * order at once, so its program never sees only part of the writes and
+     * reads placed after a write observe it.
+     * @param operations the writes and reads, in the order to process them
+     * @param values receives one value per operation, the value read for
+     * reads and a default value for writes
+     * @return true if every operation succeeded
+     * @return false otherwise, the device is then left in an unknown state
+     */
+    bool AdsExchange(
+        const std::vector<Operation>& operations,
+        std::vector<AdsInterface::variant_t>& values);
+
+    /**
+     * @brief completion of an AdsExchangeAsync(), called with the result and
+     * the values as AdsExchange() returns them
+     */
+    using ExchangeHandler =
+        std::function<void(bool, std::vector<AdsInterface::variant_t>)>;
+
+    /**
+     * @brief adsExchangeAsync sends the same round trip as AdsExchange()
+     * without waiting for it. The request does not count against the
+     * requests in flight of SetMaxRequestsInFlight(). Failed variables are
+     * not bound again, the next blocking access does that, and the written
+     * values reach the cache with the next notification.
+     * @param operations the writes and reads, in the order to process them
+     * @param done called once from an ADS connection thread, or before
+     * returning if the request could not be sent. It must not block.
+     */
+    void AdsExchangeAsync(
+        const std::vector<Operation>& operations,
+        ExchangeHandler done);
+
+    /**
+     * @brief a variable of the typed registry, see BindTyped()
+     */
+    struct TypedBinding {
+        std::string alias;  // alias of the variable
+        int type;           // TypeOf() the C++ type used to access it
+    };
+
+    /**
+     * @brief bindTyped resolves the variables of the typed registry once, so
+     * that ReadTyped() and WriteTyped() access them by index without any
+     * lookup. Must be called once, after BindPLCVar().
+     * @param bindings the variables, the index of each one is its id
+     * @return the number of variables found with the expected type, the
+     * others fail every access
+     */
+    size_t BindTyped(const std::vector<TypedBinding>& bindings);
+
+    /**
+     * @brief TypeOf gives the type as int of a C++ type, see
+     * ConvertTypeFromString()
+     */
+    template <typename T>
+    static constexpr int TypeOf()
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            return BOOL;
+        } else if constexpr (std::is_same_v<T, uint8_t>) {
+            return UINT8_T;
+        } else if constexpr (std::is_same_v<T, int8_t>) {
+            return INT8_T;
+        } else if constexpr (std::is_same_v<T, uint16_t>) {
+            return UINT16_T;
+        } else if constexpr (std::is_same_v<T, int16_t>) {
+            return INT16_T;
+        } else if constexpr (std::is_same_v<T, uint32_t>) {
+            return UINT32_T;
+        } else if constexpr (std::is_same_v<T, int32_t>) {
+            return INT32_T;
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            return INT64_T;
+        } else if constexpr (std::is_same_v<T, float>) {
+            return FLOAT;
+        } else {
+            static_assert(std::is_same_v<T, double>, "not a PLC type");
+            return DOUBLE;
+        }
+    }
+
+    /**
+     * @brief readTyped reads a variable of the typed registry, from the
+     * notification cache if it is updated by notifications
+     * @param id index of the variable given to BindTyped()
+     * @param value receives the value
+     * @return true if the reading succeeded
+     */
+    template <typename T>
+    bool ReadTyped(size_t id, T& value)
+    {
+        uint64_t raw;
+        if (!ReadTypedRaw(id, TypeOf<T>(), raw)) {
+            return false;
+        }
+        std::memcpy(&value, &raw, sizeof(T));
+        return true;
+    }
+
+    /**
+     * @brief writeTyped writes a variable of the typed registry
+     * @param id index of the variable given to BindTyped()
+     * @param value value to write
+     * @return true if the writing succeeded
+     */
+    template <typename T>
+    bool WriteTyped(size_t id, const T& value)
+    {
+        uint64_t raw = 0;
+        std::memcpy(&raw, &value, sizeof(T));
+        return WriteTypedRaw(id, TypeOf<T>(), raw);
+    }
+
+    /**
+     * @brief enableNotifications registers an on-change ADS notification for
+     * every aliased variable. Reads of these variables are then served from a
+     * cache updated by the notifications. The notifications are registered
+     * again whenever the connection is re-established. The supervisor thread
+     * reads the ADS state every heartbeat to notice a dead link or a stopped
+     * PLC, and the cache is not used while the last confirmation is older
+     * than ADS_CACHE_MAX_MISSED_HEARTBEATS heartbeats.
+     * @param cycle_ms how often the PLC checks the variables for changes in
+     * ms, 0 checks them every PLC cycle
+     * @param polled aliases of variables that change every cycle, they are
+     * always read from the PLC
+     * @return the number of variables registered now, 0 if the device is not
+     * connected yet
+     */
+    size_t EnableNotifications(
+        uint32_t cycle_ms,
+        const std::set<std::string>& polled = {});
+
+    /**
+     * @brief adsReadCached reads a variable from the notification cache
+     * without any network access or locking
+     * @param var_name name of the variable to read
+     * @return the value and the time it was received, empty if the variable
+     * is not updated by a notification, nothing was received yet or the
+     * connection was not confirmed recently
+     */
+    std::optional<CachedValue> AdsReadCached(const std::string& var_name);
+
     /**
      * @brief factory (re)-create an IADS variable
      * @param var_name the alias of the variable to (re)-create
@@ -187,7 +378,7 @@ public:
      * @return true if data published are valid
      * @return false otherwise
      */
-    const bool& GetState() const
+    bool GetState() const
     {
         return (m_device_state);
     }
@@ -196,11 +387,57 @@ public:
      * @brief getADSState
      * @return return current ADS state
      */
-    const int& GetADSState() const
+    int GetADSState() const
     {
         return (m_ads_state);
     }
 
+    /**
+     * @brief counters of the reconnection supervisor
+     */
+    struct ReconnectStats {
+        uint64_t attempts;   /*!< connection checks made while offline */
+        uint64_t reconnects; /*!< times the device came back */
+        bool offline;        /*!< reads and writes fail fast meanwhile */
+    };
+
+    /**
+     * @brief called after each reconnection with its duration and the number
+     * of attempts it took
+     */
+    using ReconnectHandler =
+        std::function<void(std::chrono::steady_clock::duration, uint32_t)>;
+
+    /**
+     * @brief setReconnectBackoff sets the delays between reconnection
+     * attempts, each delay is picked between half and all of the current one
+     * @param min the delay after the first failed attempt
+     * @param max the delay is doubled after each failed attempt up to max
+     */
+    void SetReconnectBackoff(
+        std::chrono::milliseconds min,
+        std::chrono::milliseconds max);
+
+    /**
+     * @brief setCacheHeartbeat sets how often the connection is checked while
+     * reads are served from the notification cache
+     * @param period the delay between two ADS state reads
+     */
+    void SetCacheHeartbeat(std::chrono::milliseconds period);
+
+    /**
+     * @brief setReconnectHandler sets the function called after each
+     * reconnection
+     * @param handler called on the supervisor thread, may be empty
+     */
+    void SetReconnectHandler(ReconnectHandler handler);
+
+    /**
+     * @brief getReconnectStats
+     * @return the counters of the reconnection supervisor
+     */
+    ReconnectStats GetReconnectStats() const;
+
     /**
      * @brief bindPLcVar creates IADS variables for aliased variables given in
      * configuration file
@@ -218,15 +455,49 @@ public:
     int CheckVariableType(const std::string& var_name);
 
     /**
-     * @brief acquireVariables get all ADS variables from the device
+     * @brief acquireVariables get all ADS variables from the device, from
+     * the symbol cache file if it holds the current symbol table
      */
     void AcquireVariables()
     {
+        std::unique_lock<std::shared_mutex> lock(m_bind_mutex);
         if (m_route && m_device_state) {
-            m_variable_ads = m_route->GetDeviceAdsVariables();
+            LoadSymbols();
         }
     }
 
+    /**
+     * @brief setResolveByName resolve only the configured variables by name
+     * instead of uploading the whole symbol table, the symbol cache file is
+     * then not used
+     * @param by_name true to resolve by name
+     */
+    void SetResolveByName(bool by_name)
+    {
+        m_resolve_by_name = by_name;
+    }
+
+    /**
+     * @brief setMaxRequestsInFlight sets how many requests are sent to the
+     * device before their responses arrive. Reads of different variables
+     * then overlap on the connection instead of waiting for each other.
+     * @param requests at least 1, 1 sends one request at a time
+     */
+    void SetMaxRequestsInFlight(uint32_t requests)
+    {
+        m_lane.SetCapacity(requests);
+    }
+
+    /**
+     * @brief setSymbolCacheFile keep the symbol table in a file, so that
+     * the table is only uploaded when the PLC program changes
+     * @param path the cache file, empty to upload the table every time
+     */
+    void SetSymbolCacheFile(const std::string& path)
+    {
+        m_symbol_cache_file = path;
+    }
+
     /**
      * @brief setName set the name of the device for configuration
      * @param name the name of the device
@@ -246,22 +517,243 @@ public:
     }
 
 private:
+    /**
+     * @brief a cached value. It is written by the ADS notification thread
+     * and read by any thread, readers retry while a write is in progress.
+     */
+    struct CacheSlot {
+        std::atomic<uint32_t> sequence{0};  // odd while written, 0 if empty
+        std::atomic<bool> registered{false};  // a notification updates it
+        std::atomic<uint64_t> value{0};       // raw value, zero extended
+        std::atomic<int64_t> updated{0};  // steady clock ticks of the update
+
+        void Store(uint64_t raw, int64_t time, bool if_empty);
+        bool Load(uint64_t& raw, int64_t& time) const;
+        void Clear();
+    };
+
+    /**
+     * @brief limits the requests in flight on the route. A write waiting for
+     * the route goes before every waiting read, so commands do not queue
+     * behind telemetry.
+     */
+    class RequestLane {
+    public:
+        /**
+         * @brief one side of the lane, usable with std::scoped_lock
+         */
+        struct Side {
+            RequestLane& lane;
+            const bool priority;  // served before the other side
+            void lock()
+            {
+                lane.Lock(priority);
+            }
+            void unlock()
+            {
+                lane.Unlock();
+            }
+        };
+
+        Side reads{*this, false};  // telemetry
+        Side writes{*this, true};  // commands
+
+        void SetCapacity(uint32_t capacity);
+
+    private:
+        void Lock(bool priority);
+        void Unlock();
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;           // wakes a waiting read
+        std::condition_variable m_priority_cv;  // wakes a waiting write
+        uint32_t m_capacity{ADS_MAX_REQUESTS_IN_FLIGHT};  // requests at once
+        uint32_t m_in_flight{0};         // requests sent, not answered yet
+        uint32_t m_priority_waiting{0};  // writes waiting for the route
+    };
+
+    /**
+     * @brief a variable updated by notifications
+     */
+    struct CacheEntry {
+        uint32_t slot{0};           // index in s_cache, passed as hUser
+        std::atomic<int> type{-1};  // the type of the variable as int
+    };
+
+    /**
+     * @brief LoadSymbols fills m_variable_ads by resolving the configured
+     * variables by name, from the symbol cache file, or by uploading the
+     * symbol table if the file does not hold the current one. Only the
+     * upload fills in variables that are not configured.
+     */
+    void LoadSymbols();
+
+    /**
+     * @brief RequestReconnect marks the device offline, so that reads and
+     * writes fail fast, and has the supervisor thread reconnect it
+     */
+    void RequestReconnect();
+
+    /**
+     * @brief Recover handles a failed access. A device error, such as an
+     * invalid handle or a symbol not found, re-creates the variables with
+     * Factory(). Any other error comes from the client or the link, the
+     * device is then reconnected off the caller's thread.
+     * @param var_names the aliases of the variables that failed
+     * @param error the ADS error of the access
+     */
+    void Recover(const std::vector<std::string>& var_names, long error);
+
+    /**
+     * @brief Supervise body of the supervisor thread. It retries
+     * ConnectionCheck() with an exponential backoff until the device is back
+     * and the variables are recreated, and checks the connection every
+     * heartbeat while the notification cache is used.
+     */
+    void Supervise();
+
+    /**
+     * @brief Heartbeat reads the ADS state to confirm the values of the
+     * notification cache
+     * @return false if the PLC is not running or unreachable, the cache is
+     * then invalidated
+     */
+    bool Heartbeat();
+
+    /**
+     * @brief CacheFresh
+     * @return true if the notification cache is registered and the
+     * connection was confirmed recently
+     */
+    bool CacheFresh() const;
+
+    /**
+     * @brief MapVariables maps the configured aliases to the variables of
+     * m_variable_ads. The variables of aliases no longer found are released
+     * and the types of the others updated. m_bind_mutex must be held
+     * exclusively.
+     * @return the aliases found
+     */
+    std::vector<std::string> MapVariables();
+
+    /**
+     * @brief CreateVariables (re)-creates the IADS variables of the given
+     * aliases. Their old handles are released in one sum-up exchange and the
+     * new ones acquired in another.
+     * @param var_names the aliases of the variables to (re)-create
+     * @return 0 if the handles were acquired, otherwise the ADS error. The
+     * variables without a handle are left null.
+     * m_bind_mutex must be held exclusively.
+     */
+    long CreateVariables(const std::vector<std::string>& var_names);
+
+    /**
+     * @brief NewVariable creates the IADS variable of a PLC type
+     * @param type the PLC type
+     * @param handle the symbol handle, moved into the variable if created
+     * @return the variable, nullptr if the type is not supported
+     */
+    IAdsVariable* NewVariable(const std::string& type, AdsHandle& handle);
+
+    /**
+     * @brief a variable of the typed registry
+     */
+    struct TypedSlot {
+        std::string alias;         // alias of the variable
+        int type;                  // the type of the C++ variable as int
+        bool configured{false};    // the PLC variable has that type
+        bool bound{false};         // its IADS variable exists
+        uint32_t index_group{0};   // of the IADS variable
+        uint32_t index_offset{0};  // handle of the IADS variable
+        uint32_t size{0};          // bytes of the PLC variable
+        int64_t cache_slot{-1};    // index in s_cache, -1 if not cached
+    };
+
+    /**
+     * @brief ReadTypedRaw reads a variable of the typed registry
+     * @param type the type as int the caller expects
+     * @param raw receives the value, zero extended
+     */
+    bool ReadTypedRaw(size_t id, int type, uint64_t& raw);
+
+    /**
+     * @brief WriteTypedRaw writes a variable of the typed registry
+     * @param type the type as int of the value
+     * @param raw the value, zero extended
+     */
+    bool WriteTypedRaw(size_t id, int type, uint64_t raw);
+
+    /**
+     * @brief UpdateTyped refreshes a typed variable from its IADS variable,
+     * m_bind_mutex must be held exclusively
+     */
+    void UpdateTyped(TypedSlot& typed);
+
+    /**
+     * @brief OnNotification stores a notified value in its cache slot, runs
+     * on the ADS notification thread
+     */
+    static void OnNotification(
+        const AmsAddr* addr,
+        const AdsNotificationHeader* notification,
+        uint32_t user);
+
+    /**
+     * @brief RegisterNotifications (re)-registers the notifications of all
+     * cached variables with one sum-up request, m_bind_mutex must be held
+     * exclusively
+     * @return the number of registered notifications
+     */
+    size_t RegisterNotifications();
+
+    /**
+     * @brief ReleaseNotifications deletes the registered notifications in
+     * one sum-up request, or only drops them locally when the PLC cannot be
+     * reached, so a lost link does not hold up the reconnection
+     * @param reachable the PLC answered on the current route
+     */
+    void ReleaseNotifications(bool reachable);
+
+    /**
+     * @brief CacheWrite updates the cache with a value written to the PLC
+     */
+    void CacheWrite(const std::string& name, const variant_t& value);
+
+    /**
+     * @brief ToRaw converts a value to the raw little endian bytes written to
+     * the PLC
+     * @return false if the value has no plain representation
+     */
+    static bool ToRaw(const variant_t& value, uint64_t& raw);
+
+    /**
+     * @brief ToVariant converts a raw value read from the PLC to its type
+     * @param type the type of the variable as int
+     * @param raw the value as read, zero extended
+     * @return variant_t value of the variable
+     */
+    static AdsInterface::variant_t ToVariant(int type, uint64_t raw);
+
     string m_remote_net_id;      /*!< the NetID of the ADS device*/
     string m_remote_ip_v4;       /*!< the IPV4 of the ADS device*/
     string m_local_net_id_param; /*!< the local net ID */
-    uint64_t m_temp;     /*!< a temp value for reading a variable value*/
     string m_name;       /*!< the name of the device for configuration*/
     YAML::Node m_config; /*!< the configuration file to use*/
-    int m_ads_state;     /*!< the last known state of ADS*/
-
-    AmsNetId* m_ams_net_id_remote_net_id; /*!< the NetID
-                                              structure of the ADS device */
-
-    AdsDevice* m_route; /*!< the ADS device route*/
-    bool m_device_state{
-        false};             /*!< the last known validity state of the values*/
-    std::mutex m_com_mutex; /*!< Communication mutex */
-    std::mutex m_mem_mutex; /*!< memory mutex */
+    std::atomic<int> m_ads_state{
+        ADSSTATE_INVALID}; /*!< the last known state of ADS*/
+
+    AmsNetId* m_ams_net_id_remote_net_id{
+        nullptr}; /*!< the NetID structure of the ADS device */
+
+    AdsDevice* m_route{nullptr}; /*!< the ADS device route*/
+    std::atomic<bool> m_device_state{
+        false}; /*!< the last known validity state of the values, false
+                   while the supervisor reconnects */
+    std::shared_mutex
+        m_bind_mutex; /*!< the route and the variable bindings. Held shared to
+                         use them, the requests then take turns on m_lane,
+                         and exclusively to change them */
+    RequestLane m_lane; /*!< the requests in flight on the route */
 
     std::map<std::string, std::string>
         m_variable_ads; /*!< a map with ADS name as key and the
@@ -278,5 +770,49 @@ private:
         m_variables_map; /*!< a map with alias name as key and a pair with the
                             type of the variable as string and it's value in
                             it's own type */
+
+    static std::array<CacheSlot, ADS_CACHE_MAX_VARIABLES>
+        s_cache; /*!< cached values of all devices, by hUser */
+    static std::atomic<uint32_t> s_cache_used; /*!< slots handed out */
+
+    bool m_notifications{false}; /*!< reads are served from the cache */
+    uint32_t m_notification_cycle_ms{0}; /*!< PLC change check period */
+    std::atomic<bool> m_cache_valid{
+        false}; /*!< the notifications of the current connection are
+                   registered */
+    std::atomic<int64_t> m_cache_confirmed{
+        0}; /*!< steady clock ticks of the last ADS state read in RUN */
+    std::atomic<int64_t> m_cache_max_age{
+        0}; /*!< steady clock ticks the cache is used after a confirmation */
+    std::map<std::string, CacheEntry>
+        m_cache_index; /*!< a map with alias name as key and its cache slot,
+                          only the types change once notifications are
+                          enabled */
+    std::vector<AdsHandle>
+        m_notification_handles; /*!< releasing them deletes the
+                                   notifications */
+    string m_symbol_cache_file; /*!< symbol table cache, empty if none */
+    bool m_resolve_by_name{false}; /*!< resolve the configured variables
+                                      only */
+    std::vector<TypedSlot> m_typed; /*!< the typed registry, by id. Its size
+                                       and cache slots are fixed once bound */
+
+    std::chrono::milliseconds m_backoff_min{
+        ADS_RECONNECT_BACKOFF_MIN_MS}; /*!< first reconnection delay */
+    std::chrono::milliseconds m_backoff_max{
+        ADS_RECONNECT_BACKOFF_MAX_MS}; /*!< largest reconnection delay */
+    std::chrono::milliseconds m_cache_heartbeat{
+        ADS_CACHE_HEARTBEAT_MS}; /*!< period of the cache confirmations */
+    bool m_heartbeat{false}; /*!< the supervisor confirms the cache */
+    ReconnectHandler m_reconnect_handler; /*!< called after reconnections */
+    std::atomic<uint64_t> m_reconnect_attempts{0}; /*!< see ReconnectStats */
+    std::atomic<uint64_t> m_reconnects{0};         /*!< see ReconnectStats */
+    std::mutex m_supervisor_mutex; /*!< protects the supervisor fields */
+    std::condition_variable
+        m_supervisor_cv; /*!< wakes the supervisor on requests and stop */
+    bool m_reconnect_requested{false}; /*!< a reconnection is pending */
+    bool m_supervisor_stop{false};     /*!< set by the destructor */
+    std::thread m_supervisor; /*!< reconnects the device off the callers'
+                                 threads, started last */
 };
 #endif  // ADS_INTERFACE_HPP
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef ADS_SYMBOL_CACHE_HPP
+#define ADS_SYMBOL_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+/**
+ * @brief On-disk copy of the PLC symbol table, names and types only.
+ *
+ * The file holds a header, the entries sorted by name and the strings they
+ * point into. It is memory-mapped and searched in place, nothing is parsed
+ * when it is opened. A file is only used while the symbol version and the
+ * upload info of the PLC are the ones it was written for.
+ */
+class AdsSymbolCache {
+public:
+    /**
+     * @brief identifies a symbol table, any change of the PLC program
+     * changes at least one field
+     */
+    struct Key {
+        uint32_t symbol_version; /*!< ADSIGRP_SYM_VERSION */
+        uint32_t symbols;        /*!< number of symbols of the upload info */
+        uint32_t symbol_size;    /*!< table size of the upload info */
+    };
+
+    AdsSymbolCache();
+
+    ~AdsSymbolCache();
+
+    AdsSymbolCache(const AdsSymbolCache&) = delete;
+    AdsSymbolCache& operator=(const AdsSymbolCache&) = delete;
+
+    /**
+     * @brief open maps a cache file
+     * @param path the cache file
+     * @param key the symbol table the file must hold
+     * @return true if the file exists, is well formed and holds that table
+     * @return false otherwise, the cache is then closed
+     */
+    bool Open(const std::string& path, const Key& key);
+
+    /**
+     * @brief close unmaps the cache file
+     */
+    void Close();
+
+    /**
+     * @brief write replaces a cache file, readers of the old file are not
+     * affected
+     * @param path the cache file
+     * @param key the symbol table written
+     * @param variables name and type of every symbol
+     * @return true if the file was written
+     */
+    static bool Write(
+        const std::string& path,
+        const Key& key,
+        const std::map<std::string, std::string>& variables);
+
+    /**
+     * @brief type finds the type of a symbol
+     * @param name the ADS name of the symbol
+     * @return the type, empty if the symbol is unknown or the cache closed
+     */
+    std::optional<std::string> Type(const std::string& name) const;
+
+    /**
+     * @brief size
+     * @return the number of symbols in the cache
+     */
+    size_t Size() const;
+
+private:
+    struct Header {
+        uint32_t magic;          /*!< CACHE_MAGIC */
+        uint32_t format;         /*!< CACHE_FORMAT */
+        Key key;                 /*!< the symbol table held */
+        uint32_t count;          /*!< number of entries */
+        uint64_t strings_size;   /*!< bytes of strings after the entries */
+    };
+
+    struct Entry {
+        uint32_t name_offset;  /*!< in the strings */
+        uint32_t type_offset;  /*!< in the strings */
+        uint16_t name_length;
+        uint16_t type_length;
+    };
+
+    const Header* m_header{nullptr}; /*!< start of the mapping */
+    const Entry* m_entries{nullptr}; /*!< sorted by name */
+    const char* m_strings{nullptr};  /*!< names and types */
+    size_t m_mapped_size{0};         /*!< size of the mapping */
+};
+#endif  // ADS_SYMBOL_CACHE_HPP
@@ -6,12 +6,16 @@
 
 // Header file
 #include "AdsInterface.hpp"
+#include "TRLLiftVariables.hpp"
 
 // Standard includes
+#include <chrono>
 #include <ctime>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -19,6 +23,27 @@
 // Logger
 #include <boost/log/trivial.hpp>
 
+/**
+ * @brief State of a lift read from the PLC in a single round trip
+ */
+struct LiftSnapshot {
+    std::optional<std::string> current_floor;      // empty if the read failed
+    std::optional<std::string> destination_floor;  // empty if the read failed
+    int door_state = 0;    // see LiftDoorState(), 0 if the read failed
+    int motion_state = 0;  // see LiftMotionState(), 0 if the read failed
+    int mode = 0;          // see CurrentMode(), 0 if the read failed
+};
+
+/**
+ * @brief Cost of one command exchange with the PLC
+ */
+struct LiftCommandStats {
+    std::chrono::steady_clock::duration exchange{};  // ADS sum-up round trip
+    std::optional<uint32_t>
+        plc_cycles;  // PLC cycles elapsed during the exchange, empty if the
+                     // optional plcCycleCount variable is not configured
+};
+
 class TRLLiftInterface {
 public:
     /**
@@ -103,20 +128,82 @@ public:
      */
     int LiftMotionState();
 
+    /**
+     * @brief reads a lift variable by its compile time index, without any
+     * lookup or variant conversion
+     * @return the value, empty if the read failed
+     */
+    template <LiftVar V>
+    std::optional<typename LiftVarInfo<V>::type> Read()
+    {
+        typename LiftVarInfo<V>::type value;
+        if (!m_adsinterface.ReadTyped(static_cast<size_t>(V), value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /**
+     * @brief writes a lift variable by its compile time index
+     * @param value the value to write
+     * @return true if the writing succeeded
+     */
+    template <LiftVar V>
+    bool Write(typename LiftVarInfo<V>::type value)
+    {
+        return m_adsinterface.WriteTyped(static_cast<size_t>(V), value);
+    }
+
+    /**
+     * @brief reads every state variable of the lift with a single ADS sum-up
+     * request instead of one request per variable
+     * @return the state of the lift with the mode already derived, fields
+     * whose variables could not be read keep their defaults
+     */
+    LiftSnapshot Snapshot();
+
     /**
      * @brief Sends the lift cabin to a specific floor and opens all available
-     * doors for that floor
+     * doors for that floor. The command is written and verified in a single
+     * ADS sum-up exchange.
+     * @param floor the destination floor
+     * @param stats receives the cost of the exchange if not null
      * @return 1 if request was sent out successfully
      * @return 0 otherwise
      */
-    bool CommandLift(const std::string &floor);
+    bool CommandLift(
+        const std::string &floor,
+        LiftCommandStats *stats = nullptr);
 
     /**
-     * @brief Returns control to lift and goes from AGV mode to Normal mode
+     * @brief Returns control to lift and goes from AGV mode to Normal mode.
+     * The command is written and verified in a single ADS sum-up exchange.
+     * @param stats receives the cost of the exchange if not null
      * @return 1 if request was sent out successfully
      * @return 0 otherwise
      */
-    bool EndLift();
+    bool EndLift(LiftCommandStats *stats = nullptr);
+
+    /**
+     * @brief completion of an asynchronous command, called with the result
+     * of the command and the cost of its exchange
+     */
+    using CommandHandler = std::function<void(bool, LiftCommandStats)>;
+
+    /**
+     * @brief Sends the same command as CommandLift() without waiting for the
+     * PLC
+     * @param floor the destination floor
+     * @param done called once from an ADS connection thread, or before
+     * returning if the command could not be sent. It must not block.
+     */
+    void CommandLiftAsync(const std::string &floor, CommandHandler done);
+
+    /**
+     * @brief Sends the same command as EndLift() without waiting for the PLC
+     * @param done called like the one of CommandLiftAsync()
+     */
+    void EndLiftAsync(CommandHandler done);
 
     /**
      * @brief Returns the name of the lift
@@ -126,9 +213,10 @@ public:
 
     /**
      * @brief Returns the session id of the lift
-     * @return session of the lift
+     * @return a copy of the session of the lift, it may be changed
+     * concurrently by the command executor
      */
-    const std::string &GetSessionID() const;
+    std::string GetSessionID() const;
 
     /**
      * @brief Sets the session id of the lift
@@ -136,11 +224,85 @@ public:
      */
     void SetSessionID(const std::string &session_id);
 
+    /**
+     * @brief Sets the function called after each reconnection to the PLC,
+     * reconnections are logged in any case
+     * @param handler called on the reconnection thread of the lift, may be
+     * empty
+     */
+    void SetReconnectHandler(AdsInterface::ReconnectHandler handler);
+
+    /**
+     * @brief Returns the reconnection counters of the lift
+     * @return the attempts and reconnections so far and whether the lift is
+     * offline, reads and commands then fail without waiting for the PLC
+     */
+    AdsInterface::ReconnectStats ReconnectStats() const;
+
 private:
+    /**
+     * @brief Runs a command exchange, enclosed by reads of plcCycleCount when
+     * it is configured
+     * @param operations the writes and verification reads of the command
+     * @param values receives one value per operation
+     * @param stats receives the cost of the exchange if not null
+     * @return true if the exchange succeeded
+     */
+    bool Exchange(
+        std::vector<AdsInterface::Operation> operations,
+        std::vector<AdsInterface::variant_t> &values,
+        LiftCommandStats *stats);
+
+    /**
+     * @brief Same as above without waiting for the PLC
+     * @param operations the writes and verification reads of the command
+     * @param done receives the result, one value per operation and the cost
+     * of the exchange
+     */
+    void ExchangeAsync(
+        std::vector<AdsInterface::Operation> operations,
+        std::function<void(
+            bool,
+            std::vector<AdsInterface::variant_t>,
+            LiftCommandStats)> done);
+
+    /**
+     * @brief Encloses the operations by reads of plcCycleCount when it is
+     * configured
+     * @return true if the reads were added
+     */
+    bool CountCycles(std::vector<AdsInterface::Operation> &operations);
+
+    /**
+     * @brief Removes the reads added by CountCycles() from the values and
+     * stores the PLC cycles elapsed between them
+     */
+    static void CountedCycles(
+        bool result,
+        bool count_cycles,
+        std::vector<AdsInterface::variant_t> &values,
+        LiftCommandStats &stats);
+
+    /**
+     * @brief The exchange of CommandLift(), verified by CommandVerified()
+     */
+    static std::vector<AdsInterface::Operation> CommandOperations(
+        int8_t destination);
+    static bool CommandVerified(
+        int8_t destination,
+        const std::vector<AdsInterface::variant_t> &values);
+
+    /**
+     * @brief The exchange of EndLift(), verified by EndVerified()
+     */
+    static std::vector<AdsInterface::Operation> EndOperations();
+    static bool EndVerified(const std::vector<AdsInterface::variant_t> &values);
+
     AdsInterface m_adsinterface;
     std::vector<std::string> m_available_floors;
     std::vector<int> m_available_modes;
     std::string m_name = "";
     std::string m_session_id = "";
+    mutable std::mutex m_session_mutex;  // protects m_session_id
 };
 #endif  // TRL_LIFT_INTERFACE_HPP
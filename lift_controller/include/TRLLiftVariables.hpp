@@ -0,0 +1,54 @@
+#ifndef TRL_LIFT_VARIABLES_HPP
+#define TRL_LIFT_VARIABLES_HPP
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Every lift variable with its C++ type, which must match the PLC
+ * type, and its alias in the configuration file.
+ *
+ * X(name, type, alias) is expanded for the LiftVar enum, the LiftVarInfo
+ * specializations and the bindings made by TRLLiftInterface::Initialize().
+ */
+#define TRL_LIFT_VARIABLES(X)                                 \
+    X(LiftTask, bool, "liftTask")                             \
+    X(EndLiftTask, bool, "endLiftTask")                       \
+    X(RobotDestinationFloor, int8_t, "robotDestinationFloor") \
+    X(DestinationFloor, int8_t, "liftDestinationFloor")       \
+    X(CurrentFloor, int8_t, "liftCurrentFloor")               \
+    X(DoorState, int16_t, "liftDoorState")                    \
+    X(MotionState, int16_t, "liftMotionState")                \
+    X(FireAlarm, bool, "fireAlarm")                           \
+    X(TurnKeyToManual, bool, "turnKeyToManual")               \
+    X(AgvMode, bool, "agvMode")                               \
+    X(RandomCount, int16_t, "randomCount")                    \
+    X(PlcCycleCount, uint32_t, "plcCycleCount")
+
+/**
+ * @brief Lift variables, the value is the index in the typed registry
+ */
+enum class LiftVar : size_t {
+#define TRL_LIFT_VARIABLE_ENUM(name, type, alias) name,
+    TRL_LIFT_VARIABLES(TRL_LIFT_VARIABLE_ENUM)
+#undef TRL_LIFT_VARIABLE_ENUM
+        Count
+};
+
+/**
+ * @brief Compile time description of a lift variable
+ */
+template <LiftVar V>
+struct LiftVarInfo;
+
+#define TRL_LIFT_VARIABLE_INFO(name, var_type, var_alias) \
+    template <>                                           \
+    struct LiftVarInfo<LiftVar::name> {                   \
+        using type = var_type;                            \
+        static constexpr const char *alias = var_alias;   \
+    };
+TRL_LIFT_VARIABLES(TRL_LIFT_VARIABLE_INFO)
+#undef TRL_LIFT_VARIABLE_INFO
+
+#endif  // TRL_LIFT_VARIABLES_HPP
@@ -11,7 +11,30 @@
 #include "standalone/AdsDef.h"
 #endif
 
+#include <functional>
 #include <iosfwd>
+
+/**
+ * @brief Completion of an asynchronous request like AdsAsyncReadReqEx2().
+ * Called exactly once with the ADS return code and the number of bytes read,
+ * from a thread of the connection. It must not block and must not issue
+ * synchronous requests, asynchronous ones are fine.
+ */
+using AdsCompletion = std::function<void (long error, uint32_t bytesRead)>;
+
+/**
+ * @brief One notification of a vectored registration with
+ * AdsSyncAddDeviceNotificationSumReqEx()
+ */
+struct AdsSumNotification {
+    uint32_t              indexGroup;
+    uint32_t              indexOffset;
+    AdsNotificationAttrib attrib;
+    uint32_t              hUser;         /**< passed to the callback function */
+    uint32_t              hNotification; /**< handle of the notification, set by the request */
+    long                  error;         /**< ADS error code of this entry, set by the request */
+};
+
 bool operator<(const AmsNetId& lhs, const AmsNetId& rhs);
 bool operator<(const AmsAddr& lhs, const AmsAddr& rhs);
 std::ostream& operator<<(std::ostream& os, const AmsNetId& netId);
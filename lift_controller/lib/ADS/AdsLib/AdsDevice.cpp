@@ -6,6 +6,151 @@
 #include "AdsDevice.h"
 #include "AdsException.h"
 #include "AdsLib.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+void PutLe32(uint8_t* buffer, uint32_t value)
+{
+    value = bhf::ads::htole(value);
+    memcpy(buffer, &value, sizeof(value));
+}
+
+uint32_t GetLe32(const uint8_t* buffer)
+{
+    return bhf::ads::letoh<uint32_t>(buffer);
+}
+
+/**
+ * Parses an ADSIGRP_SYM_INFOBYNAMEEX response into symbol, returns
+ * ADSERR_DEVICE_INVALIDSIZE if the response is truncated.
+ */
+long ParseSymbolInfo(const uint8_t* data, uint32_t length, AdsSymbolInfo& symbol)
+{
+    AdsSymbolEntry entry;
+    if (length < sizeof(entry)) {
+        return ADSERR_DEVICE_INVALIDSIZE;
+    }
+    memcpy(&entry, data, sizeof(entry));
+    const size_t typeStart = sizeof(entry) + entry.nameLength + 1;
+    if (typeStart + entry.typeLength > length) {
+        return ADSERR_DEVICE_INVALIDSIZE;
+    }
+    symbol.type.assign(reinterpret_cast<const char*>(data) + typeStart, entry.typeLength);
+    symbol.indexGroup = entry.iGroup;
+    symbol.indexOffset = entry.iOffs;
+    symbol.size = entry.size;
+    return 0;
+}
+
+/**
+ * Returns the end of the next chunk starting at begin. A chunk holds at most
+ * ADS_SUMUP_MAX_ENTRIES entries and its request and response stay within
+ * ADS_SUMUP_MAX_BYTES, unless a single entry exceeds it on its own.
+ */
+template<typename Entry, typename RequestBytes, typename ResponseBytes>
+size_t NextChunk(const Entry* entries, size_t begin, size_t count,
+                 RequestBytes requestBytes, ResponseBytes responseBytes)
+{
+    size_t request = 0;
+    size_t response = 0;
+    size_t end = begin;
+    while (end < count && end - begin < ADS_SUMUP_MAX_ENTRIES) {
+        request += requestBytes(entries[end]);
+        response += responseBytes(entries[end]);
+        if (end > begin && (request > ADS_SUMUP_MAX_BYTES || response > ADS_SUMUP_MAX_BYTES)) {
+            break;
+        }
+        ++end;
+    }
+    return end;
+}
+
+template<typename Entry>
+long FailFrom(Entry* entries, size_t begin, size_t count, long error)
+{
+    for (size_t i = begin; i < count; ++i) {
+        entries[i].error = error;
+    }
+    return error;
+}
+
+static const size_t SUM_READWRITE_ENTRY_SIZE = 4 * sizeof(uint32_t);
+static const size_t SUM_READWRITE_RESULT_SIZE = 2 * sizeof(uint32_t);
+
+size_t NextReadWriteChunk(const AdsSumReadWrite* entries, size_t begin, size_t count)
+{
+    return NextChunk(entries, begin, count,
+                     [](const AdsSumReadWrite& e) { return SUM_READWRITE_ENTRY_SIZE + e.writeLength; },
+                     [](const AdsSumReadWrite& e) { return SUM_READWRITE_RESULT_SIZE + e.readLength; });
+}
+
+/**
+ * Packs n entries into an ADSIGRP_SUMUP_READWRITE request, returns the size
+ * of the response.
+ */
+size_t PackSumReadWrite(const AdsSumReadWrite* entries, size_t n, std::vector<uint8_t>& request)
+{
+    // {group, offset, read length, write length} per entry followed by the
+    // data of every entry
+    size_t requestSize = n * SUM_READWRITE_ENTRY_SIZE;
+    size_t responseSize = n * SUM_READWRITE_RESULT_SIZE;
+    for (size_t i = 0; i < n; ++i) {
+        requestSize += entries[i].writeLength;
+        responseSize += entries[i].readLength;
+    }
+    request.resize(requestSize);
+    size_t offset = n * SUM_READWRITE_ENTRY_SIZE;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& e = entries[i];
+        PutLe32(&request[i * SUM_READWRITE_ENTRY_SIZE], e.indexGroup);
+        PutLe32(&request[i * SUM_READWRITE_ENTRY_SIZE + 4], e.indexOffset);
+        PutLe32(&request[i * SUM_READWRITE_ENTRY_SIZE + 8], e.readLength);
+        PutLe32(&request[i * SUM_READWRITE_ENTRY_SIZE + 12], e.writeLength);
+        memcpy(&request[offset], e.writeData, e.writeLength);
+        offset += e.writeLength;
+    }
+    return responseSize;
+}
+
+/**
+ * Distributes an ADSIGRP_SUMUP_READWRITE response of bytesRead bytes to the
+ * n entries of its request.
+ */
+void UnpackSumReadWrite(AdsSumReadWrite* entries, size_t n, const std::vector<uint8_t>& response,
+                        uint32_t bytesRead)
+{
+    // {error, returned length} per entry followed by the returned data,
+    // packed by the returned lengths
+    size_t offset = n * SUM_READWRITE_RESULT_SIZE;
+    for (size_t i = 0; i < n; ++i) {
+        auto& e = entries[i];
+        e.error = GetLe32(&response[i * SUM_READWRITE_RESULT_SIZE]);
+        const uint32_t length = GetLe32(&response[i * SUM_READWRITE_RESULT_SIZE + 4]);
+        if (length > e.readLength || offset + length > bytesRead) {
+            e.bytesRead = 0;
+            e.error = e.error ? e.error : ADSERR_DEVICE_INVALIDSIZE;
+            // the following data cannot be located any more
+            for (++i; i < n; ++i) {
+                entries[i].bytesRead = 0;
+                entries[i].error = ADSERR_DEVICE_INVALIDSIZE;
+            }
+            break;
+        }
+        e.bytesRead = length;
+        memcpy(e.readData, &response[offset], length);
+        offset += length;
+    }
+}
+}
+
+bool IsDeviceError(long error)
+{
+    return error >= ADSERR_DEVICE_ERROR && error < ADSERR_CLIENT_ERROR;
+}
+
 static AmsNetId* AddRoute(AmsNetId ams, const char* ip)
 {
     const auto error = bhf::ads::AddLocalRoute(ams, ip);
@@ -58,7 +203,6 @@ std::map<std::string,std::string> AdsDevice::GetDeviceAdsVariables() const
 {
     long 			nErr;
     uint32_t			uiIndex;
-    uint32_t			bytesReadInfo = 0;
     uint32_t			bytesReadEntry = 0;
     char* 			pchSymbols = NULL;
     AdsSymbolUploadInfo  adsSymbolUploadInfo;
@@ -67,15 +211,13 @@ std::map<std::string,std::string> AdsDevice::GetDeviceAdsVariables() const
 
 
     // Read the length of the variable declaration
-    nErr = ReadReqEx2(ADSIGRP_SYM_UPLOADINFO, 0x0, sizeof(AdsSymbolEntry), &adsSymbolUploadInfo, &bytesReadInfo);
-    if(nErr != 0 && bytesReadInfo != sizeof(adsSymbolUploadInfo)) {
-      throw AdsException(nErr);
-    }
+    adsSymbolUploadInfo = GetSymbolUploadInfo();
     pchSymbols = new char[adsSymbolUploadInfo.nSymSize];
 
     // Read information about the PLC variables 
     nErr = ReadReqEx2(ADSIGRP_SYM_UPLOAD, 0x0, adsSymbolUploadInfo.nSymSize, pchSymbols, &bytesReadEntry);
     if(nErr != 0 ) {
+      delete[] pchSymbols;
       throw AdsException(nErr);
     }
 
@@ -101,9 +243,72 @@ std::map<std::string,std::string> AdsDevice::GetDeviceAdsVariables() const
 
     }
 
+    delete[] pchSymbols;
     return lADSVariables;
 }
 
+AdsSymbolUploadInfo AdsDevice::GetSymbolUploadInfo() const
+{
+    AdsSymbolUploadInfo info {};
+    uint32_t bytesRead = 0;
+    const auto error = ReadReqEx2(ADSIGRP_SYM_UPLOADINFO, 0, sizeof(info), &info, &bytesRead);
+    if (error || (bytesRead != sizeof(info))) {
+        throw AdsException(error ? error : ADSERR_DEVICE_INVALIDSIZE);
+    }
+    return info;
+}
+
+uint8_t AdsDevice::GetSymbolVersion() const
+{
+    uint8_t version = 0;
+    uint32_t bytesRead = 0;
+    const auto error = ReadReqEx2(ADSIGRP_SYM_VERSION, 0, sizeof(version), &version, &bytesRead);
+    if (error || (bytesRead != sizeof(version))) {
+        throw AdsException(error ? error : ADSERR_DEVICE_INVALIDSIZE);
+    }
+    return version;
+}
+
+long AdsDevice::GetSymbolInfos(AdsSymbolInfo* const symbols, const size_t count) const
+{
+    // room for the entry, name, type and a short comment, symbols with a
+    // longer comment are resolved again on their own
+    static const uint32_t INFO_SIZE = 1024;
+    static const uint32_t INFO_MAX_SIZE = 0xFFFF;
+    std::vector<uint8_t> buffers(count * INFO_SIZE);
+    std::vector<AdsSumReadWrite> entries(count);
+    for (size_t i = 0; i < count; ++i) {
+        entries[i] = AdsSumReadWrite {
+            ADSIGRP_SYM_INFOBYNAMEEX, 0,
+            INFO_SIZE, &buffers[i * INFO_SIZE],
+            static_cast<uint32_t>(symbols[i].name.size()), symbols[i].name.c_str(),
+            0, 0
+        };
+    }
+    const long error = SumReadWriteReq(entries.data(), count);
+
+    std::vector<uint8_t> large;
+    for (size_t i = 0; i < count; ++i) {
+        auto& symbol = symbols[i];
+        const auto& e = entries[i];
+        symbol.error = e.error;
+        if (e.error == ADSERR_DEVICE_INVALIDSIZE && !error) {
+            large.resize(INFO_MAX_SIZE);
+            uint32_t bytesRead = 0;
+            symbol.error = ReadWriteReqEx2(ADSIGRP_SYM_INFOBYNAMEEX, 0,
+                                           large.size(), large.data(),
+                                           symbol.name.size(), symbol.name.c_str(),
+                                           &bytesRead);
+            if (!symbol.error) {
+                symbol.error = ParseSymbolInfo(large.data(), bytesRead, symbol);
+            }
+        } else if (!e.error) {
+            symbol.error = ParseSymbolInfo(&buffers[i * INFO_SIZE], e.bytesRead, symbol);
+        }
+    }
+    return error;
+}
+
 
 std::string AdsDevice::GetNameVar(AdsSymbolEntry* pAdsSymbolEntry) const
 {
@@ -153,6 +358,57 @@ AdsHandle AdsDevice::GetHandle(const std::string& symbolName) const
     return {new uint32_t {handle}, {std::bind(&AdsDevice::DeleteSymbolHandle, this, std::placeholders::_1)}};
 }
 
+long AdsDevice::GetHandles(const std::string* const symbolNames,
+                           const size_t             count,
+                           std::vector<AdsHandle>&  handles) const
+{
+    std::vector<uint32_t> values(count);
+    std::vector<AdsSumReadWrite> entries(count);
+    for (size_t i = 0; i < count; ++i) {
+        entries[i] = AdsSumReadWrite {
+            ADSIGRP_SYM_HNDBYNAME, 0,
+            sizeof(values[i]), &values[i],
+            static_cast<uint32_t>(symbolNames[i].size()), symbolNames[i].c_str(),
+            0, 0
+        };
+    }
+    const long error = SumReadWriteReq(entries.data(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto& e = entries[i];
+        if (e.error || (e.bytesRead != sizeof(values[i]))) {
+            handles.push_back({new uint32_t {0}, {[](uint32_t){ return 0; }}});
+            continue;
+        }
+        handles.push_back({new uint32_t {bhf::ads::letoh(values[i])},
+                           {std::bind(&AdsDevice::DeleteSymbolHandle, this, std::placeholders::_1)}});
+    }
+    return error;
+}
+
+long AdsDevice::ReleaseHandles(std::vector<AdsHandle>& handles) const
+{
+    std::vector<uint32_t> values;
+    for (auto& handle : handles) {
+        if (handle && *handle) {
+            values.push_back(bhf::ads::htole(*handle));
+        }
+        // released below, not by the deleter
+        delete handle.release();
+    }
+    handles.clear();
+
+    std::vector<AdsSumWrite> entries(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        entries[i] = AdsSumWrite {
+            ADSIGRP_SYM_RELEASEHND, 0,
+            sizeof(values[i]), &values[i],
+            0
+        };
+    }
+    return SumWriteReq(entries.data(), entries.size());
+}
+
 AdsHandle AdsDevice::GetHandle(const uint32_t               indexGroup,
                                const uint32_t               indexOffset,
                                const AdsNotificationAttrib& notificationAttributes,
@@ -275,3 +531,290 @@ long AdsDevice::WriteReqEx(uint32_t group, uint32_t offset, uint32_t length, con
 {
     return AdsSyncWriteReqEx(GetLocalPort(), &m_Addr, group, offset, length, buffer);
 }
+
+long AdsDevice::ReadReqAsync(uint32_t group, uint32_t offset, uint32_t length, void* buffer,
+                             AdsCompletion completion) const
+{
+    return AdsAsyncReadReqEx2(GetLocalPort(), &m_Addr, group, offset, length, buffer,
+                              std::move(completion));
+}
+
+long AdsDevice::ReadWriteReqAsync(uint32_t      indexGroup,
+                                  uint32_t      indexOffset,
+                                  uint32_t      readLength,
+                                  void*         readData,
+                                  uint32_t      writeLength,
+                                  const void*   writeData,
+                                  AdsCompletion completion) const
+{
+    return AdsAsyncReadWriteReqEx2(GetLocalPort(),
+                                   &m_Addr,
+                                   indexGroup, indexOffset,
+                                   readLength, readData,
+                                   writeLength, writeData,
+                                   std::move(completion)
+                                   );
+}
+
+long AdsDevice::WriteReqAsync(uint32_t group, uint32_t offset, uint32_t length, const void* buffer,
+                              AdsCompletion completion) const
+{
+    return AdsAsyncWriteReqEx(GetLocalPort(), &m_Addr, group, offset, length, buffer,
+                              std::move(completion));
+}
+
+long AdsDevice::SumReadReq(AdsSumRead* const entries, const size_t count) const
+{
+    static const size_t ENTRY_SIZE = 3 * sizeof(uint32_t);
+    std::vector<uint8_t> request;
+    std::vector<uint8_t> response;
+    size_t begin = 0;
+    while (begin < count) {
+        const size_t end = NextChunk(entries, begin, count,
+                                     [](const AdsSumRead&) { return ENTRY_SIZE; },
+                                     [](const AdsSumRead& e) { return sizeof(uint32_t) + e.length; });
+        const size_t n = end - begin;
+        if (n == 1) {
+            auto& e = entries[begin];
+            uint32_t bytesRead = 0;
+            e.error = ReadReqEx2(e.indexGroup, e.indexOffset, e.length, e.data, &bytesRead);
+            if (e.error && !IsDeviceError(e.error)) {
+                return FailFrom(entries, begin, count, e.error);
+            }
+            if (!e.error && bytesRead != e.length) {
+                e.error = ADSERR_DEVICE_INVALIDSIZE;
+            }
+            begin = end;
+            continue;
+        }
+
+        // {group, offset, length} per entry
+        request.resize(n * ENTRY_SIZE);
+        size_t responseSize = n * sizeof(uint32_t);
+        for (size_t i = 0; i < n; ++i) {
+            const auto& e = entries[begin + i];
+            PutLe32(&request[i * ENTRY_SIZE], e.indexGroup);
+            PutLe32(&request[i * ENTRY_SIZE + 4], e.indexOffset);
+            PutLe32(&request[i * ENTRY_SIZE + 8], e.length);
+            responseSize += e.length;
+        }
+        response.resize(responseSize);
+        uint32_t bytesRead = 0;
+        long error = ReadWriteReqEx2(ADSIGRP_SUMUP_READ, n,
+                                     responseSize, response.data(),
+                                     request.size(), request.data(),
+                                     &bytesRead);
+        if (!error && bytesRead != responseSize) {
+            error = ADSERR_DEVICE_INVALIDSIZE;
+        }
+        if (error) {
+            return FailFrom(entries, begin, count, error);
+        }
+
+        // {error} per entry followed by the data of every entry
+        size_t offset = n * sizeof(uint32_t);
+        for (size_t i = 0; i < n; ++i) {
+            auto& e = entries[begin + i];
+            e.error = GetLe32(&response[i * sizeof(uint32_t)]);
+            if (!e.error) {
+                memcpy(e.data, &response[offset], e.length);
+            }
+            offset += e.length;
+        }
+        begin = end;
+    }
+    return 0;
+}
+
+long AdsDevice::SumWriteReq(AdsSumWrite* const entries, const size_t count) const
+{
+    static const size_t ENTRY_SIZE = 3 * sizeof(uint32_t);
+    std::vector<uint8_t> request;
+    std::vector<uint8_t> response;
+    size_t begin = 0;
+    while (begin < count) {
+        const size_t end = NextChunk(entries, begin, count,
+                                     [](const AdsSumWrite& e) { return ENTRY_SIZE + e.length; },
+                                     [](const AdsSumWrite&) { return sizeof(uint32_t); });
+        const size_t n = end - begin;
+        if (n == 1) {
+            auto& e = entries[begin];
+            e.error = WriteReqEx(e.indexGroup, e.indexOffset, e.length, e.data);
+            if (e.error && !IsDeviceError(e.error)) {
+                return FailFrom(entries, begin, count, e.error);
+            }
+            begin = end;
+            continue;
+        }
+
+        // {group, offset, length} per entry followed by the data of every entry
+        size_t requestSize = n * ENTRY_SIZE;
+        for (size_t i = 0; i < n; ++i) {
+            requestSize += entries[begin + i].length;
+        }
+        request.resize(requestSize);
+        size_t offset = n * ENTRY_SIZE;
+        for (size_t i = 0; i < n; ++i) {
+            const auto& e = entries[begin + i];
+            PutLe32(&request[i * ENTRY_SIZE], e.indexGroup);
+            PutLe32(&request[i * ENTRY_SIZE + 4], e.indexOffset);
+            PutLe32(&request[i * ENTRY_SIZE + 8], e.length);
+            memcpy(&request[offset], e.data, e.length);
+            offset += e.length;
+        }
+        response.resize(n * sizeof(uint32_t));
+        uint32_t bytesRead = 0;
+        long error = ReadWriteReqEx2(ADSIGRP_SUMUP_WRITE, n,
+                                     response.size(), response.data(),
+                                     request.size(), request.data(),
+                                     &bytesRead);
+        if (!error && bytesRead != response.size()) {
+            error = ADSERR_DEVICE_INVALIDSIZE;
+        }
+        if (error) {
+            return FailFrom(entries, begin, count, error);
+        }
+
+        // {error} per entry
+        for (size_t i = 0; i < n; ++i) {
+            entries[begin + i].error = GetLe32(&response[i * sizeof(uint32_t)]);
+        }
+        begin = end;
+    }
+    return 0;
+}
+
+long AdsDevice::SumReadWriteReq(AdsSumReadWrite* const entries, const size_t count) const
+{
+    std::vector<uint8_t> request;
+    std::vector<uint8_t> response;
+    size_t begin = 0;
+    while (begin < count) {
+        const size_t end = NextReadWriteChunk(entries, begin, count);
+        const size_t n = end - begin;
+        if (n == 1) {
+            auto& e = entries[begin];
+            e.bytesRead = 0;
+            e.error = ReadWriteReqEx2(e.indexGroup, e.indexOffset,
+                                      e.readLength, e.readData,
+                                      e.writeLength, e.writeData,
+                                      &e.bytesRead);
+            if (e.error && !IsDeviceError(e.error)) {
+                return FailFrom(entries, begin, count, e.error);
+            }
+            begin = end;
+            continue;
+        }
+
+        response.resize(PackSumReadWrite(&entries[begin], n, request));
+        uint32_t bytesRead = 0;
+        long error = ReadWriteReqEx2(ADSIGRP_SUMUP_READWRITE, n,
+                                     response.size(), response.data(),
+                                     request.size(), request.data(),
+                                     &bytesRead);
+        if (!error && bytesRead < n * SUM_READWRITE_RESULT_SIZE) {
+            error = ADSERR_DEVICE_INVALIDSIZE;
+        }
+        if (error) {
+            return FailFrom(entries, begin, count, error);
+        }
+        UnpackSumReadWrite(&entries[begin], n, response, bytesRead);
+        begin = end;
+    }
+    return 0;
+}
+
+long AdsDevice::SumReadWriteReqAsync(AdsSumReadWrite* const entries, const size_t count,
+                                     AdsCompletion completion) const
+{
+    if (!count || NextReadWriteChunk(entries, 0, count) != count || !completion) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+    if (count == 1) {
+        auto& e = *entries;
+        e.bytesRead = 0;
+        return ReadWriteReqAsync(e.indexGroup, e.indexOffset,
+                                 e.readLength, e.readData,
+                                 e.writeLength, e.writeData,
+                                 [&e, completion](long error, uint32_t bytesRead) {
+            e.error = error;
+            e.bytesRead = bytesRead;
+            completion(IsDeviceError(error) ? 0 : error, 0);
+        });
+    }
+
+    // the response buffer lives until the completion, the request is copied
+    // when it is sent
+    std::vector<uint8_t> request;
+    auto response = std::make_shared<std::vector<uint8_t> >();
+    response->resize(PackSumReadWrite(entries, count, request));
+    return ReadWriteReqAsync(ADSIGRP_SUMUP_READWRITE, count,
+                             response->size(), response->data(),
+                             request.size(), request.data(),
+                             [entries, count, response, completion](long error, uint32_t bytesRead) {
+        if (!error && bytesRead < count * SUM_READWRITE_RESULT_SIZE) {
+            error = ADSERR_DEVICE_INVALIDSIZE;
+        }
+        if (error) {
+            FailFrom(entries, 0, count, error);
+        } else {
+            UnpackSumReadWrite(entries, count, *response, bytesRead);
+        }
+        completion(error, 0);
+    });
+}
+
+long AdsDevice::SumAddNotificationReq(AdsSumNotification* const entries,
+                                      const size_t              count,
+                                      PAdsNotificationFuncEx    callback,
+                                      std::vector<AdsHandle>&   handles) const
+{
+    // AdsAddDeviceNotificationRequest per entry, {error, handle} per result
+    static const size_t ENTRY_SIZE = 10 * sizeof(uint32_t);
+    static const size_t RESULT_SIZE = 2 * sizeof(uint32_t);
+    long result = 0;
+    size_t begin = 0;
+    while (begin < count) {
+        const size_t end = NextChunk(entries, begin, count,
+                                     [](const AdsSumNotification&) { return ENTRY_SIZE; },
+                                     [](const AdsSumNotification&) { return RESULT_SIZE; });
+        const long error = AdsSyncAddDeviceNotificationSumReqEx(*m_LocalPort, &m_Addr,
+                                                                &entries[begin], end - begin,
+                                                                callback);
+        if (error) {
+            result = FailFrom(entries, begin, count, error);
+            break;
+        }
+        begin = end;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t handle = entries[i].error ? 0 : entries[i].hNotification;
+        handles.push_back({new uint32_t {handle},
+                           {std::bind(&AdsDevice::DeleteNotificationHandle, this, std::placeholders::_1)}});
+    }
+    return result;
+}
+
+long AdsDevice::DeleteNotificationHandles(std::vector<AdsHandle>& handles, uint32_t tmms) const
+{
+    std::vector<uint32_t> values;
+    for (auto& handle : handles) {
+        if (handle && *handle) {
+            values.push_back(*handle);
+        }
+        // deleted below, not by the deleter
+        delete handle.release();
+    }
+    handles.clear();
+
+    long result = 0;
+    for (size_t begin = 0; begin < values.size(); begin += ADS_SUMUP_MAX_ENTRIES) {
+        const size_t count = std::min(values.size() - begin, ADS_SUMUP_MAX_ENTRIES);
+        const long error = AdsSyncDelDeviceNotificationSumReqEx(*m_LocalPort, &m_Addr,
+                                                                &values[begin], count,
+                                                                result ? 0 : tmms);
+        result = result ? result : error;
+    }
+    return result;
+}
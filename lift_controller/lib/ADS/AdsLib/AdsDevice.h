@@ -12,6 +12,7 @@
 #include <functional>
 #include <memory>
 #include <map>
+#include <vector>
 #include <iostream>
 /**
  * @brief Maximum size for device name.
@@ -53,6 +54,73 @@ using AdsResource = std::unique_ptr<T, ResourceDeleter<T> >;
 
 using AdsHandle = AdsResource<uint32_t>;
 
+/**
+ * @brief Maximum number of sub-requests in one sum-up request, larger
+ * vectored requests are split.
+ */
+static const size_t ADS_SUMUP_MAX_ENTRIES = 500;
+
+/**
+ * @brief Maximum payload of one sum-up request or response in bytes, larger
+ * vectored requests are split.
+ */
+static const size_t ADS_SUMUP_MAX_BYTES = 64 * 1024;
+
+/**
+ * @brief One read of a vectored read. To read a variable by handle use
+ * ADSIGRP_SYM_VALBYHND as indexGroup and the handle as indexOffset.
+ */
+struct AdsSumRead {
+    uint32_t indexGroup;
+    uint32_t indexOffset;
+    uint32_t length;    /**< bytes to read into data */
+    void*    data;
+    long     error;     /**< ADS error code of this read, set by the request */
+};
+
+/**
+ * @brief One write of a vectored write, addressed like AdsSumRead.
+ */
+struct AdsSumWrite {
+    uint32_t    indexGroup;
+    uint32_t    indexOffset;
+    uint32_t    length; /**< bytes to write from data */
+    const void* data;
+    long        error;  /**< ADS error code of this write, set by the request */
+};
+
+/**
+ * @brief One read/write of a vectored read/write, e.g. ADSIGRP_SYM_HNDBYNAME.
+ */
+struct AdsSumReadWrite {
+    uint32_t    indexGroup;
+    uint32_t    indexOffset;
+    uint32_t    readLength;  /**< capacity of readData */
+    void*       readData;
+    uint32_t    writeLength; /**< bytes to write from writeData */
+    const void* writeData;
+    uint32_t    bytesRead;   /**< bytes returned in readData, set by the request */
+    long        error;       /**< ADS error code of this entry, set by the request */
+};
+
+/**
+ * @brief A symbol resolved by name with ADSIGRP_SYM_INFOBYNAMEEX.
+ */
+struct AdsSymbolInfo {
+    std::string name;        /**< ADS name of the symbol, set by the caller */
+    std::string type;        /**< PLC type name, set by the request */
+    uint32_t    indexGroup;  /**< set by the request */
+    uint32_t    indexOffset; /**< set by the request */
+    uint32_t    size;        /**< bytes of the symbol, set by the request */
+    long        error;       /**< ADS error code of this symbol, set by the request */
+};
+
+/**
+ * @brief Returns true if error was reported by the target device, the request
+ * then made the round trip. Other errors come from the client or the routing.
+ */
+bool IsDeviceError(long error);
+
 struct AdsDevice {
     AdsDevice(const std::string& ipV4, AmsNetId netId, uint16_t port);
 
@@ -62,12 +130,49 @@ struct AdsDevice {
     /** Get list of ADS variable in PLC by name/type of data */
     std::map<std::string,std::string> GetDeviceAdsVariables() const;
 
+    /** Get number and total size of the symbols of GetDeviceAdsVariables() */
+    AdsSymbolUploadInfo GetSymbolUploadInfo() const;
+
+    /** Get the symbol version, it changes whenever the PLC symbols change */
+    uint8_t GetSymbolVersion() const;
+
+    /**
+     * Resolve only the given symbols, batched in sum-up read/write requests
+     * like SumReadWriteReq(). The cost does not depend on the size of the
+     * PLC program, unlike GetDeviceAdsVariables().
+     * @return 0 if every round trip succeeded, otherwise the error of the
+     * failed round trip. Every symbol receives its own error code.
+     */
+    long GetSymbolInfos(AdsSymbolInfo* symbols, size_t count) const;
+
     /** Get handle to access AdsVariable by indexGroup/Offset */
     AdsHandle GetHandle(uint32_t offset) const;
 
     /** Get handle for access by symbol name */
     AdsHandle GetHandle(const std::string& symbolName) const;
 
+    /**
+     * Get handles for access by symbol name with ADSIGRP_SYM_HNDBYNAME, batched
+     * in sum-up read/write requests like SumReadWriteReq(). One handle is
+     * appended to handles per name, names with an error get an empty handle.
+     * Every handle releases itself on destruction, ReleaseHandles() releases
+     * many of them at once.
+     * @return 0 if every round trip succeeded, otherwise the error of the
+     * failed round trip
+     */
+    long GetHandles(const std::string*      symbolNames,
+                    size_t                  count,
+                    std::vector<AdsHandle>& handles) const;
+
+    /**
+     * Release symbol handles with ADSIGRP_SYM_RELEASEHND, batched in sum-up
+     * write requests like SumWriteReq(). handles is emptied even if the
+     * release fails, the handles are not released again on destruction.
+     * @return 0 if every round trip succeeded, otherwise the error of the
+     * failed round trip
+     */
+    long ReleaseHandles(std::vector<AdsHandle>& handles) const;
+
     /** Get notification handle */
     AdsHandle GetHandle(uint32_t                     indexGroup,
                         uint32_t                     indexOffset,
@@ -96,6 +201,72 @@ struct AdsDevice {
                          uint32_t*   bytesRead) const;
     long WriteReqEx(uint32_t group, uint32_t offset, uint32_t length, const void* buffer) const;
 
+    /**
+     * Asynchronous counterparts of the requests above, see AdsAsyncReadReqEx2().
+     * They return once the request is sent, the completion is called later
+     * from a thread of the connection and only if they returned 0. Read
+     * buffers must stay valid until then, write data is copied.
+     */
+    long ReadReqAsync(uint32_t group, uint32_t offset, uint32_t length, void* buffer,
+                      AdsCompletion completion) const;
+    long ReadWriteReqAsync(uint32_t      indexGroup,
+                           uint32_t      indexOffset,
+                           uint32_t      readLength,
+                           void*         readData,
+                           uint32_t      writeLength,
+                           const void*   writeData,
+                           AdsCompletion completion) const;
+    long WriteReqAsync(uint32_t group, uint32_t offset, uint32_t length, const void* buffer,
+                       AdsCompletion completion) const;
+
+    /**
+     * Vectored requests built on ADSIGRP_SUMUP_READ/WRITE/READWRITE. The
+     * entries are packed into as few sum-up round trips as the
+     * ADS_SUMUP_MAX_ENTRIES and ADS_SUMUP_MAX_BYTES limits allow, a chunk
+     * holding a single entry is sent as a plain request, which counts as a
+     * failed round trip unless the error comes from the device. Every entry
+     * receives its own error code.
+     * @return 0 if every round trip succeeded, otherwise the error of the
+     * failed round trip. Its entries and all following ones get that error
+     * and are not sent.
+     */
+    long SumReadReq(AdsSumRead* entries, size_t count) const;
+    long SumWriteReq(AdsSumWrite* entries, size_t count) const;
+    long SumReadWriteReq(AdsSumReadWrite* entries, size_t count) const;
+
+    /**
+     * Asynchronous SumReadWriteReq() limited to a single sum-up round trip,
+     * the entries must stay valid until the completion is called.
+     * @return ADSERR_CLIENT_INVALIDPARM if the entries do not fit a single
+     * round trip, otherwise the error of sending the request. The completion
+     * receives the error of the round trip like SumReadWriteReq() returns it.
+     */
+    long SumReadWriteReqAsync(AdsSumReadWrite* entries, size_t count, AdsCompletion completion) const;
+
+    /**
+     * Defines a notification for every entry with ADSIGRP_SUMUP_ADDDEVNOTE
+     * requests, chunked like the vectored requests above. One handle is
+     * appended to handles per entry, entries with an error get an empty
+     * handle. Releasing a handle deletes its notification.
+     * @return 0 if every round trip succeeded, otherwise the error of the
+     * failed round trip
+     */
+    long SumAddNotificationReq(AdsSumNotification*     entries,
+                               size_t                  count,
+                               PAdsNotificationFuncEx  callback,
+                               std::vector<AdsHandle>& handles) const;
+
+    /**
+     * Deletes the notifications of handles with ADSIGRP_SUMUP_DELDEVNOTE
+     * requests of ADS_SUMUP_MAX_ENTRIES handles each, every request waits
+     * at most tmms ms. A tmms of 0 sends no request, for a connection known
+     * to be lost. handles is emptied even if the deletion fails, their
+     * callbacks are not called anymore.
+     * @return 0 if every round trip succeeded, otherwise the error of the
+     * failed round trip. The following handles are then only dropped.
+     */
+    long DeleteNotificationHandles(std::vector<AdsHandle>& handles, uint32_t tmms) const;
+
     AdsResource<const AmsNetId> m_NetId;
     const AmsAddr m_Addr;
 private:
@@ -11,6 +11,7 @@
 #include "standalone/AdsLib.h"
 #endif
 
+#include "AdsDef.h"
 #include "Sockets.h"
 
 /**
@@ -92,6 +93,67 @@ long AdsSyncWriteReqEx(long           port,
                        uint32_t       bufferLength,
                        const void*    buffer);
 
+/**
+ * Reads data from an ADS server without waiting for the response, see AdsSyncReadReqEx2().
+ * @param[in] port port number of an Ads port that had previously been opened with AdsPortOpenEx().
+ * @param[in] pAddr Structure with NetId and port number of the ADS server.
+ * @param[in] indexGroup Index Group.
+ * @param[in] indexOffset Index Offset.
+ * @param[in] bufferLength Length of the data in bytes.
+ * @param[out] buffer Pointer to a data buffer that will receive the data, it must stay valid until the completion is called.
+ * @param[in] completion called once the response arrived or the request timed out.
+ * @return [ADS Return Code](https://infosys.beckhoff.com/content/1031/tcadscommon/html/ads_returncodes.htm?id=1666172286265530469) of sending the request. The completion is only called if the request was sent.
+ */
+long AdsAsyncReadReqEx2(long           port,
+                        const AmsAddr* pAddr,
+                        uint32_t       indexGroup,
+                        uint32_t       indexOffset,
+                        uint32_t       bufferLength,
+                        void*          buffer,
+                        AdsCompletion  completion);
+
+/**
+ * Writes data into an ADS server and receives data back without waiting for the response, see AdsSyncReadWriteReqEx2().
+ * @param[in] port  port number of an Ads port that had previously been opened with AdsPortOpenEx().
+ * @param[in] pAddr Structure with NetId and port number of the ADS server.
+ * @param[in] indexGroup Index Group.
+ * @param[in] indexOffset Index Offset.
+ * @param[in] readLength Length, in bytes, of the read buffer readData.
+ * @param[out] readData Buffer for data read from the ADS server, it must stay valid until the completion is called.
+ * @param[in] writeLength Length of the data, in bytes, send to the ADS server.
+ * @param[in] writeData Buffer with data send to the ADS server, copied before the call returns.
+ * @param[in] completion called once the response arrived or the request timed out.
+ * @return [ADS Return Code](https://infosys.beckhoff.com/content/1031/tcadscommon/html/ads_returncodes.htm?id=1666172286265530469) of sending the request. The completion is only called if the request was sent.
+ */
+long AdsAsyncReadWriteReqEx2(long           port,
+                             const AmsAddr* pAddr,
+                             uint32_t       indexGroup,
+                             uint32_t       indexOffset,
+                             uint32_t       readLength,
+                             void*          readData,
+                             uint32_t       writeLength,
+                             const void*    writeData,
+                             AdsCompletion  completion);
+
+/**
+ * Writes data to an ADS server without waiting for the response, see AdsSyncWriteReqEx().
+ * @param[in] port port number of an Ads port that had previously been opened with AdsPortOpenEx().
+ * @param[in] pAddr Structure with NetId and port number of the ADS server.
+ * @param[in] indexGroup Index Group.
+ * @param[in] indexOffset Index Offset.
+ * @param[in] bufferLength Length of the data, in bytes, send to the ADS server.
+ * @param[in] buffer Buffer with data send to the ADS server, copied before the call returns.
+ * @param[in] completion called once the response arrived or the request timed out.
+ * @return [ADS Return Code](https://infosys.beckhoff.com/content/1031/tcadscommon/html/ads_returncodes.htm?id=1666172286265530469) of sending the request. The completion is only called if the request was sent.
+ */
+long AdsAsyncWriteReqEx(long           port,
+                        const AmsAddr* pAddr,
+                        uint32_t       indexGroup,
+                        uint32_t       indexOffset,
+                        uint32_t       bufferLength,
+                        const void*    buffer,
+                        AdsCompletion  completion);
+
 /**
  * Changes the ADS status and the device status of an ADS server.
  * @param[in] port port number of an Ads port that had previously been opened with AdsPortOpenEx().
@@ -132,6 +194,23 @@ long AdsSyncAddDeviceNotificationReqEx(long                         port,
                                        uint32_t                     hUser,
                                        uint32_t*                    pNotification);
 
+/**
+ * Defines several notifications within an ADS server with a single
+ * ADSIGRP_SUMUP_ADDDEVNOTE request. All notifications share one callback
+ * function, hUser tells them apart.
+ * @param[in] port port number of an Ads port that had previously been opened with AdsPortOpenEx().
+ * @param[in] pAddr Structure with NetId and port number of the ADS server.
+ * @param[in,out] entries notifications to define, hNotification and error of every entry are set by the request.
+ * @param[in] count number of entries.
+ * @param[in] pFunc Pointer to the structure describing the callback function.
+ * @return [ADS Return Code](https://infosys.beckhoff.com/content/1031/tcadscommon/html/ads_returncodes.htm?id=1666172286265530469) of the request, errors of single notifications are only reported in their entry.
+ */
+long AdsSyncAddDeviceNotificationSumReqEx(long                   port,
+                                          const AmsAddr*         pAddr,
+                                          AdsSumNotification*    entries,
+                                          uint32_t               count,
+                                          PAdsNotificationFuncEx pFunc);
+
 /**
  * A notification defined previously is deleted from an ADS server.
  * @param[in] port port number of an Ads port that had previously been opened with AdsPortOpenEx().
@@ -141,6 +220,23 @@ long AdsSyncAddDeviceNotificationReqEx(long                         port,
  */
 long AdsSyncDelDeviceNotificationReqEx(long port, const AmsAddr* pAddr, uint32_t hNotification);
 
+/**
+ * Deletes several notifications from an ADS server with a single
+ * ADSIGRP_SUMUP_DELDEVNOTE request. Their callbacks are no longer called,
+ * whatever the server answers.
+ * @param[in] port port number of an Ads port that had previously been opened with AdsPortOpenEx().
+ * @param[in] pAddr Structure with NetId and port number of the ADS server.
+ * @param[in] handles handles of the notifications to delete.
+ * @param[in] count number of handles.
+ * @param[in] tmms timeout of the request in ms, 0 sends no request and only stops the callbacks, e.g. when the connection is known to be lost.
+ * @return [ADS Return Code](https://infosys.beckhoff.com/content/1031/tcadscommon/html/ads_returncodes.htm?id=1666172286265530469) of the request, errors of single notifications are not reported.
+ */
+long AdsSyncDelDeviceNotificationSumReqEx(long            port,
+                                          const AmsAddr*  pAddr,
+                                          const uint32_t* handles,
+                                          uint32_t        count,
+                                          uint32_t        tmms);
+
 /**
  * Read the configured timeout for the ADS functions. The standard value is 5000 ms.
  * @param[in] port port number of an Ads port that had previously been opened with AdsPortOpenEx().
@@ -24,6 +24,14 @@ struct IAdsVariable {
   virtual void operator=(const double& value){}
  
   virtual void ReadValue(void *res){}
+
+  // address and size of the value, so it can be bundled in sum-up requests
+  virtual uint32_t IndexGroup() const { return 0; }
+  virtual uint32_t IndexOffset() const { return 0; }
+  virtual uint32_t Size() const { return 0; }
+
+  // handle acquired by name, so it can be released together with others
+  virtual AdsHandle* SymbolHandle() { return nullptr; }
 }; 
 
 
@@ -37,6 +45,12 @@ struct AdsVariable  : public IAdsVariable{
         m_Handle(route.GetHandle(symbolName))
     {}
 
+    AdsVariable(const AdsDevice& route, AdsHandle handle)
+        : m_Route(route),
+        m_IndexGroup(ADSIGRP_SYM_VALBYHND),
+        m_Handle(std::move(handle))
+    {}
+
     AdsVariable(const AdsDevice& route, const uint32_t group, const uint32_t offset)
         : m_Route(route),
         m_IndexGroup(group),
@@ -62,6 +76,26 @@ struct AdsVariable  : public IAdsVariable{
         Write(sizeof(T), &value);
     }
 
+    uint32_t IndexGroup() const override
+    {
+        return m_IndexGroup;
+    }
+
+    uint32_t IndexOffset() const override
+    {
+        return *m_Handle;
+    }
+
+    uint32_t Size() const override
+    {
+        return sizeof(T);
+    }
+
+    AdsHandle* SymbolHandle() override
+    {
+        return m_IndexGroup == ADSIGRP_SYM_VALBYHND ? &m_Handle : nullptr;
+    }
+
     template<typename U, size_t N>
     operator std::array<U, N>() const
     {
@@ -100,7 +134,7 @@ struct AdsVariable  : public IAdsVariable{
 private:
     const AdsDevice& m_Route;
     const uint32_t m_IndexGroup;
-    const AdsHandle m_Handle;
+    AdsHandle m_Handle;
 };
 
 /*
@@ -12,6 +12,7 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <thread>
 
 using Timepoint = std::chrono::steady_clock::time_point;
@@ -19,6 +20,9 @@ using Timepoint = std::chrono::steady_clock::time_point;
 
 struct AmsRequest {
     Frame frame;
+    /* sent behind the frame straight from the caller's buffer, only read while the request is written */
+    const void* writeData;
+    uint32_t writeLength;
     const AmsAddr& destAddr;
     uint16_t port;
     uint16_t cmdId;
@@ -34,7 +38,9 @@ struct AmsRequest {
                void*          __buffer = nullptr,
                uint32_t*      __bytesRead = nullptr,
                size_t         payloadLength = 0)
-        : frame(sizeof(AmsTcpHeader) + sizeof(AoEHeader) + payloadLength),
+        : frame(payloadLength),
+        writeData(nullptr),
+        writeLength(0),
         destAddr(ams),
         port(__port),
         cmdId(__cmdId),
@@ -50,9 +56,35 @@ struct AmsRequest {
     }
 };
 
+/**
+ * An asynchronous request owns what the caller of a synchronous one keeps on
+ * its stack until the response arrives.
+ */
+struct AmsAsyncRequest {
+    AmsAddr destAddr;
+    uint32_t bytesRead;
+    AmsRequest request;
+    AdsCompletion completion;
+
+    AmsAsyncRequest(const AmsAddr& ams,
+                    uint16_t       port,
+                    uint16_t       cmdId,
+                    uint32_t       bufferLength,
+                    void*          buffer,
+                    size_t         payloadLength,
+                    AdsCompletion  __completion)
+        : destAddr(ams),
+        bytesRead(0),
+        request(destAddr, port, cmdId, bufferLength, buffer, &bytesRead, payloadLength),
+        completion(std::move(__completion))
+    {}
+};
+
 struct AmsResponse {
     std::atomic<AmsRequest*> request;
     std::atomic<uint32_t> invokeId;
+    AmsAsyncRequest* async; // completed by Notify(), nobody waits for it
+    std::atomic<Timepoint::rep> asyncDeadline; // 0 unless async
 
     AmsResponse();
     void Notify(uint32_t error);
@@ -68,6 +100,14 @@ private:
 };
 
 struct AmsConnection {
+    /**
+     * Requests in flight at once on this connection, from any number of
+     * ports. A power of two, the slot of a request is its invokeId modulo
+     * the number of slots.
+     */
+    static const size_t NUM_PENDING_MAX = 256;
+    static_assert((NUM_PENDING_MAX & (NUM_PENDING_MAX - 1)) == 0, "NUM_PENDING_MAX must be a power of two");
+
     AmsConnection(Router& __router, const struct addrinfo* destination = nullptr);
     ~AmsConnection();
 
@@ -75,6 +115,13 @@ struct AmsConnection {
     long DeleteNotification(const AmsAddr& amsAddr, uint32_t hNotify, uint32_t tmms, uint16_t port);
     long AdsRequest(AmsRequest& request, uint32_t timeout);
 
+    /**
+     * Sends a request without waiting for its response.
+     * @return 0 if the request was sent, its completion is then called
+     *         exactly once. Otherwise the error, the completion is not called.
+     */
+    long AdsRequestAsync(std::unique_ptr<AmsAsyncRequest> async, uint32_t timeout);
+
     /**
      * Confirm if this AmsConnection is connected to one of the target addresses.
      * @param[in] targetAddresses pointer to a previously allocated list of
@@ -90,7 +137,15 @@ private:
     std::thread receiver;
     std::atomic<size_t> refCount;
     std::atomic<uint32_t> invokeId;
-    std::array<AmsResponse, Router::NUM_PORTS_MAX> queue;
+    std::atomic<uint32_t> nextSlot;
+    std::atomic<bool> closed {false}; // set once the receiver has stopped
+    std::mutex writeMutex; // keeps concurrent frames whole on the stream
+    std::array<AmsResponse, NUM_PENDING_MAX> queue;
+    std::thread expiry; // times out asynchronous requests
+    std::mutex expiryMutex;
+    std::condition_variable expiryCv;
+    bool expiryStop = false;
+    std::atomic<Timepoint::rep> expiryNext {Timepoint::max().time_since_epoch().count()}; // the expiry thread wakes up then
 
     template<class T> void ReceiveFrame(AmsResponse* response, size_t length, uint32_t aoeError) const;
     bool ReceiveNotification(const AoEHeader& header);
@@ -98,12 +153,13 @@ private:
     void Receive(void* buffer, size_t bytesToRead, timeval* timeout = nullptr) const;
     void Receive(void* buffer, size_t bytesToRead, const Timepoint& deadline) const;
     template<class T> void Receive(T& buffer) const { Receive(&buffer, sizeof(T)); }
-    AmsResponse* Write(AmsRequest& request, const AmsAddr srcAddr);
+    AmsResponse* Write(AmsRequest& request, const AmsAddr srcAddr, AmsAsyncRequest* async = nullptr);
+    void ExpireAsync();
     void Recv();
     void TryRecv();
-    uint32_t GetInvokeId();
-    AmsResponse* Reserve(AmsRequest* request, uint16_t port);
-    AmsResponse* GetPending(uint32_t id, uint16_t port);
+    uint32_t GetInvokeId(size_t slot);
+    AmsResponse* Reserve(AmsRequest* request, size_t& slot);
+    AmsResponse* GetPending(uint32_t id);
 
     std::map<VirtualConnection, SharedDispatcher> dispatcherList;
     std::recursive_mutex dispatcherListMutex;
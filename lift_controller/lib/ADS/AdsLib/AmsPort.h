@@ -17,6 +17,7 @@ struct AmsPort {
 
     void AddNotification(AmsAddr ams, uint32_t hNotify, SharedDispatcher dispatcher);
     long DelNotification(AmsAddr ams, uint32_t hNotify);
+    void DropNotification(AmsAddr ams, uint32_t hNotify);
 
 private:
     using NotifyUUID = std::pair<const AmsAddr, const uint32_t>;
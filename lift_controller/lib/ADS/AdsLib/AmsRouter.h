@@ -7,6 +7,7 @@
 
 #include "AmsConnection.h"
 #include <unordered_set>
+#include <vector>
 
 struct AmsRouter : Router {
     AmsRouter(AmsNetId netId = AmsNetId {});
@@ -18,7 +19,10 @@ struct AmsRouter : Router {
     long GetTimeout(uint16_t port, uint32_t& timeout);
     long SetTimeout(uint16_t port, uint32_t timeout);
     long AddNotification(AmsRequest& request, uint32_t* pNotification, std::shared_ptr<Notification> notify);
+    long AddNotifications(AmsRequest& request, AdsSumNotification* entries,
+                          const std::vector<std::shared_ptr<Notification> >& notify);
     long DelNotification(uint16_t port, const AmsAddr* pAddr, uint32_t hNotification);
+    void DropNotifications(uint16_t port, const AmsAddr* pAddr, const uint32_t* handles, uint32_t count);
 
     [[deprecated]]
     long AddRoute(AmsNetId ams, const IpV4& ip);
@@ -26,6 +30,8 @@ struct AmsRouter : Router {
     void DelRoute(const AmsNetId& ams);
     AmsConnection* GetConnection(const AmsNetId& pAddr);
     long AdsRequest(AmsRequest& request);
+    long AdsRequest(AmsRequest& request, uint32_t tmms);
+    long AdsRequestAsync(std::unique_ptr<AmsAsyncRequest> async);
 
 private:
     AmsNetId localAddr;
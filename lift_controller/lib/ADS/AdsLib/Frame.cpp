@@ -10,10 +10,66 @@
 #include <cstring>
 #include <new>
 
+std::atomic<uint8_t*> FramePool::slots[NUM_CLASSES][NUM_SLOTS];
+std::atomic<size_t> FramePool::nextSlot[NUM_CLASSES];
+
+static size_t SizeClass(const size_t length)
+{
+    size_t sizeClass = 0;
+    for (size_t capacity = FramePool::MIN_BLOCK_SIZE; capacity < length; capacity *= 4) {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+FramePool::Buffer FramePool::Acquire(const size_t length)
+{
+    const auto sizeClass = SizeClass(length);
+    if (sizeClass >= NUM_CLASSES) {
+        return Buffer {new uint8_t[length], Deleter {length}};
+    }
+
+    const size_t capacity = MIN_BLOCK_SIZE << (2 * sizeClass);
+    /* start at a different slot each time, so concurrent requests rarely touch the same one */
+    const size_t first = nextSlot[sizeClass].fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < NUM_SLOTS; ++i) {
+        auto& slot = slots[sizeClass][(first + i) % NUM_SLOTS];
+        if (slot.load(std::memory_order_relaxed)) {
+            auto buffer = slot.exchange(nullptr, std::memory_order_acquire);
+            if (buffer) {
+                return Buffer {buffer, Deleter {capacity}};
+            }
+        }
+    }
+    return Buffer {new uint8_t[capacity], Deleter {capacity}};
+}
+
+void FramePool::Release(uint8_t* const buffer, const size_t capacity)
+{
+    const auto sizeClass = SizeClass(capacity);
+    if (sizeClass < NUM_CLASSES && capacity == MIN_BLOCK_SIZE << (2 * sizeClass)) {
+        const size_t first = nextSlot[sizeClass].fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < NUM_SLOTS; ++i) {
+            auto& slot = slots[sizeClass][(first + i) % NUM_SLOTS];
+            uint8_t* isFree = nullptr;
+            if (!slot.load(std::memory_order_relaxed)
+                && slot.compare_exchange_strong(isFree, buffer, std::memory_order_release)) {
+                return;
+            }
+        }
+    }
+    delete[] buffer;
+}
+
+void FramePool::Deleter::operator()(uint8_t* const buffer) const
+{
+    FramePool::Release(buffer, capacity);
+}
+
 Frame::Frame(size_t length, const void* data)
-    : m_Data(new uint8_t[length])
+    : m_Data(FramePool::Acquire(length))
 {
-    m_Size = m_Data ? length : 0;
+    m_Size = m_Data.get_deleter().capacity;
     m_Pos = m_Data.get() + m_Size;
     m_OriginalSize = m_Size;
 
@@ -54,9 +110,8 @@ Frame& Frame::reset(const size_t newSize)
 {
     if (newSize > m_OriginalSize) {
         try {
-            std::unique_ptr<uint8_t[]> tmp {new uint8_t[newSize]};
-            m_OriginalSize = newSize;
-            m_Data = std::move(tmp);
+            m_Data = FramePool::Acquire(newSize);
+            m_OriginalSize = m_Data.get_deleter().capacity;
         } catch (const std::bad_alloc&) {
             LOG_WARN("Not enough memory to reset frame to " << std::dec << newSize << " bytes");
         }
@@ -71,17 +126,18 @@ Frame& Frame::prepend(const void* const data, const size_t size)
 {
     const size_t bytesFree = m_Pos - m_Data.get();
     if (size > bytesFree) {
-        auto newData = new uint8_t[size + m_Size];
-
-        m_Pos = newData + bytesFree + size;
-        memcpy(m_Pos, m_Data.get() + bytesFree, m_Size - bytesFree);
-        m_Data.reset(newData);
-        m_Size += size;
+        /* the data moves to the end of the larger buffer, the rest is headroom again */
+        const size_t bytesUsed = m_Size - bytesFree;
+        auto newData = FramePool::Acquire(size + bytesUsed);
+        const size_t newSize = newData.get_deleter().capacity;
+
+        memcpy(newData.get() + newSize - bytesUsed, m_Pos, bytesUsed);
+        m_Data = std::move(newData);
+        m_Size = newSize;
         m_OriginalSize = m_Size;
-        m_Pos = m_Data.get() + bytesFree;
-    } else {
-        m_Pos -= size;
+        m_Pos = m_Data.get() + m_Size - bytesUsed;
     }
+    m_Pos -= size;
     memcpy(m_Pos, data, size);
     return *this;
 }
@@ -6,12 +6,49 @@
 #pragma once
 
 #include "wrap_endian.h"
+#include <atomic>
 #include <memory>
 
+/**
+ * @brief FramePool
+ * Recycles frame buffers, so the steady-state request path does not touch the heap.
+ * Buffers are grouped in size classes of MIN_BLOCK_SIZE * 4^n bytes, each class keeps
+ * up to NUM_SLOTS free buffers in an array of atomic pointers. Taking or returning a
+ * buffer is an exchange on a single slot, so the pool is lock-free and, as the owner
+ * moves with the pointer, free of ABA. Larger frames and buffers returned to a full
+ * class use the heap.
+ */
+struct FramePool {
+    static const size_t MIN_BLOCK_SIZE = 256;
+    static const size_t NUM_CLASSES = 4;
+    static const size_t NUM_SLOTS = 32;
+
+    struct Deleter {
+        size_t capacity;
+        void operator()(uint8_t* buffer) const;
+    };
+    using Buffer = std::unique_ptr<uint8_t[], Deleter>;
+
+    /**
+     * @brief Acquire
+     * @param length minimum number of bytes
+     * @return a buffer of get_deleter().capacity bytes, the memory is not initialized
+     */
+    static Buffer Acquire(size_t length);
+
+private:
+    static void Release(uint8_t* buffer, size_t capacity);
+
+    static std::atomic<uint8_t*> slots[NUM_CLASSES][NUM_SLOTS];
+    static std::atomic<size_t> nextSlot[NUM_CLASSES];
+};
+
 struct Frame {
     /**
      * @brief Frame
-     * @param length number of bytes preallocated in the internale buffer
+     * @param length number of bytes preallocated in the internale buffer, the buffer is
+     * taken from the FramePool and may be larger. Everything in front of the data is
+     * headroom for prepend().
      * @param data, if not null this frame will be initialized with <lenght> number of bytes from <data>
      */
     Frame(size_t length, const void* data = nullptr);
@@ -133,7 +170,7 @@ struct Frame {
     size_t size() const;
 
 private:
-    std::unique_ptr<uint8_t[]> m_Data;
+    FramePool::Buffer m_Data;
     uint8_t* m_Pos;
     size_t m_Size;
     size_t m_OriginalSize;
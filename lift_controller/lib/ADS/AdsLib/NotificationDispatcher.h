@@ -21,6 +21,8 @@ struct NotificationDispatcher {
     ~NotificationDispatcher();
     void Emplace(uint32_t hNotify, std::shared_ptr<Notification> notification);
     long Erase(uint32_t hNotify, uint32_t tmms);
+    /** Stops dispatching a notification without deleting it on the server */
+    void Forget(uint32_t hNotify);
     void Notify();
     void Run();
 
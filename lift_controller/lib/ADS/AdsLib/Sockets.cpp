@@ -205,27 +205,75 @@ bool Socket::Select(timeval* timeout) const
 
 size_t Socket::write(const Frame& frame) const
 {
-    if (frame.size() > INT_MAX) {
-        LOG_ERROR("frame length: " << frame.size() << " exceeds maximum length for sockets");
+    const Buffer buffer { frame.data(), frame.size() };
+    return write(&buffer, 1);
+}
+
+size_t Socket::write(const Buffer* const buffers, const size_t count) const
+{
+    static const size_t MAX_BUFFERS = 8;
+    if (count > MAX_BUFFERS) {
+        LOG_ERROR("write of " << std::dec << count << " buffers exceeds maximum of " << MAX_BUFFERS);
+        return 0;
+    }
+
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i) {
+        length += buffers[i].length;
+    }
+    if (length > INT_MAX) {
+        LOG_ERROR("frame length: " << length << " exceeds maximum length for sockets");
         return 0;
     }
 
-    const int bufferLength = static_cast<int>(frame.size());
-    const char* const buffer = reinterpret_cast<const char*>(frame.data());
-    const int status = sendto(m_Socket, buffer, bufferLength, 0, m_DestAddr, m_DestAddrLen);
+#if !(defined(_WIN32) && !defined(__CYGWIN__))
+    iovec vectors[MAX_BUFFERS];
+    for (size_t i = 0; i < count; ++i) {
+        vectors[i].iov_base = const_cast<void*>(buffers[i].data);
+        vectors[i].iov_len = buffers[i].length;
+    }
+    msghdr message {};
+    message.msg_name = const_cast<sockaddr*>(m_DestAddr);
+    message.msg_namelen = static_cast<socklen_t>(m_DestAddrLen);
+    message.msg_iov = vectors;
+    message.msg_iovlen = count;
+#ifdef MSG_NOSIGNAL
+    // a reset connection fails the write instead of raising SIGPIPE
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    const auto status = sendmsg(m_Socket, &message, flags);
+
+    if (status < 0) {
+        LOG_ERROR("write frame failed with error: " << std::strerror(WSAGetLastError()));
+        return 0;
+    }
+    return static_cast<size_t>(status);
+#else
+    WSABUF vectors[MAX_BUFFERS];
+    for (size_t i = 0; i < count; ++i) {
+        vectors[i].buf = reinterpret_cast<CHAR*>(const_cast<void*>(buffers[i].data));
+        vectors[i].len = static_cast<ULONG>(buffers[i].length);
+    }
+    DWORD bytesSent = 0;
+    const int status = WSASendTo(m_Socket, vectors, static_cast<DWORD>(count), &bytesSent, 0,
+                                 m_DestAddr, static_cast<int>(m_DestAddrLen), nullptr, nullptr);
 
     if (SOCKET_ERROR == status) {
         LOG_ERROR("write frame failed with error: " << std::strerror(WSAGetLastError()));
         return 0;
     }
-    return status;
+    return bytesSent;
+#endif
 }
 
 TcpSocket::TcpSocket(const struct addrinfo* const host)
     : Socket(host, SOCK_STREAM)
 {
-    // AdsDll.lib seems to use TCP_NODELAY, we use it to be compatible
-    const int enable = 0;
+    // AdsDll.lib seems to use TCP_NODELAY, we use it to be compatible. It
+    // also keeps pipelined requests from waiting for the previous response.
+    const int enable = 1;
     if (setsockopt(m_Socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&enable, sizeof(enable))) {
         LOG_WARN("Enabling TCP_NODELAY failed");
     }
@@ -32,9 +32,21 @@ struct IpV4 {
 };
 
 struct Socket {
+    struct Buffer {
+        const void* data;
+        size_t length;
+    };
+
     Frame& read(Frame& frame, timeval* timeout) const;
     size_t read(uint8_t* buffer, size_t maxBytes, timeval* timeout) const;
     size_t write(const Frame& frame) const;
+
+    /**
+     * Sends <count> buffers with a single system call, as if they were one
+     * contiguous block. Nothing is copied in user space.
+     * @return number of bytes sent
+     */
+    size_t write(const Buffer* buffers, size_t count) const;
     void Shutdown();
 
     struct TimeoutEx : std::runtime_error {
@@ -104,6 +104,45 @@ long AdsSyncAddDeviceNotificationReqEx(long                         port,
                                              (ads_ui32*)pNotification);
 }
 
+long AdsSyncAddDeviceNotificationSumReqEx(long                   port,
+                                          const AmsAddr*         pAddr,
+                                          AdsSumNotification*    entries,
+                                          uint32_t               count,
+                                          PAdsNotificationFuncEx pFunc)
+{
+    // TcAdsDll has no vectored registration, define them one by one
+    for (uint32_t i = 0; i < count; ++i) {
+        entries[i].error = AdsSyncAddDeviceNotificationReqEx(port,
+                                                             pAddr,
+                                                             entries[i].indexGroup,
+                                                             entries[i].indexOffset,
+                                                             &entries[i].attrib,
+                                                             pFunc,
+                                                             entries[i].hUser,
+                                                             &entries[i].hNotification);
+    }
+    return ADSERR_NOERR;
+}
+
+long AdsSyncDelDeviceNotificationSumReqEx(long            port,
+                                          const AmsAddr*  pAddr,
+                                          const uint32_t* handles,
+                                          uint32_t        count,
+                                          uint32_t        tmms)
+{
+    // TcAdsDll has no vectored deletion and no timeout per request, delete
+    // them one by one unless the connection is lost
+    if (!tmms) {
+        return ADSERR_NOERR;
+    }
+    long result = ADSERR_NOERR;
+    for (uint32_t i = 0; i < count; ++i) {
+        const long error = AdsSyncDelDeviceNotificationReqEx(port, pAddr, handles[i]);
+        result = result ? result : error;
+    }
+    return result;
+}
+
 long AdsSyncWriteControlReqEx(long           port,
                               const AmsAddr* pAddr,
                               uint16_t       adsState,
@@ -133,3 +172,57 @@ long AdsSyncWriteReqEx(long           port,
                              (ads_ui32)bufferLength,
                              (void*)buffer);
 }
+
+// TcAdsDll has no asynchronous requests, they complete before returning
+
+long AdsAsyncReadReqEx2(long           port,
+                        const AmsAddr* pAddr,
+                        uint32_t       indexGroup,
+                        uint32_t       indexOffset,
+                        uint32_t       bufferLength,
+                        void*          buffer,
+                        AdsCompletion  completion)
+{
+    if (!completion) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+    uint32_t bytesRead = 0;
+    completion(AdsSyncReadReqEx2(port, pAddr, indexGroup, indexOffset, bufferLength, buffer, &bytesRead),
+               bytesRead);
+    return ADSERR_NOERR;
+}
+
+long AdsAsyncReadWriteReqEx2(long           port,
+                             const AmsAddr* pAddr,
+                             uint32_t       indexGroup,
+                             uint32_t       indexOffset,
+                             uint32_t       readLength,
+                             void*          readData,
+                             uint32_t       writeLength,
+                             const void*    writeData,
+                             AdsCompletion  completion)
+{
+    if (!completion) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+    uint32_t bytesRead = 0;
+    completion(AdsSyncReadWriteReqEx2(port, pAddr, indexGroup, indexOffset,
+                                      readLength, readData, writeLength, writeData, &bytesRead),
+               bytesRead);
+    return ADSERR_NOERR;
+}
+
+long AdsAsyncWriteReqEx(long           port,
+                        const AmsAddr* pAddr,
+                        uint32_t       indexGroup,
+                        uint32_t       indexOffset,
+                        uint32_t       bufferLength,
+                        const void*    buffer,
+                        AdsCompletion  completion)
+{
+    if (!completion) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+    completion(AdsSyncWriteReqEx(port, pAddr, indexGroup, indexOffset, bufferLength, buffer), 0);
+    return ADSERR_NOERR;
+}
@@ -183,9 +183,10 @@ long AdsSyncReadWriteReqEx2(long           port,
             readLength,
             readData,
             bytesRead,
-            sizeof(AoEReadWriteReqHeader) + writeLength
+            sizeof(AoEReadWriteReqHeader)
         };
-        request.frame.prepend(writeData, writeLength);
+        request.writeData = writeData;
+        request.writeLength = writeLength;
         request.frame.prepend(AoEReadWriteReqHeader {
             indexGroup,
             indexOffset,
@@ -216,9 +217,10 @@ long AdsSyncWriteReqEx(long           port,
             (uint16_t)port,
             AoEHeader::WRITE,
             0, nullptr, nullptr,
-            sizeof(AoERequestHeader) + bufferLength,
+            sizeof(AoERequestHeader),
         };
-        request.frame.prepend(buffer, bufferLength);
+        request.writeData = buffer;
+        request.writeLength = bufferLength;
         request.frame.prepend<AoERequestHeader>({
             indexGroup,
             indexOffset,
@@ -230,6 +232,114 @@ long AdsSyncWriteReqEx(long           port,
     }
 }
 
+long AdsAsyncReadReqEx2(long           port,
+                        const AmsAddr* pAddr,
+                        uint32_t       indexGroup,
+                        uint32_t       indexOffset,
+                        uint32_t       bufferLength,
+                        void*          buffer,
+                        AdsCompletion  completion)
+{
+    ASSERT_PORT_AND_AMSADDR(port, pAddr);
+    if (!buffer || !completion) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+
+    try {
+        std::unique_ptr<AmsAsyncRequest> async(new AmsAsyncRequest {
+            *pAddr,
+            (uint16_t)port,
+            AoEHeader::READ,
+            bufferLength,
+            buffer,
+            sizeof(AoERequestHeader),
+            std::move(completion)
+        });
+        async->request.frame.prepend(AoERequestHeader {
+            indexGroup,
+            indexOffset,
+            bufferLength
+        });
+        return GetRouter().AdsRequestAsync(std::move(async));
+    } catch (const std::bad_alloc&) {
+        return GLOBALERR_NO_MEMORY;
+    }
+}
+
+long AdsAsyncReadWriteReqEx2(long           port,
+                             const AmsAddr* pAddr,
+                             uint32_t       indexGroup,
+                             uint32_t       indexOffset,
+                             uint32_t       readLength,
+                             void*          readData,
+                             uint32_t       writeLength,
+                             const void*    writeData,
+                             AdsCompletion  completion)
+{
+    ASSERT_PORT_AND_AMSADDR(port, pAddr);
+    if ((readLength && !readData) || (writeLength && !writeData) || !completion) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+
+    try {
+        std::unique_ptr<AmsAsyncRequest> async(new AmsAsyncRequest {
+            *pAddr,
+            (uint16_t)port,
+            AoEHeader::READ_WRITE,
+            readLength,
+            readData,
+            sizeof(AoEReadWriteReqHeader),
+            std::move(completion)
+        });
+        async->request.writeData = writeData;
+        async->request.writeLength = writeLength;
+        async->request.frame.prepend(AoEReadWriteReqHeader {
+            indexGroup,
+            indexOffset,
+            readLength,
+            writeLength
+        });
+        return GetRouter().AdsRequestAsync(std::move(async));
+    } catch (const std::bad_alloc&) {
+        return GLOBALERR_NO_MEMORY;
+    }
+}
+
+long AdsAsyncWriteReqEx(long           port,
+                        const AmsAddr* pAddr,
+                        uint32_t       indexGroup,
+                        uint32_t       indexOffset,
+                        uint32_t       bufferLength,
+                        const void*    buffer,
+                        AdsCompletion  completion)
+{
+    ASSERT_PORT_AND_AMSADDR(port, pAddr);
+    if (!buffer || !completion) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+
+    try {
+        std::unique_ptr<AmsAsyncRequest> async(new AmsAsyncRequest {
+            *pAddr,
+            (uint16_t)port,
+            AoEHeader::WRITE,
+            0, nullptr,
+            sizeof(AoERequestHeader),
+            std::move(completion)
+        });
+        async->request.writeData = buffer;
+        async->request.writeLength = bufferLength;
+        async->request.frame.prepend<AoERequestHeader>({
+            indexGroup,
+            indexOffset,
+            bufferLength
+        });
+        return GetRouter().AdsRequestAsync(std::move(async));
+    } catch (const std::bad_alloc&) {
+        return GLOBALERR_NO_MEMORY;
+    }
+}
+
 long AdsSyncWriteControlReqEx(long           port,
                               const AmsAddr* pAddr,
                               uint16_t       adsState,
@@ -244,9 +354,10 @@ long AdsSyncWriteControlReqEx(long           port,
             (uint16_t)port,
             AoEHeader::WRITE_CONTROL,
             0, nullptr, nullptr,
-            sizeof(AdsWriteCtrlRequest) + bufferLength
+            sizeof(AdsWriteCtrlRequest)
         };
-        request.frame.prepend(buffer, bufferLength);
+        request.writeData = buffer;
+        request.writeLength = bufferLength;
         request.frame.prepend<AdsWriteCtrlRequest>({
             adsState,
             devState,
@@ -301,12 +412,116 @@ long AdsSyncAddDeviceNotificationReqEx(long                         port,
     }
 }
 
+long AdsSyncAddDeviceNotificationSumReqEx(long                   port,
+                                          const AmsAddr*         pAddr,
+                                          AdsSumNotification*    entries,
+                                          uint32_t               count,
+                                          PAdsNotificationFuncEx pFunc)
+{
+    ASSERT_PORT_AND_AMSADDR(port, pAddr);
+    if (!entries || !pFunc) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+    if (!count) {
+        return ADSERR_NOERR;
+    }
+
+    try {
+        // the response holds an error code and a handle per notification
+        std::vector<uint8_t> buffer(count * 2 * sizeof(uint32_t));
+        uint32_t bytesRead = 0;
+        const uint32_t writeLength = count * sizeof(AdsAddDeviceNotificationRequest);
+        AmsRequest request {
+            *pAddr,
+            (uint16_t)port,
+            AoEHeader::READ_WRITE,
+            (uint32_t)buffer.size(),
+            buffer.data(),
+            &bytesRead,
+            sizeof(AoEReadWriteReqHeader) + writeLength
+        };
+        std::vector<std::shared_ptr<Notification> > notify;
+        notify.reserve(count);
+        for (uint32_t i = count; i > 0; --i) {
+            const auto& entry = entries[i - 1];
+            request.frame.prepend(AdsAddDeviceNotificationRequest {
+                entry.indexGroup,
+                entry.indexOffset,
+                entry.attrib.cbLength,
+                entry.attrib.nTransMode,
+                entry.attrib.nMaxDelay,
+                entry.attrib.nCycleTime
+            });
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            notify.push_back(std::make_shared<Notification>(pFunc, entries[i].hUser, entries[i].attrib.cbLength,
+                                                            *pAddr, (uint16_t)port));
+        }
+        request.frame.prepend(AoEReadWriteReqHeader {
+            ADSIGRP_SUMUP_ADDDEVNOTE,
+            count,
+            (uint32_t)buffer.size(),
+            writeLength
+        });
+        return GetRouter().AddNotifications(request, entries, notify);
+    } catch (const std::bad_alloc&) {
+        return GLOBALERR_NO_MEMORY;
+    }
+}
+
 long AdsSyncDelDeviceNotificationReqEx(long port, const AmsAddr* pAddr, uint32_t hNotification)
 {
     ASSERT_PORT_AND_AMSADDR(port, pAddr);
     return GetRouter().DelNotification((uint16_t)port, pAddr, hNotification);
 }
 
+long AdsSyncDelDeviceNotificationSumReqEx(long            port,
+                                          const AmsAddr*  pAddr,
+                                          const uint32_t* handles,
+                                          const uint32_t  count,
+                                          const uint32_t  tmms)
+{
+    ASSERT_PORT_AND_AMSADDR(port, pAddr);
+    if (!handles) {
+        return ADSERR_CLIENT_INVALIDPARM;
+    }
+    if (!count) {
+        return ADSERR_NOERR;
+    }
+
+    GetRouter().DropNotifications((uint16_t)port, pAddr, handles, count);
+    if (!tmms) {
+        return ADSERR_NOERR;
+    }
+    try {
+        // the response holds an error code per notification
+        std::vector<uint8_t> buffer(count * sizeof(uint32_t));
+        uint32_t bytesRead = 0;
+        const uint32_t writeLength = count * sizeof(uint32_t);
+        AmsRequest request {
+            *pAddr,
+            (uint16_t)port,
+            AoEHeader::READ_WRITE,
+            (uint32_t)buffer.size(),
+            buffer.data(),
+            &bytesRead,
+            sizeof(AoEReadWriteReqHeader) + writeLength
+        };
+        for (uint32_t i = count; i > 0; --i) {
+            request.frame.prepend(bhf::ads::htole(handles[i - 1]));
+        }
+        request.frame.prepend(AoEReadWriteReqHeader {
+            ADSIGRP_SUMUP_DELDEVNOTE,
+            count,
+            (uint32_t)buffer.size(),
+            writeLength
+        });
+        return GetRouter().AdsRequest(request, tmms);
+    } catch (const std::bad_alloc&) {
+        return GLOBALERR_NO_MEMORY;
+    }
+}
+
 long AdsSyncGetTimeoutEx(long port, uint32_t* timeout)
 {
     ASSERT_PORT(port);
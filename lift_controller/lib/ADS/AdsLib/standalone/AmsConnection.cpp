@@ -6,13 +6,30 @@
 #include "AmsConnection.h"
 #include "Log.h"
 
+#include <algorithm>
+#include <vector>
+
 AmsResponse::AmsResponse()
     : request(nullptr),
+    async(nullptr),
+    asyncDeadline(0),
     errorCode(WAITING_FOR_RESPONSE)
 {}
 
 void AmsResponse::Notify(const uint32_t error)
 {
+    if (async) {
+        /* nobody waits for an asynchronous request, it completes here and frees its slot first */
+        AmsAsyncRequest* const done = async;
+        Release();
+        try {
+            done->completion(error, done->bytesRead);
+        } catch (const std::exception& e) {
+            LOG_WARN("Completion of an asynchronous request failed: " << e.what());
+        }
+        delete done;
+        return;
+    }
     std::unique_lock<std::mutex> lock(mutex);
     errorCode = error;
     cv.notify_all();
@@ -66,15 +83,24 @@ AmsConnection::AmsConnection(Router& __router, const struct addrinfo* const dest
     socket(destination),
     refCount(0),
     invokeId(0),
+    nextSlot(0),
     ownIp(socket.Connect())
 {
     receiver = std::thread(&AmsConnection::TryRecv, this);
+    expiry = std::thread(&AmsConnection::ExpireAsync, this);
 }
 
 AmsConnection::~AmsConnection()
 {
     socket.Shutdown();
+    /* fails the pending requests, asynchronous ones included */
     receiver.join();
+    {
+        std::lock_guard<std::mutex> lock(expiryMutex);
+        expiryStop = true;
+    }
+    expiryCv.notify_one();
+    expiry.join();
 }
 
 SharedDispatcher AmsConnection::CreateNotifyMapping(uint32_t hNotify, std::shared_ptr<Notification> notification)
@@ -102,34 +128,134 @@ bool AmsConnection::IsConnectedTo(const struct addrinfo* targetAddresses) const
     return socket.IsConnectedTo(targetAddresses);
 }
 
-AmsResponse* AmsConnection::Write(AmsRequest& request, const AmsAddr srcAddr)
+AmsResponse* AmsConnection::Write(AmsRequest& request, const AmsAddr srcAddr, AmsAsyncRequest* const async)
 {
+    size_t slot;
+    auto response = Reserve(&request, slot);
+
+    if (!response) {
+        return nullptr;
+    }
+    response->async = async;
+    if (async) {
+        response->asyncDeadline.store(request.deadline.time_since_epoch().count());
+    }
+
+    const uint32_t payloadLength = static_cast<uint32_t>(request.frame.size() + request.writeLength);
     const AoEHeader aoeHeader {
         request.destAddr.netId, request.destAddr.port,
         srcAddr.netId, srcAddr.port,
         request.cmdId,
-        static_cast<uint32_t>(request.frame.size()),
-        GetInvokeId()
+        payloadLength,
+        GetInvokeId(slot)
     };
-    request.frame.prepend<AoEHeader>(aoeHeader);
-
-    const AmsTcpHeader header { static_cast<uint32_t>(request.frame.size()) };
-    request.frame.prepend<AmsTcpHeader>(header);
-
-    auto response = Reserve(&request, srcAddr.port);
-
-    if (!response) {
-        return nullptr;
-    }
+    const AmsTcpHeader header { static_cast<uint32_t>(sizeof(aoeHeader) + payloadLength) };
+
+    /* the headers, the frame and the caller's data leave in one system call without being copied together */
+    const Socket::Buffer buffers[] = {
+        { &header, sizeof(header) },
+        { &aoeHeader, sizeof(aoeHeader) },
+        { request.frame.data(), request.frame.size() },
+        { request.writeData, request.writeLength },
+    };
+    const size_t frameLength = sizeof(header) + sizeof(aoeHeader) + payloadLength;
 
     response->invokeId.store(aoeHeader.invokeId());
-    if (request.frame.size() != socket.write(request.frame)) {
+    size_t written;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        written = socket.write(buffers, sizeof(buffers) / sizeof(buffers[0]));
+    }
+    if (frameLength != written) {
+        if (response->invokeId.exchange(0)) {
+            response->Release();
+            return nullptr;
+        }
+        /* the receiver failed the request meanwhile, it is released by Wait() */
+        return response;
+    }
+    // the receiver is gone, unless it already failed this request
+    if (closed && response->invokeId.exchange(0)) {
         response->Release();
         return nullptr;
     }
     return response;
 }
 
+long AmsConnection::AdsRequestAsync(std::unique_ptr<AmsAsyncRequest> async, const uint32_t timeout)
+{
+    AmsAddr srcAddr;
+    const auto status = router.GetLocalAddress(async->request.port, &srcAddr);
+    if (status) {
+        return status;
+    }
+    async->request.SetDeadline(timeout);
+    const auto deadline = async->request.deadline.time_since_epoch().count();
+    if (!Write(async->request, srcAddr, async.get())) {
+        return -1;
+    }
+    /* owned by the slot now, it may even be completed already */
+    async.release();
+
+    /* the expiry thread only needs to wake up earlier for an earlier deadline, requests with equal
+     * timeouts then send no wakeup. A scan in progress has reset expiryNext, so it is woken up again
+     * if it missed the slot. */
+    auto next = expiryNext.load();
+    while (deadline < next) {
+        if (expiryNext.compare_exchange_weak(next, deadline)) {
+            {
+                std::lock_guard<std::mutex> lock(expiryMutex);
+            }
+            expiryCv.notify_one();
+            break;
+        }
+    }
+    return 0;
+}
+
+void AmsConnection::ExpireAsync()
+{
+    std::unique_lock<std::mutex> lock(expiryMutex);
+    std::vector<AmsResponse*> expired;
+    while (!expiryStop) {
+        /* requests sent during the scan lower it again and wake up the wait below */
+        expiryNext.store(Timepoint::max().time_since_epoch().count());
+        const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+        auto next = Timepoint::max().time_since_epoch().count();
+        for (auto& response : queue) {
+            /* a slot reused meanwhile has a new invokeId, the exchange below then fails */
+            auto id = response.invokeId.load();
+            const auto deadline = response.asyncDeadline.load();
+            if (!id || !deadline) {
+                continue;
+            }
+            if (deadline > now) {
+                next = std::min(next, deadline);
+            } else if (response.invokeId.compare_exchange_strong(id, 0)) {
+                expired.push_back(&response);
+            }
+        }
+        if (!expired.empty()) {
+            lock.unlock();
+            for (auto response : expired) {
+                response->Notify(ADSERR_CLIENT_SYNCTIMEOUT);
+            }
+            expired.clear();
+            lock.lock();
+            continue;
+        }
+        auto known = expiryNext.load();
+        while (next < known && !expiryNext.compare_exchange_weak(known, next)) {
+        }
+        next = std::min(next, known);
+        if (next == Timepoint::max().time_since_epoch().count()) {
+            expiryCv.wait(lock);
+        } else {
+            expiryCv.wait_until(lock, Timepoint(Timepoint::duration(next)));
+        }
+    }
+}
+
 long AmsConnection::AdsRequest(AmsRequest& request, const uint32_t timeout)
 {
     AmsAddr srcAddr;
@@ -148,44 +274,47 @@ long AmsConnection::AdsRequest(AmsRequest& request, const uint32_t timeout)
     return -1;
 }
 
-uint32_t AmsConnection::GetInvokeId()
+uint32_t AmsConnection::GetInvokeId(const size_t slot)
 {
+    /* NUM_PENDING_MAX divides 2^32, so the slot survives the wrap around */
     uint32_t result;
     do {
-        result = invokeId.fetch_add(1);
+        result = invokeId.fetch_add(1) * static_cast<uint32_t>(NUM_PENDING_MAX) + static_cast<uint32_t>(slot);
     } while (!result);
     return result;
 }
 
-AmsResponse* AmsConnection::GetPending(const uint32_t id, const uint16_t port)
+AmsResponse* AmsConnection::GetPending(const uint32_t id)
 {
-    const uint16_t portIndex = port - Router::PORT_BASE;
-    if (portIndex >= Router::NUM_PORTS_MAX) {
-        LOG_WARN("Port 0x" << std::hex << port << " is out of range");
-        return nullptr;
-    }
-
+    auto& response = queue[id % NUM_PENDING_MAX];
     auto currentId = id;
-    if (queue[portIndex].invokeId.compare_exchange_strong(currentId, 0)) {
-        return &queue[portIndex];
+    if (response.invokeId.compare_exchange_strong(currentId, 0)) {
+        return &response;
     }
     LOG_WARN("InvokeId mismatch: waiting for 0x" << std::hex << currentId << " received 0x" << id);
     return nullptr;
 }
 
-AmsResponse* AmsConnection::Reserve(AmsRequest* request, const uint16_t port)
+AmsResponse* AmsConnection::Reserve(AmsRequest* request, size_t& slot)
 {
-    AmsRequest* isFree = nullptr;
-    if (!queue[port - Router::PORT_BASE].request.compare_exchange_strong(isFree, request)) {
-        LOG_WARN("Port: " << port << " already in use as " << isFree);
-        return nullptr;
+    /* start at a different slot each time, so a free one is usually found at once */
+    const size_t first = nextSlot.fetch_add(1);
+    for (size_t i = 0; i < NUM_PENDING_MAX; ++i) {
+        slot = (first + i) % NUM_PENDING_MAX;
+        AmsRequest* isFree = nullptr;
+        if (queue[slot].request.compare_exchange_strong(isFree, request)) {
+            return &queue[slot];
+        }
     }
-    return &queue[port - Router::PORT_BASE];
+    LOG_WARN("All " << std::dec << NUM_PENDING_MAX << " request slots are in use");
+    return nullptr;
 }
 
 void AmsResponse::Release()
 {
     errorCode = WAITING_FOR_RESPONSE;
+    async = nullptr;
+    asyncDeadline.store(0);
     request.store(nullptr);
 }
 
@@ -300,6 +429,15 @@ void AmsConnection::TryRecv()
     } catch (const std::runtime_error& e) {
         LOG_INFO(e.what());
     }
+
+    // no response can arrive anymore, fail the pending requests now instead
+    // of at their deadline
+    closed = true;
+    for (auto& response : queue) {
+        if (response.invokeId.exchange(0)) {
+            response.Notify(ADSERR_CLIENT_SYNCTIMEOUT);
+        }
+    }
 }
 
 void AmsConnection::Recv()
@@ -320,7 +458,7 @@ void AmsConnection::Recv()
             continue;
         }
 
-        auto response = GetPending(aoeHeader.invokeId(), aoeHeader.targetPort());
+        auto response = GetPending(aoeHeader.invokeId());
         if (!response) {
             LOG_WARN("No response pending");
             ReceiveJunk(aoeHeader.length());
@@ -48,6 +48,16 @@ long AmsPort::DelNotification(const AmsAddr ams, uint32_t hNotify)
     return ADSERR_CLIENT_REMOVEHASH;
 }
 
+void AmsPort::DropNotification(const AmsAddr ams, uint32_t hNotify)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = dispatcherList.find({ams, hNotify});
+    if (it != dispatcherList.end()) {
+        it->second->Forget(hNotify);
+        dispatcherList.erase(it);
+    }
+}
+
 bool AmsPort::IsOpen() const
 {
     return !!port;
@@ -171,6 +171,11 @@ AmsConnection* AmsRouter::GetConnection(const AmsNetId& amsDest)
 }
 
 long AmsRouter::AdsRequest(AmsRequest& request)
+{
+    return AdsRequest(request, ports[request.port - Router::PORT_BASE].tmms);
+}
+
+long AmsRouter::AdsRequest(AmsRequest& request, uint32_t tmms)
 {
     if (request.bytesRead) {
         *request.bytesRead = 0;
@@ -180,7 +185,17 @@ long AmsRouter::AdsRequest(AmsRequest& request)
     if (!ads) {
         return GLOBALERR_MISSING_ROUTE;
     }
-    return ads->AdsRequest(request, ports[request.port - Router::PORT_BASE].tmms);
+    return ads->AdsRequest(request, tmms);
+}
+
+long AmsRouter::AdsRequestAsync(std::unique_ptr<AmsAsyncRequest> async)
+{
+    auto ads = GetConnection(async->request.destAddr.netId);
+    if (!ads) {
+        return GLOBALERR_MISSING_ROUTE;
+    }
+    const uint32_t timeout = ports[async->request.port - Router::PORT_BASE].tmms;
+    return ads->AdsRequestAsync(std::move(async), timeout);
 }
 
 long AmsRouter::AddNotification(AmsRequest& request, uint32_t* pNotification, std::shared_ptr<Notification> notify)
@@ -204,8 +219,53 @@ long AmsRouter::AddNotification(AmsRequest& request, uint32_t* pNotification, st
     return status;
 }
 
+long AmsRouter::AddNotifications(AmsRequest&                                        request,
+                                 AdsSumNotification*                                entries,
+                                 const std::vector<std::shared_ptr<Notification> >& notify)
+{
+    if (request.bytesRead) {
+        *request.bytesRead = 0;
+    }
+
+    auto ads = GetConnection(request.destAddr.netId);
+    if (!ads) {
+        return GLOBALERR_MISSING_ROUTE;
+    }
+
+    auto& port = ports[request.port - Router::PORT_BASE];
+    const long status = ads->AdsRequest(request, port.tmms);
+    if (status) {
+        return status;
+    }
+
+    const auto response = static_cast<const uint8_t*>(request.buffer);
+    const size_t received = request.bytesRead ? *request.bytesRead : request.bufferLength;
+    for (size_t i = 0; i < notify.size(); ++i) {
+        const size_t offset = i * 2 * sizeof(uint32_t);
+        if (offset + 2 * sizeof(uint32_t) > received) {
+            entries[i].error = ADSERR_DEVICE_INVALIDSIZE;
+            continue;
+        }
+        entries[i].error = bhf::ads::letoh<uint32_t>(response + offset);
+        entries[i].hNotification = bhf::ads::letoh<uint32_t>(response + offset + sizeof(uint32_t));
+        if (!entries[i].error) {
+            auto dispatcher = ads->CreateNotifyMapping(entries[i].hNotification, notify[i]);
+            port.AddNotification(request.destAddr, entries[i].hNotification, dispatcher);
+        }
+    }
+    return status;
+}
+
 long AmsRouter::DelNotification(uint16_t port, const AmsAddr* pAddr, uint32_t hNotification)
 {
     auto& p = ports[port - Router::PORT_BASE];
     return p.DelNotification(*pAddr, hNotification);
 }
+
+void AmsRouter::DropNotifications(uint16_t port, const AmsAddr* pAddr, const uint32_t* handles, uint32_t count)
+{
+    auto& p = ports[port - Router::PORT_BASE];
+    for (uint32_t i = 0; i < count; ++i) {
+        p.DropNotification(*pAddr, handles[i]);
+    }
+}
@@ -30,9 +30,14 @@ void NotificationDispatcher::Emplace(uint32_t hNotify, std::shared_ptr<Notificat
 long NotificationDispatcher::Erase(uint32_t hNotify, uint32_t tmms)
 {
     const auto status = deleteNotification(hNotify, tmms);
+    Forget(hNotify);
+    return status;
+}
+
+void NotificationDispatcher::Forget(uint32_t hNotify)
+{
     std::lock_guard<std::recursive_mutex> lock(mutex);
     notifications.erase(hNotify);
-    return status;
 }
 
 std::shared_ptr<Notification> NotificationDispatcher::Find(uint32_t hNotify)
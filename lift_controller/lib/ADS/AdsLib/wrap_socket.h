@@ -14,6 +14,7 @@
 #include <netdb.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 typedef int SOCKET;
 #define INVALID_SOCKET ((int)-1)
@@ -1,22 +1,63 @@
 #include "AdsInterface.hpp"
 
+#include "AdsSymbolCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <type_traits>
+
 using namespace std;
 
-AdsInterface::AdsInterface() {}
+std::array<AdsInterface::CacheSlot, ADS_CACHE_MAX_VARIABLES>
+    AdsInterface::s_cache;
+std::atomic<uint32_t> AdsInterface::s_cache_used{0};
+
+namespace {
+int64_t CacheNow()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+}  // namespace
+
+AdsInterface::AdsInterface()
+{
+    m_cache_max_age = std::chrono::steady_clock::duration(
+                          m_cache_heartbeat * ADS_CACHE_MAX_MISSED_HEARTBEATS)
+                          .count();
+    m_supervisor = std::thread(&AdsInterface::Supervise, this);
+}
 
 AdsInterface::~AdsInterface()
 {
-    if (m_route) {
-        delete m_route;
-    }
-    if (m_ams_net_id_remote_net_id) {
-        delete m_ams_net_id_remote_net_id;
+    {
+        std::scoped_lock lock(m_supervisor_mutex);
+        m_supervisor_stop = true;
     }
+    m_supervisor_cv.notify_one();
+    m_supervisor.join();
 
+    // the notification handles refer to m_route
+    m_cache_valid = false;
+    ReleaseNotifications(m_device_state);
+    // so do the symbol handles, they are released in one exchange
+    std::vector<AdsHandle> released;
     for (map<string, IAdsVariable *>::iterator it = m_route_mapping.begin();
          it != m_route_mapping.end();
          ++it) {
-        delete it->second;
+        if (it->second) {
+            if (AdsHandle *handle = it->second->SymbolHandle()) {
+                released.push_back(std::move(*handle));
+            }
+            delete it->second;
+        }
+    }
+    if (m_route) {
+        m_route->ReleaseHandles(released);
+        delete m_route;
+    }
+    if (m_ams_net_id_remote_net_id) {
+        delete m_ams_net_id_remote_net_id;
     }
 }
 
@@ -24,74 +65,88 @@ bool AdsInterface::AdsWriteValue(
     const std::string &name,
     const variant_t &value)
 {
-    int var_type = CheckVariableType(name);
     bool data_correct = true;
     bool bresult = true;
     bool no_issue = true;
-    if (m_variable_mapping.find(name) == m_variable_mapping.end()) {
+    long error = ADSERR_DEVICE_SYMBOLNOTFOUND;  // of the failed write
+    // the mapping is rebuilt when the PLC program changes
+    std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+    const auto mapping = m_variable_mapping.find(name);
+    if (mapping == m_variable_mapping.end()) {
         data_correct = false;
         bresult = false;
-    } else if (m_variable_mapping[name].first == var_type && m_device_state) {
-        std::scoped_lock lock(m_com_mutex, m_mem_mutex);
+    } else if (m_device_state) {
+        const int var_type = mapping->second.first;
+        std::scoped_lock lane(m_lane.writes);
+        const auto found = m_route_mapping.find(name);
+        IAdsVariable *variable =
+            found != m_route_mapping.end() ? found->second : nullptr;
         try {
-            switch (m_variable_mapping[name].first) {
+            switch (variable ? var_type : -1) {
                 case BOOL: {
-                    *m_route_mapping[name] = get<bool>(value);
+                    *variable = get<bool>(value);
                     break;
                 }
                 case UINT8_T: {
-                    *m_route_mapping[name] = get<uint8_t>(value);
+                    *variable = get<uint8_t>(value);
                     break;
                 }
                 case INT8_T: {
-                    *m_route_mapping[name] = get<int8_t>(value);
+                    *variable = get<int8_t>(value);
                     break;
                 }
                 case UINT16_T: {
-                    *m_route_mapping[name] = get<uint16_t>(value);
+                    *variable = get<uint16_t>(value);
                     break;
                 }
                 case INT16_T: {
-                    *m_route_mapping[name] = get<int16_t>(value);
+                    *variable = get<int16_t>(value);
                     break;
                 }
                 case UINT32_T: {
-                    *m_route_mapping[name] = get<uint32_t>(value);
+                    *variable = get<uint32_t>(value);
                     break;
                 }
                 case INT32_T: {
-                    *m_route_mapping[name] = get<int32_t>(value);
+                    *variable = get<int32_t>(value);
                     break;
                 }
                 case INT64_T: {
-                    *m_route_mapping[name] = get<int64_t>(value);
+                    *variable = get<int64_t>(value);
                     break;
                 }
                 case FLOAT: {
-                    *m_route_mapping[name] = get<float>(value);
+                    *variable = get<float>(value);
                     break;
                 }
                 case DOUBLE: {
-                    *m_route_mapping[name] = get<double>(value);
+                    *variable = get<double>(value);
                     break;
                 }
                 case DATE: {
                     tm temp = get<tm>(value);
-                    *m_route_mapping[name] = mktime(&temp);
+                    *variable = mktime(&temp);
                     break;
                 }
                 default: {
                     no_issue = false;
                 }
             }
+            if (no_issue) {
+                CacheWrite(name, value);
+            }
         } catch (AdsException e) {
             no_issue = false;
+            error = e.errorCode;
         }
     } else {
-        Factory(name);
+        // offline, the supervisor recreates the variable
+        bresult = false;
     }
+    bind.unlock();
     if (!no_issue) {
-        Factory(name);
+        bresult = false;
+        Recover({name}, error);
     }
 
     if (!data_correct) {
@@ -102,76 +157,57 @@ bool AdsInterface::AdsWriteValue(
 
 AdsInterface::variant_t AdsInterface::AdsReadValue(const std::string &var_name)
 {
-    AdsInterface::variant_t result;
+    if (auto cached = AdsReadCached(var_name)) {
+        return cached->value;
+    }
 
-    if (m_route_mapping.find(var_name) != m_route_mapping.end()) {
-        auto no_issue = true;
+    AdsInterface::variant_t result;
+    // offline: fail fast instead of waiting for the reconnection
+    if (!m_device_state) {
+        return result;
+    }
 
-        std::scoped_lock lock(m_com_mutex, m_mem_mutex);
+    auto no_issue = true;
+    long error = ADSERR_DEVICE_SYMBOLNOTFOUND;  // of the failed read
+    {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        const auto variable = m_route_mapping.find(var_name);
+        if (variable == m_route_mapping.end()) {
+            return result;
+        }
+        std::scoped_lock lane(m_lane.reads);
         if (m_device_state) {
             try {
-                if (m_route_mapping[var_name]) {
-                    m_route_mapping[var_name]->ReadValue(&m_temp);
+                if (variable->second) {
+                    // only sizeof(type) bytes are read, clear the rest
+                    uint64_t raw = 0;
+                    variable->second->ReadValue(&raw);
 
-                    switch (m_variable_mapping[var_name].first) {
-                        case BOOL: {
-                            result = (bool)m_temp;
-                            break;
-                        }
-                        case UINT8_T: {
-                            result = (uint8_t)m_temp;
-                            break;
-                        }
-                        case INT8_T: {
-                            result = (int8_t)m_temp;
-                            break;
-                        }
-                        case UINT16_T: {
-                            result = (uint16_t)m_temp;
-                            break;
-                        }
-                        case INT16_T: {
-                            result = (int16_t)m_temp;
-                            break;
-                        }
-                        case UINT32_T: {
-                            result = (uint32_t)m_temp;
-                            break;
-                        }
-                        case INT32_T: {
-                            result = (int32_t)m_temp;
-                            break;
-                        }
-                        case INT64_T: {
-                            result = (int64_t)m_temp;
-                            break;
-                        }
-                        case FLOAT: {
-                            result = (float)m_temp;
-                            break;
-                        }
-                        case DOUBLE: {
-                            result = (double)m_temp;
-                            break;
-                        }
-                        case DATE: {
-                            result = (uint32_t)m_temp;
-                            break;
-                        }
-                        default: {
-                        }
+                    result = ToVariant(
+                        m_variable_mapping.at(var_name).first,
+                        raw);
+                    const auto entry = m_cache_index.find(var_name);
+                    if (m_cache_valid && entry != m_cache_index.end()) {
+                        s_cache[entry->second.slot].Store(
+                            raw,
+                            CacheNow(),
+                            true);
                     }
                 } else {
                     no_issue = false;
                 }
+            } catch (const AdsException &e) {
+                no_issue = false;
+                error = e.errorCode;
             } catch (const std::exception &e) {
                 no_issue = false;
+                error = ADSERR_CLIENT_ERROR;
             }
         }
+    }
 
-        if (!no_issue) {
-            Factory(var_name);
-        }
+    if (!no_issue) {
+        Recover({var_name}, error);
     }
     return result;
 }
@@ -184,104 +220,587 @@ AdsInterface::variant_t AdsInterface::AdsReadValue(const std::string &var_name)
 std::vector<AdsInterface::variant_t> AdsInterface::AdsReadVariables(
     const std::vector<std::string> &var_names)
 {
-    std::vector<AdsInterface::variant_t> result;
+    std::vector<AdsInterface::variant_t> result(var_names.size());
+    std::vector<uint64_t> values(var_names.size(), 0);
+    std::vector<bool> cached(var_names.size(), false);
+    std::vector<AdsSumRead> reads;
+    std::vector<size_t> slots;  // index in var_names of every read
+    std::vector<std::string> failed;
+    long error = ADSERR_DEVICE_SYMBOLNOTFOUND;  // of the failed reads
+    reads.reserve(var_names.size());
+    slots.reserve(var_names.size());
 
-    for (auto &name : var_names) {
-        result.push_back(AdsReadValue(name));
+    // variables updated by notifications need no request
+    size_t misses = 0;
+    for (size_t i = 0; i < var_names.size(); ++i) {
+        if (auto value = AdsReadCached(var_names[i])) {
+            result[i] = value->value;
+            cached[i] = true;
+        } else {
+            misses++;
+        }
+    }
+    if (!misses || !m_device_state) {
+        return result;
     }
 
+    {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        std::scoped_lock lane(m_lane.reads);
+        if (!m_device_state) {
+            return result;
+        }
+        for (size_t i = 0; i < var_names.size(); ++i) {
+            if (cached[i]) {
+                continue;
+            }
+            auto it = m_route_mapping.find(var_names[i]);
+            if (it == m_route_mapping.end()) {
+                continue;
+            }
+            if (!it->second) {
+                failed.push_back(var_names[i]);
+                continue;
+            }
+            // only Size() bytes are read, the rest of the value stays 0
+            reads.push_back(AdsSumRead{
+                it->second->IndexGroup(),
+                it->second->IndexOffset(),
+                it->second->Size(),
+                &values[i],
+                0});
+            slots.push_back(i);
+        }
+
+        // all variables are read in a single sum-up request
+        try {
+            if (!reads.empty()) {
+                m_route->SumReadReq(reads.data(), reads.size());
+            }
+        } catch (const std::exception &e) {
+            for (auto &read : reads) {
+                read.error = ADSERR_CLIENT_ERROR;
+            }
+        }
+
+        for (size_t j = 0; j < reads.size(); ++j) {
+            const std::string &name = var_names[slots[j]];
+            if (reads[j].error) {
+                failed.push_back(name);
+                error = IsDeviceError(error) ? reads[j].error : error;
+                continue;
+            }
+            result[slots[j]] =
+                ToVariant(m_variable_mapping.at(name).first, values[slots[j]]);
+            // fills the cache until the first notification arrives, a
+            // notification received meanwhile is newer and is kept
+            const auto entry = m_cache_index.find(name);
+            if (m_cache_valid && entry != m_cache_index.end()) {
+                s_cache[entry->second.slot].Store(
+                    values[slots[j]],
+                    CacheNow(),
+                    true);
+            }
+        }
+    }
+
+    if (!failed.empty()) {
+        Recover(failed, error);
+    }
     return result;
 }
 
 /**
- * @brief Factory (re)-create an IADS variable
- * @param var_name the alias of the variable to (re)-create
- * @return true if the creation succeeded
+ * @brief AdsExchange writes and reads several variables in a single sum-up
+ * read/write round trip
+ * @param operations the writes and reads, in the order to process them
+ * @param values receives one value per operation
+ * @return true if every operation succeeded
  */
-bool AdsInterface::Factory(const std::string &var_name)
+bool AdsInterface::AdsExchange(
+    const std::vector<Operation> &operations,
+    std::vector<AdsInterface::variant_t> &values)
 {
-    bool result = false;
-    bool no_issue = true;
+    values.assign(operations.size(), AdsInterface::variant_t());
+    std::vector<uint64_t> raws(operations.size(), 0);
+    std::vector<AdsSumReadWrite> entries;
+    std::vector<std::string> failed;
+    long error = ADSERR_DEVICE_SYMBOLNOTFOUND;  // of the failed operations
+    entries.reserve(operations.size());
+    bool result = true;
+    if (!m_device_state) {
+        return false;
+    }
 
-    std::scoped_lock lock(m_mem_mutex);
-    try {
-        string type = m_variable_ads[m_alias_map[var_name]];
-        do {
-            if (m_route_mapping[var_name]) {
-                delete m_route_mapping[var_name];
-            }
-            if (type == "BOOL") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<bool>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+    {
+        // commands go before the waiting telemetry reads
+        const bool writes = std::any_of(
+            operations.begin(),
+            operations.end(),
+            [](const Operation &operation) { return operation.write; });
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        std::scoped_lock lane(writes ? m_lane.writes : m_lane.reads);
+        if (!m_device_state) {
+            return false;
+        }
+        for (size_t i = 0; i < operations.size(); ++i) {
+            const Operation &operation = operations[i];
+            auto it = m_route_mapping.find(operation.name);
+            auto mapping = m_variable_mapping.find(operation.name);
+            if (it == m_route_mapping.end() ||
+                mapping == m_variable_mapping.end()) {
+                return false;
             }
-            if (type == "BYTE" || type == "USINT") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<uint8_t>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+            if (!it->second) {
+                failed.push_back(operation.name);
+                continue;
             }
-            if (type == "SINT") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<int8_t>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+            AdsSumReadWrite entry{
+                it->second->IndexGroup(),
+                it->second->IndexOffset(),
+                0,
+                nullptr,
+                0,
+                nullptr,
+                0,
+                0};
+            if (operation.write) {
+                // the alternatives of variant_t follow the type enum
+                if (operation.write->index() != (size_t)mapping->second.first ||
+                    !ToRaw(*operation.write, raws[i])) {
+                    return false;
+                }
+                entry.writeLength = it->second->Size();
+                entry.writeData = &raws[i];
+            } else {
+                entry.readLength = it->second->Size();
+                entry.readData = &raws[i];
             }
-            if (type == "WORD" || type == "UINT") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<uint16_t>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+            entries.push_back(entry);
+        }
+
+        // a partial exchange would split the command, nothing is sent
+        if (failed.empty()) {
+            try {
+                m_route->SumReadWriteReq(entries.data(), entries.size());
+            } catch (const std::exception &e) {
+                for (auto &entry : entries) {
+                    entry.error = ADSERR_CLIENT_ERROR;
+                }
             }
-            if (type == "INT") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<int16_t>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+            for (size_t i = 0; i < operations.size(); ++i) {
+                const Operation &operation = operations[i];
+                if (entries[i].error) {
+                    failed.push_back(operation.name);
+                    error = IsDeviceError(error) ? entries[i].error : error;
+                } else if (operation.write) {
+                    CacheWrite(operation.name, *operation.write);
+                } else {
+                    values[i] = ToVariant(
+                        m_variable_mapping.at(operation.name).first,
+                        raws[i]);
+                }
             }
-            if (type == "DWORD" || type == "UDINT" || type == "DATE" ||
-                type == "TIME" || type == "TIME_OF_DAY" || type == "LTIME") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<uint32_t>(*m_route, m_alias_map[var_name]);
-                result = true;
+        }
+        result = failed.empty();
+    }
+
+    if (!failed.empty()) {
+        Recover(failed, error);
+    }
+    return result;
+}
+
+/**
+ * @brief AdsExchangeAsync sends the round trip of AdsExchange() without
+ * waiting for it
+ * @param operations the writes and reads, in the order to process them
+ * @param done receives the result and the values
+ */
+void AdsInterface::AdsExchangeAsync(
+    const std::vector<Operation> &operations,
+    ExchangeHandler done)
+{
+    // lives until the completion, it must not refer to this interface
+    struct Exchange {
+        std::vector<int> types;  // type of each read, -1 for writes
+        std::vector<uint64_t> raws;
+        std::vector<AdsSumReadWrite> entries;
+    };
+    auto exchange = std::make_shared<Exchange>();
+    exchange->types.assign(operations.size(), -1);
+    exchange->raws.assign(operations.size(), 0);
+    exchange->entries.reserve(operations.size());
+    // done is called once the bind lock is released
+    long error = ADSERR_CLIENT_ERROR;
+    {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        bool valid = m_route && m_device_state;
+        for (size_t i = 0; valid && i < operations.size(); ++i) {
+            const Operation &operation = operations[i];
+            auto it = m_route_mapping.find(operation.name);
+            auto mapping = m_variable_mapping.find(operation.name);
+            // a partial exchange would split the command, nothing is sent
+            if (it == m_route_mapping.end() ||
+                mapping == m_variable_mapping.end() || !it->second) {
+                valid = false;
                 break;
             }
-            if (type == "DINT") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<int32_t>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+            AdsSumReadWrite entry{
+                it->second->IndexGroup(),
+                it->second->IndexOffset(),
+                0,
+                nullptr,
+                0,
+                nullptr,
+                0,
+                0};
+            if (operation.write) {
+                if (operation.write->index() != (size_t)mapping->second.first ||
+                    !ToRaw(*operation.write, exchange->raws[i])) {
+                    valid = false;
+                    break;
+                }
+                entry.writeLength = it->second->Size();
+                entry.writeData = &exchange->raws[i];
+            } else {
+                exchange->types[i] = mapping->second.first;
+                entry.readLength = it->second->Size();
+                entry.readData = &exchange->raws[i];
             }
-            if (type == "LINT") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<int64_t>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+            exchange->entries.push_back(entry);
+        }
+
+        if (valid) {
+            try {
+                error = m_route->SumReadWriteReqAsync(
+                    exchange->entries.data(),
+                    exchange->entries.size(),
+                    [exchange, done](long error, uint32_t) {
+                        bool result = !error;
+                        std::vector<AdsInterface::variant_t> values(
+                            exchange->types.size());
+                        for (size_t i = 0; i < values.size(); ++i) {
+                            result = result && !exchange->entries[i].error;
+                            if (exchange->types[i] != -1) {
+                                values[i] = ToVariant(
+                                    exchange->types[i],
+                                    exchange->raws[i]);
+                            }
+                        }
+                        done(result, std::move(values));
+                    });
+            } catch (const std::exception &e) {
+                error = ADSERR_CLIENT_ERROR;
             }
-            if (type == "REAL") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<float>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+        }
+    }
+    if (error) {
+        done(false, {});
+    }
+}
+
+/**
+ * @brief BindTyped resolves the variables of the typed registry
+ * @param bindings the variables, the index of each one is its id
+ * @return the number of variables found with the expected type
+ */
+size_t AdsInterface::BindTyped(const std::vector<TypedBinding> &bindings)
+{
+    std::unique_lock<std::shared_mutex> lock(m_bind_mutex);
+    size_t configured = 0;
+    m_typed.clear();
+    m_typed.reserve(bindings.size());
+    for (const auto &binding : bindings) {
+        TypedSlot typed;
+        typed.alias = binding.alias;
+        typed.type = binding.type;
+        const auto entry = m_cache_index.find(typed.alias);
+        if (entry != m_cache_index.end()) {
+            typed.cache_slot = entry->second.slot;
+        }
+        UpdateTyped(typed);
+        if (typed.configured) {
+            configured++;
+        }
+        m_typed.push_back(typed);
+    }
+    return configured;
+}
+
+/**
+ * @brief ReadTypedRaw reads a variable of the typed registry
+ * @param id index of the variable given to BindTyped()
+ * @param type the type as int the caller expects
+ * @param raw receives the value, zero extended
+ * @return true if the reading succeeded
+ */
+bool AdsInterface::ReadTypedRaw(size_t id, int type, uint64_t &raw)
+{
+    if (id >= m_typed.size()) {
+        return false;
+    }
+    TypedSlot &typed = m_typed[id];
+    raw = 0;
+    // the type is fixed once bound, a cached value is checked like a read one
+    if (typed.type != type) {
+        return false;
+    }
+    int64_t updated;
+    if (typed.cache_slot >= 0 && CacheFresh() &&
+        s_cache[typed.cache_slot].Load(raw, updated)) {
+        return true;
+    }
+    if (!m_device_state) {
+        return false;
+    }
+
+    long error = ADSERR_DEVICE_SYMBOLNOTFOUND;  // of the failed read
+    {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        std::scoped_lock lane(m_lane.reads);
+        if (!m_device_state || !typed.configured) {
+            return false;
+        }
+        if (typed.bound) {
+            uint32_t bytes_read = 0;
+            error = m_route->ReadReqEx2(
+                typed.index_group,
+                typed.index_offset,
+                typed.size,
+                &raw,
+                &bytes_read);
+            if (!error && bytes_read != typed.size) {
+                error = ADSERR_DEVICE_INVALIDSIZE;
             }
-            if (type == "LREAL") {
-                m_route_mapping[var_name] =
-                    new AdsVariable<double>(*m_route, m_alias_map[var_name]);
-                result = true;
-                break;
+            if (!error) {
+                if (typed.cache_slot >= 0 && m_cache_valid) {
+                    s_cache[typed.cache_slot].Store(raw, CacheNow(), true);
+                }
+                return true;
             }
-        } while (false);
-    } catch (const std::exception &e) {
-        no_issue = false;
+        }
     }
+    Recover({typed.alias}, error);
+    return false;
+}
 
-    if (!no_issue) {
-        m_ads_state = false;
-        ConnectionCheck();
+/**
+ * @brief WriteTypedRaw writes a variable of the typed registry
+ * @param id index of the variable given to BindTyped()
+ * @param type the type as int of the value
+ * @param raw the value, zero extended
+ * @return true if the writing succeeded
+ */
+bool AdsInterface::WriteTypedRaw(size_t id, int type, uint64_t raw)
+{
+    if (id >= m_typed.size()) {
+        return false;
+    }
+    TypedSlot &typed = m_typed[id];
+    if (!m_device_state) {
+        return false;
     }
 
-    return result;
+    long error = ADSERR_DEVICE_SYMBOLNOTFOUND;  // of the failed write
+    {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        std::scoped_lock lane(m_lane.writes);
+        if (!m_device_state || !typed.configured || typed.type != type) {
+            return false;
+        }
+        if (typed.bound) {
+            error = m_route->WriteReqEx(
+                typed.index_group,
+                typed.index_offset,
+                typed.size,
+                &raw);
+            if (!error) {
+                if (typed.cache_slot >= 0 && m_cache_valid) {
+                    s_cache[typed.cache_slot].Store(raw, CacheNow(), false);
+                }
+                return true;
+            }
+        }
+    }
+    Recover({typed.alias}, error);
+    return false;
+}
+
+/**
+ * @brief UpdateTyped refreshes a typed variable from its IADS variable
+ * @param typed the variable to refresh
+ */
+void AdsInterface::UpdateTyped(TypedSlot &typed)
+{
+    const auto mapping = m_variable_mapping.find(typed.alias);
+    const auto variable = m_route_mapping.find(typed.alias);
+    typed.configured = mapping != m_variable_mapping.end() &&
+                       mapping->second.first == typed.type;
+    typed.bound = typed.configured && variable != m_route_mapping.end() &&
+                  variable->second;
+    if (typed.bound) {
+        typed.index_group = variable->second->IndexGroup();
+        typed.index_offset = variable->second->IndexOffset();
+        typed.size = variable->second->Size();
+    }
+}
+
+/**
+ * @brief Factory (re)-create an IADS variable
+ * @param var_name the alias of the variable to (re)-create
+ * @return true if the creation succeeded
+ */
+bool AdsInterface::Factory(const std::string &var_name)
+{
+    // offline: the supervisor recreates every variable once reconnected
+    if (!m_device_state) {
+        return false;
+    }
+    long error;
+    bool created;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_bind_mutex);
+        if (!m_route) {
+            return false;
+        }
+        error = CreateVariables({var_name});
+        created = m_route_mapping[var_name] != nullptr;
+    }
+    if (error) {
+        RequestReconnect();
+    }
+    return created;
+}
+
+/**
+ * @brief Recover handles a failed access, the variables are re-created after
+ * a device error and the device is reconnected after any other error
+ * @param var_names the aliases of the variables that failed
+ * @param error the ADS error of the access
+ */
+void AdsInterface::Recover(const std::vector<std::string> &var_names,
+                           long error)
+{
+    // a client or transport error does not wait for two more timeouts
+    // under the exclusive bind lock
+    if (!IsDeviceError(error)) {
+        RequestReconnect();
+        return;
+    }
+    for (const auto &var_name : var_names) {
+        Factory(var_name);
+    }
+}
+
+/**
+ * @brief CreateVariables (re)-creates IADS variables, releasing and
+ * acquiring their handles in one sum-up exchange each
+ * @param var_names the aliases of the variables to (re)-create
+ * @return 0 if the handles were acquired, otherwise the ADS error
+ */
+long AdsInterface::CreateVariables(const std::vector<std::string> &var_names)
+{
+    // the old handles are released through the current route, the route
+    // they were acquired on may be gone after a reconnect
+    std::vector<AdsHandle> released;
+    for (const auto &var_name : var_names) {
+        IAdsVariable *&variable = m_route_mapping[var_name];
+        if (variable) {
+            if (AdsHandle *handle = variable->SymbolHandle()) {
+                released.push_back(std::move(*handle));
+            }
+            delete variable;
+            variable = nullptr;
+        }
+    }
+    m_route->ReleaseHandles(released);
+
+    // aliases without a loaded ADS variable stay null
+    std::vector<std::string> aliases;
+    std::vector<std::string> ads_names;
+    std::vector<const std::string *> types;
+    aliases.reserve(var_names.size());
+    ads_names.reserve(var_names.size());
+    types.reserve(var_names.size());
+    for (const auto &var_name : var_names) {
+        const auto ads_name = m_alias_map.find(var_name);
+        if (ads_name == m_alias_map.end()) {
+            continue;
+        }
+        const auto type = m_variable_ads.find(ads_name->second);
+        if (type == m_variable_ads.end()) {
+            continue;
+        }
+        aliases.push_back(var_name);
+        ads_names.push_back(ads_name->second);
+        types.push_back(&type->second);
+    }
+    std::vector<AdsHandle> handles;
+    const long error =
+        m_route->GetHandles(ads_names.data(), ads_names.size(), handles);
+    std::vector<AdsHandle> unused;
+    for (size_t i = 0; i < aliases.size(); ++i) {
+        if (*handles[i]) {
+            m_route_mapping[aliases[i]] = NewVariable(*types[i], handles[i]);
+        }
+        if (handles[i]) {
+            unused.push_back(std::move(handles[i]));
+        }
+    }
+    m_route->ReleaseHandles(unused);
+
+    // typed accesses use the new handles
+    for (auto &typed : m_typed) {
+        if (std::find(var_names.begin(), var_names.end(), typed.alias) !=
+            var_names.end()) {
+            UpdateTyped(typed);
+        }
+    }
+    return error;
+}
+
+/**
+ * @brief NewVariable creates the IADS variable of a PLC type
+ * @param type the PLC type
+ * @param handle the symbol handle, moved into the variable if created
+ * @return the variable, nullptr if the type is not supported
+ */
+IAdsVariable *AdsInterface::NewVariable(const std::string &type,
+                                        AdsHandle &handle)
+{
+    if (type == "BOOL") {
+        return new AdsVariable<bool>(*m_route, std::move(handle));
+    }
+    if (type == "BYTE" || type == "USINT") {
+        return new AdsVariable<uint8_t>(*m_route, std::move(handle));
+    }
+    if (type == "SINT") {
+        return new AdsVariable<int8_t>(*m_route, std::move(handle));
+    }
+    if (type == "WORD" || type == "UINT") {
+        return new AdsVariable<uint16_t>(*m_route, std::move(handle));
+    }
+    if (type == "INT") {
+        return new AdsVariable<int16_t>(*m_route, std::move(handle));
+    }
+    if (type == "DWORD" || type == "UDINT" || type == "DATE" ||
+        type == "TIME" || type == "TIME_OF_DAY" || type == "LTIME") {
+        return new AdsVariable<uint32_t>(*m_route, std::move(handle));
+    }
+    if (type == "DINT") {
+        return new AdsVariable<int32_t>(*m_route, std::move(handle));
+    }
+    if (type == "LINT") {
+        return new AdsVariable<int64_t>(*m_route, std::move(handle));
+    }
+    if (type == "REAL") {
+        return new AdsVariable<float>(*m_route, std::move(handle));
+    }
+    if (type == "LREAL") {
+        return new AdsVariable<double>(*m_route, std::move(handle));
+    }
+    return nullptr;
 }
 
 /**
@@ -347,8 +866,21 @@ int AdsInterface::ConvertTypeFromString(const std::string &type)
  */
 void AdsInterface::UpdateMemory()
 {
-    for (auto &[name, pair] : m_variables_map) {
-        pair.second = AdsReadValue(name);
+    std::vector<std::string> names;
+    {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        names.reserve(m_variables_map.size());
+        for (auto &[name, pair] : m_variables_map) {
+            names.push_back(name);
+        }
+    }
+    std::vector<AdsInterface::variant_t> values = AdsReadVariables(names);
+    std::unique_lock<std::shared_mutex> lock(m_bind_mutex);
+    for (size_t i = 0; i < names.size(); ++i) {
+        const auto variable = m_variables_map.find(names[i]);
+        if (variable != m_variables_map.end()) {
+            variable->second.second = values[i];
+        }
     }
 }
 
@@ -378,11 +910,34 @@ void AdsInterface::InitRoute()
 int AdsInterface::ConnectionCheck()
 {
     bool result = false;
-    int ads;
+    int ads = ADSSTATE_INVALID;
+    // a running device only needs the route, reads and writes go on
+    if (m_device_state) {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        std::scoped_lock lane(m_lane.reads);
+        try {
+            if (m_route) {
+                ads = m_route->GetState().ads;
+                m_ads_state = ads;
+            }
+        } catch (const std::exception &e) {
+            ads = ADSSTATE_INVALID;
+        }
+        if (ads == ADSSTATE_RUN && m_device_state) {
+            return ads;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_bind_mutex);
     bool temp_state = m_device_state;
-    std::scoped_lock lock(m_com_mutex);
+    bool reachable = false;
     try {
+        // a previous recovery may have failed to create the route
+        if (!m_route) {
+            InitRoute();
+        }
         ads = m_route->GetState().ads;
+        reachable = true;
         result = (ads == ADSSTATE_RUN);
         m_ads_state = (uint16_t)ads;
     } catch (const std::exception &e) {
@@ -391,11 +946,16 @@ int AdsInterface::ConnectionCheck()
 
     if (!result)  // recovery
     {
+        // the notifications die with the route
+        m_cache_valid = false;
+        ReleaseNotifications(reachable);
         if (m_route) {
             delete m_route;
+            m_route = nullptr;
         }
         if (m_ams_net_id_remote_net_id) {
             delete m_ams_net_id_remote_net_id;
+            m_ams_net_id_remote_net_id = nullptr;
         }
         InitRoute();
     }
@@ -405,9 +965,32 @@ int AdsInterface::ConnectionCheck()
     if (result &&
         !temp_state)  // recreate ADSVariables if connexion is re-established
     {
-        AcquireVariables();
+        // the values of a previous connection are not served meanwhile
+        m_cache_valid = false;
+        // the PLC program may have changed while disconnected, resolving by
+        // name or the cache make checking that cheap enough to do on every
+        // reconnect
+        if (m_resolve_by_name || !m_symbol_cache_file.empty()) {
+            const std::map<std::string, std::string> previous = m_variable_ads;
+            try {
+                LoadSymbols();
+            } catch (const std::exception &e) {
+                // the previous symbols are kept
+                m_variable_ads = previous;
+            }
+            if (m_variable_ads != previous) {
+                MapVariables();
+            }
+        }
+        std::vector<std::string> names;
         for (auto &[name, alias] : m_variable_mapping) {
-            Factory(name);
+            names.push_back(name);
+        }
+        // all handles in one exchange, retried by the next check if it fails
+        if (CreateVariables(names)) {
+            result = false;
+        } else if (m_notifications) {
+            RegisterNotifications();
         }
     }
 
@@ -417,40 +1000,363 @@ int AdsInterface::ConnectionCheck()
 }
 
 /**
- * @brief BindPLCVar creates IADS variables for aliased variables given in
- * configuration file
- * @return true if aliasing succeeded
- * @return false otherwise
+ * @brief RequestReconnect marks the device offline and wakes the supervisor
  */
-bool AdsInterface::BindPLCVar()
+void AdsInterface::RequestReconnect()
+{
+    m_device_state = false;
+    {
+        std::scoped_lock lock(m_supervisor_mutex);
+        m_reconnect_requested = true;
+    }
+    m_supervisor_cv.notify_one();
+}
+
+/**
+ * @brief Supervise reconnection thread body, retries ConnectionCheck() with
+ * an exponential backoff until the device is back
+ */
+void AdsInterface::Supervise()
+{
+    std::minstd_rand random(std::random_device{}());
+    std::unique_lock<std::mutex> lock(m_supervisor_mutex);
+    const auto woken = [this]() {
+        return m_supervisor_stop || m_reconnect_requested;
+    };
+    for (;;) {
+        if (m_heartbeat) {
+            m_supervisor_cv.wait_for(lock, m_cache_heartbeat, woken);
+        } else {
+            // until a request, or the first heartbeat once enabled
+            m_supervisor_cv.wait(
+                lock,
+                [&]() { return woken() || m_heartbeat; });
+        }
+        if (m_supervisor_stop) {
+            return;
+        }
+        if (!m_reconnect_requested) {
+            // cached reads send nothing that would notice a dead link
+            lock.unlock();
+            const bool alive = Heartbeat();
+            lock.lock();
+            if (alive || m_supervisor_stop) {
+                continue;
+            }
+        }
+        m_reconnect_requested = false;
+        // makes ConnectionCheck() recreate the variables, also when a
+        // request arrived while the device was reconnected
+        m_device_state = false;
+        const auto start = std::chrono::steady_clock::now();
+        auto backoff = m_backoff_min;
+        uint32_t attempts = 0;
+        for (;;) {
+            lock.unlock();
+            attempts++;
+            m_reconnect_attempts++;
+            try {
+                ConnectionCheck();
+            } catch (const std::exception &e) {
+                // the route could not be created, retried below
+            }
+            lock.lock();
+            if (m_device_state || m_supervisor_stop) {
+                break;
+            }
+            // jitter keeps the supervisors of many devices from retrying
+            // in step
+            std::uniform_int_distribution<int64_t> jitter(
+                backoff.count() / 2,
+                backoff.count());
+            m_supervisor_cv.wait_for(
+                lock,
+                std::chrono::milliseconds(jitter(random)),
+                [this]() { return m_supervisor_stop; });
+            if (m_supervisor_stop) {
+                return;
+            }
+            backoff = std::min(backoff * 2, m_backoff_max);
+        }
+        if (m_device_state) {
+            m_reconnects++;
+            if (m_reconnect_handler) {
+                m_reconnect_handler(
+                    std::chrono::steady_clock::now() - start,
+                    attempts);
+            }
+        }
+    }
+}
+
+/**
+ * @brief SetReconnectBackoff sets the delays between reconnection attempts
+ * @param min the delay after the first failed attempt
+ * @param max the delay is doubled after each failed attempt up to max
+ */
+void AdsInterface::SetReconnectBackoff(
+    std::chrono::milliseconds min,
+    std::chrono::milliseconds max)
+{
+    std::scoped_lock lock(m_supervisor_mutex);
+    m_backoff_min = std::max(min, std::chrono::milliseconds(1));
+    m_backoff_max = std::max(max, m_backoff_min);
+}
+
+/**
+ * @brief Heartbeat reads the ADS state to confirm the notification cache
+ * @return false if the PLC is not running or unreachable
+ */
+bool AdsInterface::Heartbeat()
 {
+    // nothing is served from the cache, or a reconnection is under way
+    if (!m_cache_valid || !m_device_state) {
+        return true;
+    }
+    int ads = ADSSTATE_INVALID;
+    {
+        std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
+        std::scoped_lock lane(m_lane.reads);
+        try {
+            if (m_route) {
+                ads = m_route->GetState().ads;
+            }
+        } catch (const std::exception &e) {
+            ads = ADSSTATE_INVALID;
+        }
+    }
+    m_ads_state = ads;
+    if (ads != ADSSTATE_RUN) {
+        // the notifications stopped, the last values are not published
+        m_cache_valid = false;
+        return false;
+    }
+    m_cache_confirmed = CacheNow();
+    return true;
+}
+
+/**
+ * @brief CacheFresh
+ * @return true if the notification cache is registered and the connection
+ * was confirmed recently
+ */
+bool AdsInterface::CacheFresh() const
+{
+    return m_cache_valid.load(std::memory_order_acquire) &&
+           CacheNow() - m_cache_confirmed.load(std::memory_order_relaxed) <=
+               m_cache_max_age.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief SetCacheHeartbeat sets how often the connection is checked while
+ * reads are served from the notification cache
+ * @param period the delay between two ADS state reads
+ */
+void AdsInterface::SetCacheHeartbeat(std::chrono::milliseconds period)
+{
+    {
+        std::scoped_lock lock(m_supervisor_mutex);
+        m_cache_heartbeat = std::max(period, std::chrono::milliseconds(1));
+        m_cache_max_age =
+            std::chrono::steady_clock::duration(
+                m_cache_heartbeat * ADS_CACHE_MAX_MISSED_HEARTBEATS)
+                .count();
+    }
+    m_supervisor_cv.notify_one();
+}
+
+/**
+ * @brief SetReconnectHandler sets the function called after each reconnection
+ * @param handler called on the supervisor thread, may be empty
+ */
+void AdsInterface::SetReconnectHandler(ReconnectHandler handler)
+{
+    std::scoped_lock lock(m_supervisor_mutex);
+    m_reconnect_handler = std::move(handler);
+}
+
+/**
+ * @brief GetReconnectStats
+ * @return the counters of the reconnection supervisor
+ */
+AdsInterface::ReconnectStats AdsInterface::GetReconnectStats() const
+{
+    return {m_reconnect_attempts, m_reconnects, !m_device_state};
+}
+
+/**
+ * @brief LoadSymbols fills m_variable_ads from the symbol cache file or the
+ * symbol table upload
+ */
+void AdsInterface::LoadSymbols()
+{
+    if (m_resolve_by_name) {
+        std::vector<AdsSymbolInfo> symbols;
+        if (m_config) {
+            for (YAML::const_iterator element = m_config["variables"].begin();
+                 element != m_config["variables"].end();
+                 ++element) {
+                AdsSymbolInfo symbol{};
+                symbol.name = element->first.as<std::string>();
+                symbols.push_back(symbol);
+            }
+        }
+        // all variables are resolved in a single sum-up request
+        const long error =
+            m_route->GetSymbolInfos(symbols.data(), symbols.size());
+        if (error) {
+            throw AdsException(error);
+        }
+        // only symbols the PLC does not know are dropped, a symbol that
+        // failed otherwise keeps its previous type
+        std::map<std::string, std::string> variables;
+        for (const auto &symbol : symbols) {
+            if (!symbol.error) {
+                variables[symbol.name] = symbol.type;
+            } else if (symbol.error != ADSERR_DEVICE_SYMBOLNOTFOUND) {
+                const auto previous = m_variable_ads.find(symbol.name);
+                if (previous != m_variable_ads.end()) {
+                    variables.insert(*previous);
+                }
+            }
+        }
+        m_variable_ads = std::move(variables);
+        return;
+    }
+    if (m_symbol_cache_file.empty()) {
+        m_variable_ads = m_route->GetDeviceAdsVariables();
+        return;
+    }
+    AdsSymbolCache::Key key;
+    try {
+        const AdsSymbolUploadInfo info = m_route->GetSymbolUploadInfo();
+        key = AdsSymbolCache::Key{
+            m_route->GetSymbolVersion(),
+            info.nSymbols,
+            info.nSymSize};
+    } catch (const AdsException &e) {
+        // a cache that cannot be validated is not used
+        m_variable_ads = m_route->GetDeviceAdsVariables();
+        return;
+    }
+
+    AdsSymbolCache cache;
+    if (!cache.Open(m_symbol_cache_file, key)) {
+        std::map<std::string, std::string> variables =
+            m_route->GetDeviceAdsVariables();
+        if (!AdsSymbolCache::Write(m_symbol_cache_file, key, variables) ||
+            !cache.Open(m_symbol_cache_file, key)) {
+            m_variable_ads = std::move(variables);
+            return;
+        }
+    }
+    m_variable_ads.clear();
     if (m_config) {
-        // Read each alias with corresponding ADS name
         for (YAML::const_iterator element = m_config["variables"].begin();
              element != m_config["variables"].end();
              ++element) {
-            std::string ads_name = element->first.as<std::string>();
-            std::string alias = element->second.as<std::string>();
-            // Check if ADS name is part of downloaded PLC ADS list
-            if (m_variable_ads.find(ads_name) == m_variable_ads.end()) {
-                continue;
+            const std::string ads_name = element->first.as<std::string>();
+            if (auto type = cache.Type(ads_name)) {
+                m_variable_ads[ads_name] = *type;
             }
+        }
+    }
+}
 
-            std::string type = m_variable_ads[ads_name];
-            m_variable_mapping[alias] =
-                std::pair<int, std::string>(ConvertTypeFromString(type), type);
-            m_variables_map[alias] =
-                std::pair<std::string, AdsInterface::variant_t>(
-                    type,
-                    AdsInterface::variant_t());
-            m_alias_map[alias] = ads_name;
-            Factory(alias);
+/**
+ * @brief BindPLCVar creates IADS variables for aliased variables given in
+ * configuration file
+ * @return true if aliasing succeeded
+ * @return false otherwise
+ */
+bool AdsInterface::BindPLCVar()
+{
+    if (m_config) {
+        std::unique_lock<std::shared_mutex> lock(m_bind_mutex);
+        const std::vector<std::string> aliases = MapVariables();
+        // all handles in one exchange
+        const long error = CreateVariables(aliases);
+        lock.unlock();
+        if (error) {
+            RequestReconnect();
         }
         return true;
     }
     return false;
 }
 
+/**
+ * @brief MapVariables maps the aliases given in configuration file to the
+ * loaded ADS variables
+ * @return the aliases found in the loaded variables
+ */
+std::vector<std::string> AdsInterface::MapVariables()
+{
+    std::vector<std::string> aliases;
+    m_variable_mapping.clear();
+    m_alias_map.clear();
+    // Read each alias with corresponding ADS name
+    for (YAML::const_iterator element = m_config["variables"].begin();
+         element != m_config["variables"].end();
+         ++element) {
+        std::string ads_name = element->first.as<std::string>();
+        std::string alias = element->second.as<std::string>();
+        // Check if ADS name is part of downloaded PLC ADS list
+        const auto variable = m_variable_ads.find(ads_name);
+        if (variable == m_variable_ads.end()) {
+            continue;
+        }
+
+        const std::string &type = variable->second;
+        m_variable_mapping[alias] =
+            std::pair<int, std::string>(ConvertTypeFromString(type), type);
+        m_alias_map[alias] = ads_name;
+        aliases.push_back(alias);
+    }
+
+    // variables gone from the PLC program are released
+    std::vector<AdsHandle> released;
+    for (auto it = m_route_mapping.begin(); it != m_route_mapping.end();) {
+        if (m_variable_mapping.count(it->first)) {
+            ++it;
+            continue;
+        }
+        if (it->second) {
+            if (AdsHandle *handle = it->second->SymbolHandle()) {
+                released.push_back(std::move(*handle));
+            }
+            delete it->second;
+        }
+        it = m_route_mapping.erase(it);
+    }
+    if (m_route) {
+        m_route->ReleaseHandles(released);
+    }
+    for (auto it = m_variables_map.begin(); it != m_variables_map.end();) {
+        it = m_variable_mapping.count(it->first) ? std::next(it)
+                                                 : m_variables_map.erase(it);
+    }
+    for (auto &[alias, mapping] : m_variable_mapping) {
+        auto &variable = m_variables_map[alias];
+        if (variable.first != mapping.second) {
+            variable = std::pair<std::string, AdsInterface::variant_t>(
+                mapping.second,
+                AdsInterface::variant_t());
+        }
+    }
+    // the cache slots stay, their values are decoded with the new types
+    for (auto &[alias, entry] : m_cache_index) {
+        const auto mapping = m_variable_mapping.find(alias);
+        if (mapping != m_variable_mapping.end()) {
+            entry.type = mapping->second.first;
+        }
+    }
+    for (auto &typed : m_typed) {
+        UpdateTyped(typed);
+    }
+    return aliases;
+}
+
 /**
  * @brief CheckVariableType
  * @param var_name the name of the variable to check the type of
@@ -459,6 +1365,7 @@ bool AdsInterface::BindPLCVar()
  */
 int AdsInterface::CheckVariableType(const std::string &var_name)
 {
+    std::shared_lock<std::shared_mutex> bind(m_bind_mutex);
     std::map<std::string, std::pair<int, std::string>>::iterator it =
         m_variable_mapping.find(var_name);
     if (it != m_variable_mapping.end()) {
@@ -466,3 +1373,409 @@ int AdsInterface::CheckVariableType(const std::string &var_name)
     }
     return -1;
 }
+
+/**
+ * @brief EnableNotifications registers an on-change ADS notification for
+ * every aliased variable
+ * @param cycle_ms how often the PLC checks the variables for changes in ms
+ * @param polled aliases of variables that are always read from the PLC
+ * @return the number of variables registered now
+ */
+size_t AdsInterface::EnableNotifications(
+    uint32_t cycle_ms,
+    const std::set<std::string> &polled)
+{
+    std::unique_lock<std::shared_mutex> lock(m_bind_mutex);
+    if (m_notifications) {
+        return 0;
+    }
+    m_notification_cycle_ms = cycle_ms;
+    for (auto &[name, type] : m_variable_mapping) {
+        if (polled.count(name)) {
+            continue;
+        }
+        const uint32_t slot = s_cache_used.fetch_add(1);
+        if (slot >= s_cache.size()) {
+            // the remaining variables are polled
+            break;
+        }
+        CacheEntry &entry = m_cache_index[name];
+        entry.slot = slot;
+        entry.type = type.first;
+    }
+    for (auto &typed : m_typed) {
+        const auto entry = m_cache_index.find(typed.alias);
+        if (entry != m_cache_index.end()) {
+            typed.cache_slot = entry->second.slot;
+        }
+    }
+    m_notifications = true;
+    {
+        std::scoped_lock supervisor(m_supervisor_mutex);
+        m_heartbeat = true;
+    }
+    m_supervisor_cv.notify_one();
+    if (!m_device_state) {
+        // registered by ConnectionCheck() once the device is running
+        return 0;
+    }
+    return RegisterNotifications();
+}
+
+/**
+ * @brief AdsReadCached reads a variable from the notification cache
+ * @param var_name name of the variable to read
+ * @return the value and the time it was received, if any
+ */
+std::optional<AdsInterface::CachedValue> AdsInterface::AdsReadCached(
+    const std::string &var_name)
+{
+    if (!CacheFresh()) {
+        return std::nullopt;
+    }
+    const auto entry = m_cache_index.find(var_name);
+    if (entry == m_cache_index.end()) {
+        return std::nullopt;
+    }
+    uint64_t raw;
+    int64_t updated;
+    if (!s_cache[entry->second.slot].Load(raw, updated)) {
+        return std::nullopt;
+    }
+    return CachedValue{
+        ToVariant(entry->second.type, raw),
+        std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(updated))};
+}
+
+/**
+ * @brief RegisterNotifications (re)-registers the notifications of all cached
+ * variables
+ * @return the number of registered notifications
+ */
+size_t AdsInterface::RegisterNotifications()
+{
+    m_cache_valid = false;
+    // releases the notifications of a previous registration
+    ReleaseNotifications(true);
+
+    std::vector<AdsSumNotification> entries;
+    for (auto &[name, entry] : m_cache_index) {
+        s_cache[entry.slot].Clear();
+        const auto variable = m_route_mapping.find(name);
+        if (variable == m_route_mapping.end() || !variable->second) {
+            continue;
+        }
+        AdsSumNotification notification{};
+        notification.indexGroup = variable->second->IndexGroup();
+        notification.indexOffset = variable->second->IndexOffset();
+        notification.attrib.cbLength = variable->second->Size();
+        notification.attrib.nTransMode = ADSTRANS_SERVERONCHA;
+        notification.attrib.nMaxDelay = 0;
+        // in 100 ns
+        notification.attrib.nCycleTime = m_notification_cycle_ms * 10000;
+        notification.hUser = entry.slot;
+        entries.push_back(notification);
+    }
+
+    try {
+        m_route->SumAddNotificationReq(
+            entries.data(),
+            entries.size(),
+            &AdsInterface::OnNotification,
+            m_notification_handles);
+    } catch (const std::exception &e) {
+        ReleaseNotifications(false);
+        return 0;
+    }
+
+    // variables without a notification keep being polled
+    size_t registered = 0;
+    std::vector<AdsSumRead> reads;
+    std::vector<size_t> slots;  // index in entries of every read
+    std::vector<uint64_t> values(entries.size(), 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const AdsSumNotification &notification = entries[i];
+        if (notification.error) {
+            continue;
+        }
+        s_cache[notification.hUser].registered = true;
+        registered++;
+        if (notification.attrib.cbLength <= sizeof(uint64_t)) {
+            reads.push_back(AdsSumRead{
+                notification.indexGroup,
+                notification.indexOffset,
+                notification.attrib.cbLength,
+                &values[i],
+                0});
+            slots.push_back(i);
+        }
+    }
+    // the first notification of a variable may arrive before its handle is
+    // known and be dropped, one read fills the slots in its place. A
+    // notification stored meanwhile is newer and is kept.
+    try {
+        if (!reads.empty()) {
+            m_route->SumReadReq(reads.data(), reads.size());
+        }
+    } catch (const std::exception &e) {
+        for (auto &read : reads) {
+            read.error = ADSERR_CLIENT_ERROR;
+        }
+    }
+    for (size_t j = 0; j < reads.size(); ++j) {
+        if (!reads[j].error) {
+            const size_t i = slots[j];
+            s_cache[entries[i].hUser].Store(values[i], CacheNow(), true);
+        }
+    }
+    // the registration went through the connection
+    m_cache_confirmed = CacheNow();
+    m_cache_valid = true;
+    return registered;
+}
+
+/**
+ * @brief ReleaseNotifications deletes or drops the registered notifications
+ */
+void AdsInterface::ReleaseNotifications(bool reachable)
+{
+    if (m_notification_handles.empty()) {
+        return;
+    }
+    if (!m_route) {
+        m_notification_handles.clear();
+        return;
+    }
+    m_route->DeleteNotificationHandles(
+        m_notification_handles,
+        reachable ? ADS_NOTIFICATION_DELETE_TIMEOUT_MS : 0);
+}
+
+/**
+ * @brief OnNotification stores a notified value in its cache slot
+ */
+void AdsInterface::OnNotification(
+    const AmsAddr * /*addr*/,
+    const AdsNotificationHeader *notification,
+    uint32_t user)
+{
+    if (user >= s_cache.size()) {
+        return;
+    }
+    uint64_t raw = 0;
+    std::memcpy(
+        &raw,
+        notification + 1,
+        std::min<size_t>(notification->cbSampleSize, sizeof(raw)));
+    s_cache[user].Store(raw, CacheNow(), false);
+}
+
+/**
+ * @brief CacheWrite updates the cache with a value written to the PLC, the
+ * notification of the change follows within a PLC cycle
+ */
+void AdsInterface::CacheWrite(const std::string &name, const variant_t &value)
+{
+    if (!m_cache_valid) {
+        return;
+    }
+    const auto entry = m_cache_index.find(name);
+    if (entry == m_cache_index.end()) {
+        return;
+    }
+    uint64_t raw = 0;
+    if (ToRaw(value, raw)) {
+        s_cache[entry->second.slot].Store(raw, CacheNow(), false);
+    }
+}
+
+/**
+ * @brief ToRaw converts a value to the raw little endian bytes written to the
+ * PLC
+ * @return false if the value has no plain representation
+ */
+bool AdsInterface::ToRaw(const variant_t &value, uint64_t &raw)
+{
+    raw = 0;
+    return std::visit(
+        [&raw](const auto &v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, tm>) {
+                return false;
+            } else {
+                std::memcpy(&raw, &v, sizeof(v));
+                return true;
+            }
+        },
+        value);
+}
+
+void AdsInterface::RequestLane::Lock(bool priority)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (priority) {
+        m_priority_waiting++;
+        m_priority_cv.wait(lock, [this]() {
+            return m_in_flight < m_capacity;
+        });
+        m_priority_waiting--;
+    } else {
+        m_cv.wait(lock, [this]() {
+            return m_in_flight < m_capacity && !m_priority_waiting;
+        });
+    }
+    m_in_flight++;
+}
+
+void AdsInterface::RequestLane::Unlock()
+{
+    bool priority;
+    {
+        std::scoped_lock lock(m_mutex);
+        m_in_flight--;
+        priority = m_priority_waiting != 0;
+    }
+    // a single waiter can take the lane, a waiting write first
+    if (priority) {
+        m_priority_cv.notify_one();
+    } else {
+        m_cv.notify_one();
+    }
+}
+
+void AdsInterface::RequestLane::SetCapacity(uint32_t capacity)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_capacity = std::max<uint32_t>(capacity, 1);
+    }
+    m_priority_cv.notify_all();
+    m_cv.notify_all();
+}
+
+void AdsInterface::CacheSlot::Store(uint64_t raw, int64_t time, bool if_empty)
+{
+    uint32_t current = sequence.load(std::memory_order_relaxed);
+    for (;;) {
+        if (if_empty && current != 0) {
+            return;
+        }
+        if (current & 1) {
+            current = sequence.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (sequence.compare_exchange_weak(
+                current,
+                current + 1,
+                std::memory_order_acquire,
+                std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    value.store(raw, std::memory_order_relaxed);
+    updated.store(time, std::memory_order_relaxed);
+    // 0 marks an empty slot
+    const uint32_t next = current + 2;
+    sequence.store(next ? next : 2, std::memory_order_release);
+}
+
+bool AdsInterface::CacheSlot::Load(uint64_t &raw, int64_t &time) const
+{
+    if (!registered.load(std::memory_order_acquire)) {
+        return false;
+    }
+    for (;;) {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if (before & 1) {
+            continue;
+        }
+        raw = value.load(std::memory_order_relaxed);
+        time = updated.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+}
+
+void AdsInterface::CacheSlot::Clear()
+{
+    registered = false;
+    uint32_t current = sequence.load(std::memory_order_relaxed);
+    while ((current & 1) ||
+           !sequence.compare_exchange_weak(
+               current,
+               current + 1,
+               std::memory_order_acquire,
+               std::memory_order_relaxed)) {
+        if (current & 1) {
+            current = sequence.load(std::memory_order_relaxed);
+        }
+    }
+    sequence.store(0, std::memory_order_release);
+}
+
+/**
+ * @brief ToVariant converts a raw value read from the PLC to its type
+ * @param type the type of the variable as int
+ * @param raw the value as read, zero extended
+ * @return variant_t value of the variable
+ */
+AdsInterface::variant_t AdsInterface::ToVariant(int type, uint64_t raw)
+{
+    AdsInterface::variant_t result;
+    switch (type) {
+        case BOOL: {
+            result = (bool)raw;
+            break;
+        }
+        case UINT8_T: {
+            result = (uint8_t)raw;
+            break;
+        }
+        case INT8_T: {
+            result = (int8_t)raw;
+            break;
+        }
+        case UINT16_T: {
+            result = (uint16_t)raw;
+            break;
+        }
+        case INT16_T: {
+            result = (int16_t)raw;
+            break;
+        }
+        case UINT32_T: {
+            result = (uint32_t)raw;
+            break;
+        }
+        case INT32_T: {
+            result = (int32_t)raw;
+            break;
+        }
+        case INT64_T: {
+            result = (int64_t)raw;
+            break;
+        }
+        case FLOAT: {
+            result = (float)raw;
+            break;
+        }
+        case DOUBLE: {
+            result = (double)raw;
+            break;
+        }
+        case DATE: {
+            result = (uint32_t)raw;
+            break;
+        }
+        default: {
+        }
+    }
+    return result;
+}
@@ -0,0 +1,184 @@
+#include "AdsSymbolCache.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// identifies a symbol cache file, "TRLS"
+#define CACHE_MAGIC 0x534c5254
+#define CACHE_FORMAT 1
+
+AdsSymbolCache::AdsSymbolCache() {}
+
+AdsSymbolCache::~AdsSymbolCache()
+{
+    Close();
+}
+
+/**
+ * @brief Open maps a cache file
+ * @param path the cache file
+ * @param key the symbol table the file must hold
+ * @return true if the file holds that table
+ */
+bool AdsSymbolCache::Open(const std::string &path, const Key &key)
+{
+    Close();
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) ||
+        static_cast<size_t>(file_stat.st_size) < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    const size_t size = file_stat.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid without the descriptor
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    m_header = static_cast<const Header *>(mapping);
+    m_mapped_size = size;
+
+    const Header &header = *m_header;
+    if (header.magic != CACHE_MAGIC || header.format != CACHE_FORMAT ||
+        header.key.symbol_version != key.symbol_version ||
+        header.key.symbols != key.symbols ||
+        header.key.symbol_size != key.symbol_size ||
+        size != sizeof(Header) + header.count * sizeof(Entry) +
+                    header.strings_size) {
+        Close();
+        return false;
+    }
+    m_entries = reinterpret_cast<const Entry *>(m_header + 1);
+    m_strings = reinterpret_cast<const char *>(m_entries + header.count);
+    for (uint32_t i = 0; i < header.count; ++i) {
+        const Entry &entry = m_entries[i];
+        if (entry.name_offset + uint64_t(entry.name_length) >
+                header.strings_size ||
+            entry.type_offset + uint64_t(entry.type_length) >
+                header.strings_size) {
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Close unmaps the cache file
+ */
+void AdsSymbolCache::Close()
+{
+    if (m_header) {
+        munmap(const_cast<Header *>(m_header), m_mapped_size);
+    }
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_strings = nullptr;
+    m_mapped_size = 0;
+}
+
+/**
+ * @brief Write replaces a cache file
+ * @param path the cache file
+ * @param key the symbol table written
+ * @param variables name and type of every symbol
+ * @return true if the file was written
+ */
+bool AdsSymbolCache::Write(
+    const std::string &path,
+    const Key &key,
+    const std::map<std::string, std::string> &variables)
+{
+    Header header{};
+    header.magic = CACHE_MAGIC;
+    header.format = CACHE_FORMAT;
+    header.key = key;
+    std::vector<Entry> entries;
+    std::string strings;
+    entries.reserve(variables.size());
+    // std::map iterates in the order Type() searches in
+    for (const auto &[name, type] : variables) {
+        if (name.size() > UINT16_MAX || type.size() > UINT16_MAX ||
+            strings.size() + name.size() + type.size() > UINT32_MAX) {
+            return false;
+        }
+        Entry entry;
+        entry.name_offset = static_cast<uint32_t>(strings.size());
+        entry.name_length = static_cast<uint16_t>(name.size());
+        strings += name;
+        entry.type_offset = static_cast<uint32_t>(strings.size());
+        entry.type_length = static_cast<uint16_t>(type.size());
+        strings += type;
+        entries.push_back(entry);
+    }
+    header.count = static_cast<uint32_t>(entries.size());
+    header.strings_size = strings.size();
+
+    // readers only ever see a complete file
+    const std::string temp_path = path + ".tmp";
+    FILE *file = fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written =
+        fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(entries.data(), sizeof(Entry), entries.size(), file) ==
+            entries.size() &&
+        fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+    written = fflush(file) == 0 && fsync(fileno(file)) == 0 && written;
+    if (fclose(file) || !written ||
+        rename(temp_path.c_str(), path.c_str())) {
+        remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Type finds the type of a symbol by a binary search of the mapping
+ * @param name the ADS name of the symbol
+ * @return the type, empty if the symbol is unknown
+ */
+std::optional<std::string> AdsSymbolCache::Type(const std::string &name) const
+{
+    if (!m_header) {
+        return std::nullopt;
+    }
+    auto name_of = [this](const Entry &entry) {
+        return std::string_view(
+            m_strings + entry.name_offset,
+            entry.name_length);
+    };
+    const Entry *end = m_entries + m_header->count;
+    const Entry *entry = std::lower_bound(
+        m_entries,
+        end,
+        std::string_view(name),
+        [&](const Entry &e, std::string_view n) { return name_of(e) < n; });
+    if (entry == end || name_of(*entry) != name) {
+        return std::nullopt;
+    }
+    return std::string(m_strings + entry->type_offset, entry->type_length);
+}
+
+/**
+ * @brief Size
+ * @return the number of symbols in the cache
+ */
+size_t AdsSymbolCache::Size() const
+{
+    return m_header ? m_header->count : 0;
+}
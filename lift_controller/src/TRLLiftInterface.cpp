@@ -1,5 +1,29 @@
 #include "TRLLiftInterface.hpp"
 
+namespace {
+// variables read by Snapshot(), indexes into kSnapshotVariables
+enum
+{
+    SNAPSHOT_CURRENT_FLOOR,
+    SNAPSHOT_DESTINATION_FLOOR,
+    SNAPSHOT_DOOR_STATE,
+    SNAPSHOT_MOTION_STATE,
+    SNAPSHOT_FIRE_ALARM,
+    SNAPSHOT_TURN_KEY_TO_MANUAL,
+    SNAPSHOT_AGV_MODE,
+};
+
+const std::vector<std::string> kSnapshotVariables = {
+    "liftCurrentFloor",
+    "liftDestinationFloor",
+    "liftDoorState",
+    "liftMotionState",
+    "fireAlarm",
+    "turnKeyToManual",
+    "agvMode",
+};
+}  // namespace
+
 TRLLiftInterface::TRLLiftInterface() {}
 
 TRLLiftInterface::~TRLLiftInterface() {}
@@ -22,6 +46,35 @@ bool TRLLiftInterface::Initialize(
                 config["remoteNetID"].as<std::string>());
             m_adsinterface.SetName(name);
             m_adsinterface.SetFile(config);
+            // optional: resolve the configured variables only
+            if (config["resolve_symbols_by_name"]) {
+                m_adsinterface.SetResolveByName(
+                    config["resolve_symbols_by_name"].as<bool>());
+            }
+            // optional: keep the PLC symbol table between runs
+            if (config["symbol_cache_file"]) {
+                m_adsinterface.SetSymbolCacheFile(
+                    config["symbol_cache_file"].as<std::string>());
+            }
+            // optional: delays between reconnection attempts
+            if (config["reconnect_backoff_min_ms"] ||
+                config["reconnect_backoff_max_ms"]) {
+                m_adsinterface.SetReconnectBackoff(
+                    std::chrono::milliseconds(
+                        config["reconnect_backoff_min_ms"]
+                            ? config["reconnect_backoff_min_ms"].as<int>()
+                            : ADS_RECONNECT_BACKOFF_MIN_MS),
+                    std::chrono::milliseconds(
+                        config["reconnect_backoff_max_ms"]
+                            ? config["reconnect_backoff_max_ms"].as<int>()
+                            : ADS_RECONNECT_BACKOFF_MAX_MS));
+            }
+            // optional: requests sent before their responses arrive
+            if (config["max_requests_in_flight"]) {
+                m_adsinterface.SetMaxRequestsInFlight(
+                    config["max_requests_in_flight"].as<uint32_t>());
+            }
+            SetReconnectHandler(nullptr);
             m_available_floors =
                 config["available_floors"].as<std::vector<std::string>>();
             m_available_modes =
@@ -57,8 +110,38 @@ bool TRLLiftInterface::Initialize(
 
     // acquire variables
     try {
+        // the variables are only acquired from a device known to be running
+        m_adsinterface.ConnectionCheck();
         m_adsinterface.AcquireVariables();
         m_adsinterface.BindPLCVar();
+        const size_t typed = m_adsinterface.BindTyped({
+#define TRL_LIFT_VARIABLE_BINDING(name, type, alias) \
+    {alias, AdsInterface::TypeOf<type>()},
+            TRL_LIFT_VARIABLES(TRL_LIFT_VARIABLE_BINDING)
+#undef TRL_LIFT_VARIABLE_BINDING
+        });
+        BOOST_LOG_TRIVIAL(info)
+            << "TRLLiftInterface::initialize " << typed << " of "
+            << static_cast<size_t>(LiftVar::Count)
+            << " lift variables are configured with their expected type.";
+        // optional: serve reads from a cache updated by ADS notifications
+        if (config["notifications"] && config["notifications"].as<bool>()) {
+            const uint32_t cycle_ms =
+                config["notification_cycle_ms"]
+                    ? config["notification_cycle_ms"].as<uint32_t>()
+                    : 0;
+            // optional: how often the cached values are confirmed
+            if (config["notification_heartbeat_ms"]) {
+                m_adsinterface.SetCacheHeartbeat(std::chrono::milliseconds(
+                    config["notification_heartbeat_ms"].as<int>()));
+            }
+            // the cycle counter changes every cycle
+            const size_t registered =
+                m_adsinterface.EnableNotifications(cycle_ms, {"plcCycleCount"});
+            BOOST_LOG_TRIVIAL(info)
+                << "TRLLiftInterface::initialize " << registered
+                << " variables are updated by ADS notifications.";
+        }
         BOOST_LOG_TRIVIAL(info)
             << "TRLLiftInterface::initialize Ready to communicate with the remote PLC via ADS.";
     } catch (AdsException ex) {
@@ -85,24 +168,22 @@ bool TRLLiftInterface::HeartbeatConnection()
 {
     /// TODO!!: redo this
     time_t current_time;
-    try {
-        if (std::get<int16_t>(m_adsinterface.AdsReadValue("randomCount")) <=
-            0) {
-            m_adsinterface.AdsWriteValue("randomCount", (int16_t)1);
-            BOOST_LOG_TRIVIAL(debug)
-                << "Reading randomCount: "
-                << std::get<int16_t>(
-                       m_adsinterface.AdsReadValue("randomCount"));
-            current_time = time(0);
-        } else if ((time(0) - current_time) > 10) {
-            return false;
-        }
-        return true;
-    } catch (const std::exception &e) {
+    const auto random_count = Read<LiftVar::RandomCount>();
+    if (!random_count) {
         BOOST_LOG_TRIVIAL(error)
-            << "TRLLiftInterface::HeartbeatConnection Error. " << e.what();
+            << "TRLLiftInterface::HeartbeatConnection Couldn't get randomCount.";
+        return false;
+    }
+    if (*random_count <= 0) {
+        Write<LiftVar::RandomCount>(1);
+        BOOST_LOG_TRIVIAL(debug)
+            << "Reading randomCount: "
+            << Read<LiftVar::RandomCount>().value_or(0);
+        current_time = time(0);
+    } else if ((time(0) - current_time) > 10) {
         return false;
     }
+    return true;
 }
 
 const std::vector<std::string> &TRLLiftInterface::AvailableFloors() const
@@ -117,128 +198,157 @@ const std::vector<int> &TRLLiftInterface::AvailableModes() const
 
 int TRLLiftInterface::CurrentMode()
 {
-    try {
-        // BOOST_LOG_TRIVIAL(debug) << "---current mode---";
-        // BOOST_LOG_TRIVIAL(debug)
-        //     << "State: "
-        //     << std::get<int16_t>(m_adsinterface.AdsReadValue("state"));
-        // BOOST_LOG_TRIVIAL(debug)
-        //     << "lifttask: "
-        //     << std::get<bool>(m_adsinterface.AdsReadValue("liftTask"));
-        // BOOST_LOG_TRIVIAL(debug)
-        //     << "EndliftTask: "
-        //     << std::get<bool>(m_adsinterface.AdsReadValue("endLiftTask"));
-        // BOOST_LOG_TRIVIAL(debug)
-        //     << "fireAlarm: "
-        //     << std::get<bool>(m_adsinterface.AdsReadValue("fireAlarm"));
-        // BOOST_LOG_TRIVIAL(debug)
-        //     << "turnKeyToManual: "
-        //     <<
-        //     std::get<bool>(m_adsinterface.AdsReadValue("turnKeyToManual"));
-        // BOOST_LOG_TRIVIAL(debug) << "----------------";
-
-        if (std::get<bool>(m_adsinterface.AdsReadValue("fireAlarm"))) {
-            return 3;
-        } else if (std::get<bool>(
-                       m_adsinterface.AdsReadValue("turnKeyToManual"))) {
-            return 4;
-        } else if (std::get<bool>(m_adsinterface.AdsReadValue("agvMode"))) {
-            return 2;
-        } else if (!std::get<bool>(m_adsinterface.AdsReadValue("agvMode"))) {
-            return 1;
-        } else {
-            BOOST_LOG_TRIVIAL(error)
-                << "TRLLiftInterface::currentMode Unknown mode. This should not happen.";
-            return 0;
-        }
-    } catch (const std::exception &e) {
+    const auto fire_alarm = Read<LiftVar::FireAlarm>();
+    if (!fire_alarm) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLLiftInterface::currentMode Couldn't get fireAlarm.";
+        return 0;
+    }
+    if (*fire_alarm) {
+        return 3;
+    }
+    const auto turn_key_to_manual = Read<LiftVar::TurnKeyToManual>();
+    if (!turn_key_to_manual) {
         BOOST_LOG_TRIVIAL(error)
-            << "TRLLiftInterface::currentMode Error. " << e.what();
+            << "TRLLiftInterface::currentMode Couldn't get turnKeyToManual.";
         return 0;
     }
+    if (*turn_key_to_manual) {
+        return 4;
+    }
+    const auto agv_mode = Read<LiftVar::AgvMode>();
+    if (!agv_mode) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLLiftInterface::currentMode Couldn't get agvMode.";
+        return 0;
+    }
+    return *agv_mode ? 2 : 1;
 }
 
 std::optional<std::string> TRLLiftInterface::CurrentFloor()
 {
-    try {
-        std::string current_floor{std::to_string(
-            std::get<int8_t>(m_adsinterface.AdsReadValue("liftCurrentFloor")))};
-        if (current_floor.empty() || current_floor == "0") {
-            BOOST_LOG_TRIVIAL(error)
-                << "TRLLiftInterface::currentFloor Couldn't get liftCurrentFloor.";
-            return std::nullopt;
-        }
-        return current_floor;
-    } catch (const std::exception &e) {
+    const auto current_floor = Read<LiftVar::CurrentFloor>();
+    if (!current_floor || *current_floor == 0) {
         BOOST_LOG_TRIVIAL(error)
-            << "TRLLiftInterface::currentFloor Error. " << e.what();
+            << "TRLLiftInterface::currentFloor Couldn't get liftCurrentFloor.";
         return std::nullopt;
     }
+    return std::to_string(*current_floor);
 }
 
 std::optional<std::string> TRLLiftInterface::DestinationFloor()
 {
-    // not string& as taking value and using it to write in another fn
-    try {
-        std::string destination_floor{std::to_string(std::get<int8_t>(
-            m_adsinterface.AdsReadValue("liftDestinationFloor")))};
-        if (destination_floor.empty() || destination_floor == "0") {
-            BOOST_LOG_TRIVIAL(error)
-                << "TRLLiftInterface::destinationFloor Couldnt get liftDestinationFloor.";
-            return std::nullopt;
-        }
-        return destination_floor;
-
-    } catch (const std::exception &e) {
+    const auto destination_floor = Read<LiftVar::DestinationFloor>();
+    if (!destination_floor || *destination_floor == 0) {
         BOOST_LOG_TRIVIAL(error)
-            << "TRLLiftInterface::destinationFloor Error. " << e.what();
+            << "TRLLiftInterface::destinationFloor Couldnt get liftDestinationFloor.";
         return std::nullopt;
     }
+    return std::to_string(*destination_floor);
 }
 
 int TRLLiftInterface::LiftDoorState()
 {
-    try {
-        return std::get<int16_t>(m_adsinterface.AdsReadValue("liftDoorState"));
-    } catch (const std::exception &e) {
+    const auto door_state = Read<LiftVar::DoorState>();
+    if (!door_state) {
         BOOST_LOG_TRIVIAL(error)
-            << "TRLLiftInterface::liftDoorState Error. " << e.what();
+            << "TRLLiftInterface::liftDoorState Couldn't get liftDoorState.";
         return 0;
     }
+    return *door_state;
 }
 
 int TRLLiftInterface::LiftMotionState()
 {
+    const auto motion_state = Read<LiftVar::MotionState>();
+    if (!motion_state) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLLiftInterface::liftMotionState Couldn't get liftMotionState.";
+        return 0;
+    }
+    return *motion_state;
+}
+
+LiftSnapshot TRLLiftInterface::Snapshot()
+{
+    LiftSnapshot snapshot;
+    std::vector<AdsInterface::variant_t> values;
     try {
-        return std::get<int16_t>(
-            m_adsinterface.AdsReadValue("liftMotionState"));
+        values = m_adsinterface.AdsReadVariables(kSnapshotVariables);
     } catch (const std::exception &e) {
         BOOST_LOG_TRIVIAL(error)
-            << "TRLLiftInterface::liftMotionState Error. " << e.what();
-        return 0;
+            << "TRLLiftInterface::Snapshot Error. " << e.what();
+        return snapshot;
+    }
+
+    auto floor = [&](size_t index) -> std::optional<std::string> {
+        const int8_t *value = std::get_if<int8_t>(&values[index]);
+        if (!value || *value == 0) {
+            BOOST_LOG_TRIVIAL(error)
+                << "TRLLiftInterface::Snapshot Couldn't get "
+                << kSnapshotVariables[index] << ".";
+            return std::nullopt;
+        }
+        return std::to_string(*value);
+    };
+    auto state = [&](size_t index) -> int {
+        const int16_t *value = std::get_if<int16_t>(&values[index]);
+        if (!value) {
+            BOOST_LOG_TRIVIAL(error)
+                << "TRLLiftInterface::Snapshot Couldn't get "
+                << kSnapshotVariables[index] << ".";
+            return 0;
+        }
+        return *value;
+    };
+    auto flag = [&](size_t index) -> const bool * {
+        const bool *value = std::get_if<bool>(&values[index]);
+        if (!value) {
+            BOOST_LOG_TRIVIAL(error)
+                << "TRLLiftInterface::Snapshot Couldn't get "
+                << kSnapshotVariables[index] << ".";
+        }
+        return value;
+    };
+
+    snapshot.current_floor = floor(SNAPSHOT_CURRENT_FLOOR);
+    snapshot.destination_floor = floor(SNAPSHOT_DESTINATION_FLOOR);
+    snapshot.door_state = state(SNAPSHOT_DOOR_STATE);
+    snapshot.motion_state = state(SNAPSHOT_MOTION_STATE);
+
+    // same precedence as CurrentMode()
+    const bool *fire_alarm = flag(SNAPSHOT_FIRE_ALARM);
+    const bool *turn_key_to_manual = flag(SNAPSHOT_TURN_KEY_TO_MANUAL);
+    const bool *agv_mode = flag(SNAPSHOT_AGV_MODE);
+    if (!fire_alarm) {
+        snapshot.mode = 0;
+    } else if (*fire_alarm) {
+        snapshot.mode = 3;
+    } else if (!turn_key_to_manual) {
+        snapshot.mode = 0;
+    } else if (*turn_key_to_manual) {
+        snapshot.mode = 4;
+    } else if (!agv_mode) {
+        snapshot.mode = 0;
+    } else {
+        snapshot.mode = *agv_mode ? 2 : 1;
     }
+    return snapshot;
 }
 
-bool TRLLiftInterface::CommandLift(const std::string &floor)
+bool TRLLiftInterface::CommandLift(
+    const std::string &floor,
+    LiftCommandStats *stats)
 {
     try {
-        m_adsinterface.AdsWriteValue("liftTask", true);
-        m_adsinterface.AdsWriteValue("endLiftTask", false);
-
-        m_adsinterface.AdsWriteValue(
-            "robotDestinationFloor",
-            (int8_t)std::stoi(floor));
-        if (!(std::stoi(floor) == std::get<int8_t>(m_adsinterface.AdsReadValue(
-                                      "robotDestinationFloor")))) {
+        const int8_t destination = (int8_t)std::stoi(floor);
+        std::vector<AdsInterface::variant_t> values;
+        if (!Exchange(CommandOperations(destination), values, stats)) {
             BOOST_LOG_TRIVIAL(error)
                 << "TRLLiftInterface::commandLift in writing variable with ADS.";
             return false;
         }
-
-        return std::get<bool>(m_adsinterface.AdsReadValue("liftTask")) &&
-               !std::get<bool>(m_adsinterface.AdsReadValue("endLiftTask")) &&
-               DestinationFloor();
-
+        return CommandVerified(destination, values);
     } catch (const std::exception &e) {
         BOOST_LOG_TRIVIAL(error)
             << "TRLLiftInterface::commandLift Error. " << e.what();
@@ -246,14 +356,16 @@ bool TRLLiftInterface::CommandLift(const std::string &floor)
     }
 }
 
-bool TRLLiftInterface::EndLift()
+bool TRLLiftInterface::EndLift(LiftCommandStats *stats)
 {
     try {
-        m_adsinterface.AdsWriteValue("liftTask", false);
-        m_adsinterface.AdsWriteValue("endLiftTask", true);
-
-        return !std::get<bool>(m_adsinterface.AdsReadValue("liftTask")) &&
-               std::get<bool>(m_adsinterface.AdsReadValue("endLiftTask"));
+        std::vector<AdsInterface::variant_t> values;
+        if (!Exchange(EndOperations(), values, stats)) {
+            BOOST_LOG_TRIVIAL(error)
+                << "TRLLiftInterface::endLift in writing variable with ADS.";
+            return false;
+        }
+        return EndVerified(values);
     } catch (const std::exception &e) {
         BOOST_LOG_TRIVIAL(error)
             << "TRLLiftInterface::endLift Error. " << e.what();
@@ -261,17 +373,229 @@ bool TRLLiftInterface::EndLift()
     }
 }
 
+void TRLLiftInterface::CommandLiftAsync(
+    const std::string &floor,
+    CommandHandler done)
+{
+    int8_t destination = 0;
+    try {
+        destination = (int8_t)std::stoi(floor);
+    } catch (const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLLiftInterface::commandLift Error. " << e.what();
+        done(false, LiftCommandStats());
+        return;
+    }
+    ExchangeAsync(
+        CommandOperations(destination),
+        [destination, done](
+            bool result,
+            std::vector<AdsInterface::variant_t> values,
+            LiftCommandStats stats) {
+            if (!result) {
+                BOOST_LOG_TRIVIAL(error)
+                    << "TRLLiftInterface::commandLift in writing variable "
+                       "with ADS.";
+            }
+            bool success = false;
+            try {
+                success = result && CommandVerified(destination, values);
+            } catch (const std::exception &e) {
+                BOOST_LOG_TRIVIAL(error)
+                    << "TRLLiftInterface::commandLift Error. " << e.what();
+            }
+            done(success, stats);
+        });
+}
+
+void TRLLiftInterface::EndLiftAsync(CommandHandler done)
+{
+    ExchangeAsync(
+        EndOperations(),
+        [done](
+            bool result,
+            std::vector<AdsInterface::variant_t> values,
+            LiftCommandStats stats) {
+            if (!result) {
+                BOOST_LOG_TRIVIAL(error)
+                    << "TRLLiftInterface::endLift in writing variable with "
+                       "ADS.";
+            }
+            bool success = false;
+            try {
+                success = result && EndVerified(values);
+            } catch (const std::exception &e) {
+                BOOST_LOG_TRIVIAL(error)
+                    << "TRLLiftInterface::endLift Error. " << e.what();
+            }
+            done(success, stats);
+        });
+}
+
+std::vector<AdsInterface::Operation> TRLLiftInterface::CommandOperations(
+    int8_t destination)
+{
+    // the verification reads follow the writes in the same exchange
+    return {
+        {"liftTask", true},
+        {"endLiftTask", false},
+        {"robotDestinationFloor", destination},
+        {"robotDestinationFloor", std::nullopt},
+        {"liftTask", std::nullopt},
+        {"endLiftTask", std::nullopt},
+        {"liftDestinationFloor", std::nullopt}};
+}
+
+bool TRLLiftInterface::CommandVerified(
+    int8_t destination,
+    const std::vector<AdsInterface::variant_t> &values)
+{
+    if (!(destination == std::get<int8_t>(values[3]))) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLLiftInterface::commandLift in writing variable with ADS.";
+        return false;
+    }
+    if (std::get<int8_t>(values[6]) == 0) {
+        BOOST_LOG_TRIVIAL(error)
+            << "TRLLiftInterface::commandLift Couldn't get destination floor.";
+        return false;
+    }
+
+    return std::get<bool>(values[4]) && !std::get<bool>(values[5]);
+}
+
+std::vector<AdsInterface::Operation> TRLLiftInterface::EndOperations()
+{
+    return {
+        {"liftTask", false},
+        {"endLiftTask", true},
+        {"liftTask", std::nullopt},
+        {"endLiftTask", std::nullopt}};
+}
+
+bool TRLLiftInterface::EndVerified(
+    const std::vector<AdsInterface::variant_t> &values)
+{
+    return !std::get<bool>(values[2]) && std::get<bool>(values[3]);
+}
+
+bool TRLLiftInterface::Exchange(
+    std::vector<AdsInterface::Operation> operations,
+    std::vector<AdsInterface::variant_t> &values,
+    LiftCommandStats *stats)
+{
+    const bool count_cycles = CountCycles(operations);
+    const auto start = std::chrono::steady_clock::now();
+    const bool result = m_adsinterface.AdsExchange(operations, values);
+    LiftCommandStats exchange_stats;
+    exchange_stats.exchange = std::chrono::steady_clock::now() - start;
+    CountedCycles(result, count_cycles, values, exchange_stats);
+    if (stats) {
+        *stats = exchange_stats;
+    }
+    return result;
+}
+
+void TRLLiftInterface::ExchangeAsync(
+    std::vector<AdsInterface::Operation> operations,
+    std::function<void(
+        bool,
+        std::vector<AdsInterface::variant_t>,
+        LiftCommandStats)> done)
+{
+    const bool count_cycles = CountCycles(operations);
+    const auto start = std::chrono::steady_clock::now();
+    m_adsinterface.AdsExchangeAsync(
+        operations,
+        [count_cycles, start, done](
+            bool result,
+            std::vector<AdsInterface::variant_t> values) {
+            LiftCommandStats stats;
+            stats.exchange = std::chrono::steady_clock::now() - start;
+            // a failed exchange may return no values at all
+            if (values.size() < (count_cycles ? 2u : 0u)) {
+                result = false;
+                values.clear();
+            } else {
+                CountedCycles(result, count_cycles, values, stats);
+            }
+            done(result, std::move(values), stats);
+        });
+}
+
+bool TRLLiftInterface::CountCycles(
+    std::vector<AdsInterface::Operation> &operations)
+{
+    // the cycle counter is read before and after the command
+    if (m_adsinterface.CheckVariableType("plcCycleCount") == -1) {
+        return false;
+    }
+    operations.insert(
+        operations.begin(),
+        AdsInterface::Operation{"plcCycleCount", std::nullopt});
+    operations.push_back(
+        AdsInterface::Operation{"plcCycleCount", std::nullopt});
+    return true;
+}
+
+void TRLLiftInterface::CountedCycles(
+    bool result,
+    bool count_cycles,
+    std::vector<AdsInterface::variant_t> &values,
+    LiftCommandStats &stats)
+{
+    stats.plc_cycles.reset();
+    if (!count_cycles) {
+        return;
+    }
+    const uint32_t *before = std::get_if<uint32_t>(&values.front());
+    const uint32_t *after = std::get_if<uint32_t>(&values.back());
+    if (result && before && after) {
+        // the counter wraps around
+        stats.plc_cycles = *after - *before;
+    }
+    values.erase(values.begin());
+    values.pop_back();
+}
+
 const std::string &TRLLiftInterface::GetName() const
 {
     return m_name;
 }
 
-const std::string &TRLLiftInterface::GetSessionID() const
+std::string TRLLiftInterface::GetSessionID() const
 {
+    std::scoped_lock lock(m_session_mutex);
     return m_session_id;
 }
 
 void TRLLiftInterface::SetSessionID(const std::string &session_id)
 {
+    std::scoped_lock lock(m_session_mutex);
     m_session_id = session_id;
+}
+
+void TRLLiftInterface::SetReconnectHandler(
+    AdsInterface::ReconnectHandler handler)
+{
+    const std::string name = m_name;
+    m_adsinterface.SetReconnectHandler(
+        [name, handler](
+            std::chrono::steady_clock::duration duration,
+            uint32_t attempts) {
+            BOOST_LOG_TRIVIAL(info)
+                << name << "| TRLLiftInterface reconnected to the PLC in "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       duration)
+                       .count()
+                << " ms after " << attempts << " attempts.";
+            if (handler) {
+                handler(duration, attempts);
+            }
+        });
+}
+
+AdsInterface::ReconnectStats TRLLiftInterface::ReconnectStats() const
+{
+    return m_adsinterface.GetReconnectStats();
 }
\ No newline at end of file